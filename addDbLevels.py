@@ -30,6 +30,15 @@ def build_levels(db, level_file_path):
     lvl_file.close()
 
     for values in content:
+        # Movement pattern of an entity type: "pattern,ENEMY_2,0:1 0:1 1:0"
+        if values.startswith("pattern,"):
+            _, name, steps = values.strip().split(",")
+            entity, number = name.split("_")
+            ID = searchAsset(entity, number, "ID")
+            cur.execute("INSERT OR REPLACE INTO level_patterns (level, entity, steps) VALUES (?, ?, ?)", [lvlID, ID, steps])
+            db.commit()
+            continue
+
         progress, name, xPos = values.split(",")
         splitted = name.split("_")
         entity = splitted[0]
@@ -1,33 +1,41 @@
 #pragma once
 
 #include <exception>
+#include <memory>
 #include <string>
 
 #include "Error.hpp"
+#include "Logger.hpp"
 
 /* An `ErrorHandler` can handle errors whose messages are given by the calling program.
  * An handler can either append the error message in a log file or print it to stderr.
- * Passing a fatal error through the handler will cause the program to stop.
+ * Messages are written by a background `Logger`, callers never wait for the disk.
+ * Passing a fatal error through the handler will cause the program to stop,
+ *  once the messages logged so far are written.
  */
 class ErrorHandler {
  private:
   const std::string _logPath;
   bool _logToFile = true;
+  std::unique_ptr<Logger> _logger = nullptr;
 
   /* Create the log directory
    * Set the handler to print errors on stderr if the operation failed.
    */
   inline void _createLogDirectory(const std::string&);
 
-  inline void _logError(const std::exception&) const noexcept;
-  inline void _printError(const std::exception&) const noexcept;
-
  public:
   ErrorHandler(const std::string&);
   ~ErrorHandler() noexcept = default;
+  ErrorHandler(const ErrorHandler&) = delete;
+  ErrorHandler& operator=(const ErrorHandler&) = delete;
 
-  /* Log an error message in the log file.
+  /* Log an error message in the log file, with the context of the error if given.
    * If the log file was not created, the error message is printed to stderr.
    */
-  void handleError(const std::exception&) const noexcept;
+  void handleError(const std::exception&, const LogFields& = {}) const noexcept;
+
+  /* Log an informative message, the same way as errors.
+   */
+  void logMessage(const std::string&, const LogFields& = {}) const noexcept;
 };
@@ -1,18 +1,23 @@
 #pragma once
 
+#include "constants.hpp"
+
 /* Containes the games settings.
  * An instance of this type is used to create a `Game`.
  */
 struct GameSettings {
-  bool secondPlayer = false;
+  unsigned nbPlayers = 1;  // [1, MAX_PLAYERS]
   unsigned int initialLives = 5;
   double difficulty = 0.5;
   double bonusProbability = 0.1;
   bool friendlyFire = false;
   int levelID = -1;
 
-  int skins[2] = {0, 1};
+  unsigned tickRate = FPS;  // Simulated ticks/s, [MIN_TICK_RATE, MAX_TICK_RATE]
+  unsigned sendRate = FPS;  // Refreshes sent/s to the clients, [1, tickRate]
+
+  int skins[MAX_PLAYERS] = {0, 1, 2, 3, 4, 0, 1, 2};
 
   GameSettings() noexcept = default;
-  GameSettings(bool _secondPlayer, unsigned int _initialLives, double _difficulty, double _bonusProbability, bool _friendlyFire) noexcept;
+  GameSettings(unsigned _nbPlayers, unsigned int _initialLives, double _difficulty, double _bonusProbability, bool _friendlyFire) noexcept;
 };
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/* Histogram of positive values (durations in ns) in the way of HdrHistogram:
+ *  values are bucketed by power of two, each power being split in SUB_BUCKETS
+ *  linear sub-buckets, so that percentiles are within 1/SUB_BUCKETS of the
+ *  recorded values whatever their magnitude.
+ * Counts are atomic: a histogram can be recorded by several threads and read
+ *  at any time without stopping them. Recording does not allocate.
+ */
+class Histogram {
+ private:
+  static constexpr unsigned SUB_BITS = 4;
+  static constexpr unsigned SUB_BUCKETS = 1 << SUB_BITS;
+  static constexpr unsigned MAX_BITS = 40;  // Larger values are recorded as 2^MAX_BITS - 1
+  static constexpr std::size_t NB_BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS;
+
+  std::atomic<unsigned long> _counts[NB_BUCKETS] = {};
+  std::atomic<unsigned long> _total = {0};
+  std::atomic<unsigned long> _sum = {0};
+  std::atomic<unsigned long> _max = {0};
+
+  static std::size_t _bucketOf(unsigned long value) noexcept;
+  // Highest value recorded in a bucket
+  static unsigned long _valueOf(std::size_t bucket) noexcept;
+
+ public:
+  Histogram() noexcept = default;
+  ~Histogram() noexcept = default;
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  void record(long value) noexcept;
+  /* Record every value of `other`.
+   */
+  void add(const Histogram& other) noexcept;
+  void reset() noexcept;
+
+  unsigned long count() const noexcept;
+  double mean() const noexcept;
+  unsigned long max() const noexcept;
+  /* Value under which `percentile` % of the values are (0 if empty).
+   */
+  unsigned long percentile(double percentile) const noexcept;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Histogram.hpp"
+#include "MessageData.hpp"
+
+/* Stages of the latency of an input, from its sending by the client to the
+ *  display of the first refresh simulating it.
+ */
+enum LatencyStage : unsigned {
+  LATENCY_SEND,      // From the client to the server
+  LATENCY_QUEUE,     // Waiting for the next tick
+  LATENCY_TICK,      // Simulated, then the refresh built
+  LATENCY_DELIVERY,  // From the server to the display of the refresh
+  LATENCY_TOTAL,
+  NB_LATENCY_STAGES,
+};
+
+const char* latencyStageName(LatencyStage) noexcept;
+
+/* Latency of the game inputs of a client, measured on the monotonic clock
+ *  (see `getMonotonicTimestamp`) from the traces of the refreshes.
+ * Inputs are numbered as they are sent; once a refresh traces an input, every
+ *  input sent up to it is visible, and its total latency is recorded. The
+ *  stages are recorded for the traced input only. Durations are in µs.
+ */
+class InputLatency {
+ private:
+  static constexpr unsigned WINDOW = 256;  // Inputs sent and not shown yet, older ones are not measured
+
+  long _sentTimes[WINDOW] = {};
+  unsigned _lastSent = 0;
+  unsigned _lastShown = 0;
+  Histogram _stages[NB_LATENCY_STAGES] = {};
+
+ public:
+  InputLatency() noexcept = default;
+  ~InputLatency() noexcept = default;
+  InputLatency(const InputLatency&) = delete;
+  InputLatency& operator=(const InputLatency&) = delete;
+
+  /* Number an input about to be sent and return its sequence.
+   */
+  unsigned send() noexcept;
+
+  /* Record the latency of the inputs shown by a refresh, displayed now.
+   */
+  void show(const RefreshFrame&) noexcept;
+
+  /* Forget the inputs and the latencies, for a new game.
+   */
+  void reset() noexcept;
+
+  const Histogram& stage(LatencyStage) const noexcept;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/* Context of a logged message, written after it when set.
+ */
+struct LogFields {
+  std::string channel = "";
+  std::string username = "";
+  std::string activityID = "";
+};
+
+/* Write messages to a log file (or to stderr) from a background thread.
+ * Messages are pushed on a lock-free queue with many producers and a single
+ *  consumer, so that logging never waits for the disk: the file is kept open
+ *  by the thread, and rotated once it grows over MAX_FILE_SIZE.
+ * A message repeated in a row is written at most once per REPEAT_WINDOW,
+ *  followed by the number of times it was repeated. Once MAX_PENDING messages
+ *  wait in the queue, new ones are dropped and counted instead.
+ */
+class Logger {
+ private:
+  static constexpr long MAX_FILE_SIZE = 8 << 20;  // bytes
+  static constexpr unsigned MAX_ROTATED_FILES = 3;  // Rotated files are kept as `path.1` to `path.N`
+  static constexpr std::chrono::seconds REPEAT_WINDOW{1};
+  static constexpr long MAX_PENDING = 1 << 16;
+  static constexpr std::chrono::milliseconds IDLE_WAIT{100};
+
+  struct Record {
+    std::chrono::system_clock::time_point time = {};
+    std::string message = "";
+    LogFields fields = {};
+    std::atomic<Record*> next = {nullptr};
+  };
+
+  const std::string _path;
+
+  // Queue: producers push at `_head`, the logging thread pops at `_tail`
+  Record _stub = {};
+  std::atomic<Record*> _head = {&_stub};
+  Record* _tail = &_stub;
+  std::atomic<long> _pending = {0};
+  std::atomic<unsigned long> _dropped = {0};
+
+  std::thread _thread = {};
+  std::mutex _mutex = {};
+  std::condition_variable _wakeUp = {};
+  std::condition_variable _flushed = {};
+  std::atomic<bool> _sleeping = {false};
+  std::atomic<bool> _stopping = {false};
+  unsigned long _flushRequests = 0;
+  unsigned long _flushes = 0;
+
+  // Owned by the logging thread
+  std::FILE* _file = nullptr;
+  long _fileSize = 0;
+  std::time_t _lastSecond = 0;
+  char _timeText[32] = "";
+  std::string _lastMessage = "";  // Last message written, with its fields
+  std::chrono::system_clock::time_point _lastWritten = {};
+  unsigned long _repeats = 0;
+
+  void _push(Record*) noexcept;
+  Record* _pop() noexcept;
+
+  void _run() noexcept;
+  void _open() noexcept;
+  void _rotate() noexcept;
+  void _write(const Record&) noexcept;
+  void _writeLine(std::chrono::system_clock::time_point, const std::string& line) noexcept;
+  void _writeRepeats(std::chrono::system_clock::time_point) noexcept;
+
+ public:
+  /* Log to the file at `path`, or to stderr if `path` is empty.
+   */
+  explicit Logger(const std::string& path);
+  ~Logger() noexcept;
+  Logger(const Logger&) = delete;
+  Logger& operator=(const Logger&) = delete;
+
+  /* Queue a message, without waiting for it to be written.
+   */
+  void log(const std::string& message, const LogFields& = {}) noexcept;
+
+  /* Wait until every message queued so far is written.
+   */
+  void flush() noexcept;
+};
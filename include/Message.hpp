@@ -47,7 +47,7 @@ class Message: public AbstractMessage<T> {
 
   const Token& getToken() const noexcept;
 
-  std::string getTokenSignature() const noexcept;
+  std::string getTokenChannel() const noexcept;
 };
 
 // Template definitions
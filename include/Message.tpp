@@ -22,6 +22,6 @@ const Token& Message<T>::getToken() const noexcept {
 }
 
 template<typename T>
-std::string Message<T>::getTokenSignature() const noexcept {
-  return _token.getSignature();
+std::string Message<T>::getTokenChannel() const noexcept {
+  return _token.getChannel();
 }
@@ -53,6 +53,15 @@ struct FollowRequest {
   }
 };
 
+struct SpectateRequest {
+  char gameID[64];
+
+  SpectateRequest(const std::string& _gameID) {
+    strncpy(gameID, _gameID.c_str(), sizeof(gameID) - 1);
+    gameID[sizeof(gameID) - 1] = '\0';
+  }
+};
+
 struct PackKeyRequest {
   /**
    * 0 : use
@@ -136,13 +145,33 @@ struct PackKey {
   }
 };
 
+/* A game input, numbered by the client so that refreshes tell which inputs they show.
+ */
+struct GameInput {
+  int key;
+  unsigned sequence;  // From 1, in the order of sending
+};
+
+/* A refresh is sent as a RefreshFrame followed by `nbPlayers` PlayerFrame
+ *  then `nbEntities` EntityFrame.
+ * It traces the last input simulated before it, with times of the monotonic
+ *  clock (see `getMonotonicTimestamp`), to split the latency of inputs.
+ */
 struct RefreshFrame {
   int gameState;  // -1:lose; 0:running, 1:win
   long timestamp;
-  unsigned int score[2];
-  double hpPlayers[2];  // [0, NB_LIVES]
   unsigned progress;
+  unsigned nbPlayers;      // number of PlayerFrame to read
   std::size_t nbEntities;  // number of EntityFrame to read
+  unsigned inputSequence;  // 0 until an input is simulated
+  long inputReceived;      // Read by the server
+  long inputApplied;       // Start of the first tick simulating the input
+  long sent;               // Written to the client
+};
+
+struct PlayerFrame {
+  unsigned int score;
+  double hp;  // [0, NB_LIVES]
 };
 
 struct EntityFrame {
@@ -168,3 +197,41 @@ struct LevelInfo {
     strcpy(name, levelName.c_str());
   }
 };
+
+/* Snapshot of the load of the server, sent to administrators after a `true`
+ *  (or only a `false` to other users), followed by `nbChannels` ChannelStats.
+ * Durations are in µs.
+ */
+struct ServerStats {
+  long timestamp;
+  long uptime;
+  unsigned activeGames;
+  unsigned activeSandboxes;
+  unsigned long tokenFailures;  // Requests refused because of an invalid token
+
+  unsigned long dbQueries;
+  double dbMean;
+  double dbP50;
+  double dbP99;
+  double dbMax;
+
+  unsigned long ticks;
+  unsigned long lateTicks;
+  double latenessP50;  // How late ticks start
+  double latenessP99;
+  double latenessMax;
+  unsigned overloadLevel;
+  unsigned long droppedFrames;   // Frames replaced by a newer one before their client read them
+  unsigned long stalledClients;  // Games stopped because their client took no frame
+
+  unsigned fifos;      // Channels in the pipe directory
+  unsigned long collectedFifos;  // Channels of crashed clients removed since the server started
+  unsigned long rss;   // bytes
+  unsigned nbChannels; // number of ChannelStats to read
+};
+
+struct ChannelStats {
+  char name[32];
+  unsigned long messages;  // Read since the server started
+  double rate;             // Messages/s since the previous stats request
+};
@@ -9,6 +9,7 @@ class Token {
   char _username[255];
   char _guestUsername[255];
   char _activityID[255];
+  char _channel[255];  // Kept by the client for its session, whatever the token
   char _timestamp[255];
   char _sig[255];
 
@@ -18,12 +19,15 @@ class Token {
   Token(
       const std::string& username,
       const std::string& gameID,
+      const std::string& channel,
       const std::string& timestamp,
       const std::string& signature,
       const std::string& guestUsername = "") noexcept;
 
   std::string getUsername() const noexcept;
   std::string getActivityID() const noexcept;
+  std::string getChannel() const noexcept;
+  std::string getGameChannel() const noexcept;
   std::string getTimestamp() const noexcept;
   std::string getSignature() const noexcept;
   std::string getGuestUsername() const noexcept;
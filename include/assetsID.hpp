@@ -0,0 +1,82 @@
+#pragma once
+
+constexpr int ASSET_LEN_PREFIX = 4;
+constexpr int ASSET_LEN_SID = 4;
+
+constexpr int ASSET_PLAYER_TYPE = 0;
+constexpr int ASSET_ENEMY_TYPE = 1;
+constexpr int ASSET_BOSS_TYPE = 2;
+constexpr int ASSET_HENCHMAN_TYPE = 3;
+constexpr int ASSET_OBSTACLE_TYPE = 4;
+constexpr int ASSET_POWERUP_TYPE = 5;
+constexpr int ASSET_BULLET_TYPE = 6;
+
+constexpr int ASSET_BOSS_1_ID = 32;
+constexpr int ASSET_BOSS_1_WIDTH = 6;
+constexpr int ASSET_BOSS_1_HEIGHT = 6;
+constexpr int ASSET_BOSS_2_ID = 33;
+constexpr int ASSET_BOSS_2_WIDTH = 20;
+constexpr int ASSET_BOSS_2_HEIGHT = 8;
+constexpr int ASSET_BOSS_3_ID = 34;
+constexpr int ASSET_BOSS_3_WIDTH = 20;
+constexpr int ASSET_BOSS_3_HEIGHT = 8;
+constexpr int ASSET_BULLET_ID = 96;
+constexpr int ASSET_BULLET_WIDTH = 1;
+constexpr int ASSET_BULLET_HEIGHT = 1;
+constexpr int ASSET_ENEMY_1_ID = 16;
+constexpr int ASSET_ENEMY_1_WIDTH = 3;
+constexpr int ASSET_ENEMY_1_HEIGHT = 1;
+constexpr int ASSET_ENEMY_2_ID = 17;
+constexpr int ASSET_ENEMY_2_WIDTH = 3;
+constexpr int ASSET_ENEMY_2_HEIGHT = 2;
+constexpr int ASSET_ENEMY_3_ID = 18;
+constexpr int ASSET_ENEMY_3_WIDTH = 3;
+constexpr int ASSET_ENEMY_3_HEIGHT = 3;
+constexpr int ASSET_HENCHMAN_1_LEFT_ID = 48;
+constexpr int ASSET_HENCHMAN_1_LEFT_WIDTH = 8;
+constexpr int ASSET_HENCHMAN_1_LEFT_HEIGHT = 6;
+constexpr int ASSET_HENCHMAN_1_RIGHT_ID = 49;
+constexpr int ASSET_HENCHMAN_1_RIGHT_WIDTH = 8;
+constexpr int ASSET_HENCHMAN_1_RIGHT_HEIGHT = 6;
+constexpr int ASSET_HENCHMAN_2_LEFT_ID = 50;
+constexpr int ASSET_HENCHMAN_2_LEFT_WIDTH = 3;
+constexpr int ASSET_HENCHMAN_2_LEFT_HEIGHT = 3;
+constexpr int ASSET_HENCHMAN_2_RIGHT_ID = 51;
+constexpr int ASSET_HENCHMAN_2_RIGHT_WIDTH = 3;
+constexpr int ASSET_HENCHMAN_2_RIGHT_HEIGHT = 3;
+constexpr int ASSET_HENCHMAN_3_LEFT_ID = 52;
+constexpr int ASSET_HENCHMAN_3_LEFT_WIDTH = 4;
+constexpr int ASSET_HENCHMAN_3_LEFT_HEIGHT = 4;
+constexpr int ASSET_HENCHMAN_3_RIGHT_ID = 53;
+constexpr int ASSET_HENCHMAN_3_RIGHT_WIDTH = 4;
+constexpr int ASSET_HENCHMAN_3_RIGHT_HEIGHT = 4;
+constexpr int ASSET_OBSTACLE_1_ID = 64;
+constexpr int ASSET_OBSTACLE_1_WIDTH = 3;
+constexpr int ASSET_OBSTACLE_1_HEIGHT = 4;
+constexpr int ASSET_OBSTACLE_2_ID = 65;
+constexpr int ASSET_OBSTACLE_2_WIDTH = 3;
+constexpr int ASSET_OBSTACLE_2_HEIGHT = 5;
+constexpr int ASSET_OBSTACLE_3_ID = 66;
+constexpr int ASSET_OBSTACLE_3_WIDTH = 3;
+constexpr int ASSET_OBSTACLE_3_HEIGHT = 3;
+constexpr int ASSET_PLAYER_1_ID = 0;
+constexpr int ASSET_PLAYER_1_WIDTH = 2;
+constexpr int ASSET_PLAYER_1_HEIGHT = 2;
+constexpr int ASSET_PLAYER_2_ID = 1;
+constexpr int ASSET_PLAYER_2_WIDTH = 2;
+constexpr int ASSET_PLAYER_2_HEIGHT = 2;
+constexpr int ASSET_PLAYER_3_ID = 2;
+constexpr int ASSET_PLAYER_3_WIDTH = 2;
+constexpr int ASSET_PLAYER_3_HEIGHT = 2;
+constexpr int ASSET_PLAYER_4_ID = 3;
+constexpr int ASSET_PLAYER_4_WIDTH = 2;
+constexpr int ASSET_PLAYER_4_HEIGHT = 2;
+constexpr int ASSET_PLAYER_5_ID = 4;
+constexpr int ASSET_PLAYER_5_WIDTH = 2;
+constexpr int ASSET_PLAYER_5_HEIGHT = 2;
+constexpr int ASSET_POWERUP_1_ID = 80;
+constexpr int ASSET_POWERUP_1_WIDTH = 1;
+constexpr int ASSET_POWERUP_1_HEIGHT = 1;
+constexpr int ASSET_POWERUP_2_ID = 81;
+constexpr int ASSET_POWERUP_2_WIDTH = 1;
+constexpr int ASSET_POWERUP_2_HEIGHT = 1;
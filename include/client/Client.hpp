@@ -18,7 +18,7 @@
 class Client final {
   ErrorHandler _errorHandler;
   CommunicationAPI _communicationAPI = {};
-  std::array<std::size_t, MAX_PLAYERS> _userMapping = {0, 1};
+  std::array<std::size_t, LOCAL_PLAYERS> _userMapping = {0, 1};
 
   Window _window = {};
 
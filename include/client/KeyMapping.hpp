@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <map>
 #include <string>
 #include <vector>
@@ -22,8 +23,8 @@ class KeyMapping {
    */
   static int normalizeInput(int key, int gameKey) noexcept;
   /* Return a normalized key or INVALID_KEY.
-   * The lower bit is 0 for player 1 and 1 for player 2.
+   * The lower bits hold the index of the local player (see `gameInput`).
    */
-  static int normalizeGameInput(int key, const std::array<std::size_t, 2>& userMapping) noexcept;
+  static int normalizeGameInput(int key, const std::array<std::size_t, LOCAL_PLAYERS>& userMapping) noexcept;
   static bool matches(int key, int gameKey) noexcept;
 };
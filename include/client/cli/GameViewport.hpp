@@ -14,8 +14,8 @@ class GameViewport: public Viewport {
 
   int _maxInnerHeight() const noexcept override;
   int _maxInnerWidth() const noexcept override;
-  void _drawScores(unsigned int score[MAX_PLAYERS]) const noexcept;
-  void _drawHP(double hpPlayers[MAX_PLAYERS]) const noexcept;
+  void _drawScores(unsigned int score[LOCAL_PLAYERS]) const noexcept;
+  void _drawHP(double hpPlayers[LOCAL_PLAYERS]) const noexcept;
   void _drawProgression(unsigned progress) const noexcept;
 
  public:
@@ -35,7 +35,7 @@ class GameViewport: public Viewport {
 
   bool checkSize() const noexcept;
   void drawWindow() noexcept override;
-  void drawGame(unsigned int score[MAX_PLAYERS], double hpPlayer[MAX_PLAYERS], unsigned progress, std::vector<Entity>& entities);
+  void drawGame(unsigned int score[LOCAL_PLAYERS], double hpPlayer[LOCAL_PLAYERS], unsigned progress, std::vector<Entity>& entities);
   int getInputKey();
   void drawUI(const UI&) noexcept;
 };
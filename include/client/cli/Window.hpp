@@ -68,7 +68,7 @@ class Window {
 
   /* -------------------- Game -------------------- */
   void initGame(const Game::Mapping& userMapping);
-  void refreshGame(const RefreshFrame&, const std::vector<EntityFrame>&);
+  void refreshGame(const RefreshFrame&, const std::vector<PlayerFrame>&, const std::vector<EntityFrame>&);
   void win();
   void loose();
   void finishGame();
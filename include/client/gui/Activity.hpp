@@ -8,7 +8,7 @@
 
 class Activity {
  public:
-  using Mapping = std::array<std::size_t, MAX_PLAYERS>;
+  using Mapping = std::array<std::size_t, LOCAL_PLAYERS>;
   struct Entity {
     Sprite sprite;
     int xPos;
@@ -26,7 +26,7 @@ class Activity {
 
  protected:
   std::vector<Entity> _entities = {};
-  const std::array<std::size_t, MAX_PLAYERS> _userMapping;
+  const std::array<std::size_t, LOCAL_PLAYERS> _userMapping;
 
  public:
   Activity(const Mapping& mapping);
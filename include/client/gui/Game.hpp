@@ -3,6 +3,7 @@
 #include <array>
 #include <deque>
 #include <map>
+#include <vector>
 
 #include "client/gui/Activity.hpp"
 #include "client/gui/KeyHandler.hpp"
@@ -10,6 +11,7 @@
 #include "client/gui/assets/UI/UI.hpp"
 #include "client/gui/utils.hpp"
 #include "client/gui/Menu.hpp"
+#include "MessageData.hpp"
 #include "constants.hpp"
 
 class Game: public Activity, public Menu {
@@ -20,10 +22,10 @@ class Game: public Activity, public Menu {
   static CheatCodes _cheatCodes;
 
   Texture* _progressTexture = nullptr;
-  Texture* _scoreTextures[MAX_PLAYERS] = {nullptr, nullptr};
+  Texture* _scoreTextures[LOCAL_PLAYERS] = {nullptr, nullptr};
 
-  unsigned int _score[MAX_PLAYERS] = {0, 0};
-  double _hpPlayers[MAX_PLAYERS] = {0, 0};
+  unsigned int _score[LOCAL_PLAYERS] = {0, 0};
+  double _hpPlayers[LOCAL_PLAYERS] = {0, 0};
   unsigned _progress = 0;
 
   SDL_Event _event = {};
@@ -45,7 +47,9 @@ class Game: public Activity, public Menu {
   void waitForInput();
   int getInput(int nPlayer);
 
-  void updateGameState(unsigned progress, const unsigned score[2], const double hpPlayers[2]);
+  /* Only the first LOCAL_PLAYERS players are displayed.
+   */
+  void updateGameState(unsigned progress, const std::vector<PlayerFrame>& players);
 
   void drawUI(const UI&);
 };
@@ -11,7 +11,7 @@ class KeyHandler {
 
   static bool _isValidKey(int key);
 
-  std::map<int, std::array<bool, 2>> _keyPressState = {};
+  std::map<int, std::array<bool, LOCAL_PLAYERS>> _keyPressState = {};
   int long _lastInputTime = 0;
 
  public:
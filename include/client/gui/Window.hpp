@@ -76,7 +76,7 @@ class Window {
 
   /* -------------------- Game -------------------- */
   void initGame(const Activity::Mapping& userMapping);
-  void refreshGame(const RefreshFrame&, const std::vector<EntityFrame>&);
+  void refreshGame(const RefreshFrame&, const std::vector<PlayerFrame>&, const std::vector<EntityFrame>&);
   void win();
   void loose();
   void finishGame();
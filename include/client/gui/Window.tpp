@@ -43,7 +43,7 @@ void Window::processGameInput(CallbackFunction<This, int> fct, This* objPtr) {
     }
   }
 
-  for (int p = 0; p != MAX_PLAYERS; ++p) {
+  for (int p = 0; p != LOCAL_PLAYERS; ++p) {
     int key = game->getInput(p);
     if (key != INVALID_KEY) {
       (objPtr->*fct)(key);
@@ -0,0 +1,22 @@
+#pragma once
+
+constexpr int PACK_AUDIO_CHANNELS = 11;
+
+constexpr int PACK_AUDIO_BOSS_ID = 0;
+constexpr int PACK_AUDIO_GAME_ID = 1;
+constexpr int PACK_AUDIO_HURT_ID = 2;
+constexpr int PACK_AUDIO_LEVEL_UP_ID = 3;
+constexpr int PACK_AUDIO_LOOSE_ID = 4;
+constexpr int PACK_AUDIO_MENU_ID = 5;
+constexpr int PACK_AUDIO_POWER_UP_DAMAGE_ID = 6;
+constexpr int PACK_AUDIO_POWER_UP_FIRE_RATE_ID = 7;
+constexpr int PACK_AUDIO_RESPAWN_ID = 8;
+constexpr int PACK_AUDIO_SHOOT_ID = 9;
+constexpr int PACK_AUDIO_WIN_ID = 10;
+constexpr int PACK_BACKGROUND_0_ID = 11;
+constexpr int PACK_BACKGROUND_1_ID = 12;
+constexpr int PACK_BACKGROUND_2_ID = 13;
+constexpr int PACK_BACKGROUND_3_ID = 14;
+constexpr int PACK_HUD_HEART_ID = 15;
+constexpr int PACK_HUD_PROGRESS_BAR_ID = 16;
+constexpr int PACK_HUD_PROGRESS_FILL_ID = 17;
@@ -1,19 +1,33 @@
 #pragma once
 
 // General game constants
-constexpr unsigned FPS = 30;              // frames/s
+// Progress and state steps are sent to clients in frames, whatever the tick rate of the game
+constexpr unsigned FPS = 30;              // frames/s, default tick rate of the games
 constexpr long int TICK = 1000000 / FPS;  // µs/frame
-constexpr unsigned FRAMES_BY_LEVEL = FPS * 100;
-constexpr unsigned PROGRESS_STEP = 1;       // frames
+constexpr unsigned LEVEL_DURATION = 100;  // s
+constexpr unsigned FRAMES_BY_LEVEL = FPS * LEVEL_DURATION;
+constexpr unsigned PROGRESS_STEP = 1;       // ticks
 constexpr long int MAX_LATENCY = 5 * TICK;  // µs
 
 constexpr long int CLIENT_TIMEOUT = 15;  // 
+constexpr long int SPECTATOR_POLL = 1000;  // µs between two looks for a new frame of a spectated game
 
-constexpr unsigned MAX_PLAYERS = 2;
+constexpr unsigned MAX_PLAYERS = 8;    // players in a game
+constexpr unsigned LOCAL_PLAYERS = 2;  // players sharing a client
+
+constexpr unsigned MIN_TICK_RATE = 10;   // ticks/s
+constexpr unsigned MAX_TICK_RATE = 240;  // ticks/s
+
+constexpr unsigned PARALLEL_TICK_THRESHOLD = 0;  // entities, 0 disables the parallel tick (see `Server::parallelTicks`)
+constexpr unsigned long PARALLEL_MAX_TOUCH_ROWS = 1 << 24;  // bytes of precomputed touch masks
 
 constexpr int MAP_WIDTH = 100;
 constexpr int MAP_HEIGHT = int(MAP_WIDTH * 9 / 16);
 
+// Levels may span a world larger than the screen, seen through the camera of the team
+constexpr int ACTIVE_MARGIN = MAP_HEIGHT / 2;  // entities farther from the view are dormant
+constexpr int DORMANT_CELL_SIZE = 32;          // side of the cells holding dormant entities
+
 // Game states
 constexpr unsigned IDLE_STATE = 0;
 constexpr unsigned MOVE_STATE = 1;
@@ -23,8 +37,8 @@ constexpr unsigned DIE_STATE = 4;
 constexpr unsigned RESPAWN_STATE = 5;
 constexpr unsigned PICK_POWER_UP_STATE = 6;
 
-constexpr unsigned STATE_DURATION = FPS * 1;    // frames
-constexpr unsigned RESPAWN_DURATION = FPS * 2;  // frames
+constexpr double STATE_DURATION = 1;    // s
+constexpr double RESPAWN_DURATION = 2;  // s
 
 // Game entity constants
 constexpr double ENEMY_HP = 1.0;
@@ -39,19 +53,22 @@ constexpr double ENEMY_MAX_FIRE_DAMAGE = 1;
 constexpr double PLAYER_FIRE_DAMAGE = 0.7;
 constexpr double OBSTACLE_DAMAGE = 1;
 
-// Note: velocity is in [%map/frame] = MAP_SIZE / ((s/map) * (frames/s))
-constexpr double PLAYER_VELOCITY_Y = MAP_HEIGHT / (3.0 * FPS);
-constexpr double PLAYER_VELOCITY_X = MAP_WIDTH / (4.0 * FPS);
-constexpr double ENEMY_VELOCITY_Y = MAP_HEIGHT / (7.5 * FPS);
-constexpr double ENEMY_VELOCITY_X = MAP_WIDTH / (15.0 * FPS);
-constexpr double BULLET_VELOCITY = MAP_WIDTH / (2.0 * FPS);
-constexpr double OBSTACLE_VELOCITY = MAP_WIDTH / (10.0 * FPS);
-
-// Note: fire delay is in [frame/shoot] = (frames/s) / (shoots/s)
-constexpr unsigned PLAYER_FIRE_DELAY = unsigned(FPS / 1.5);
-constexpr unsigned ENEMY_FIRE_DELAY = unsigned(FPS / 0.6);
-constexpr unsigned BOSS_FIRE_DELAY = unsigned(FPS / 0.75);  // x2
-constexpr unsigned HENCHMAN_FIRE_DELAY = unsigned(FPS / 0.8);
+// Note: speeds are given as the time to cross the map [s/map], they are
+//  converted for the tick rate of the game (see `Timing`):
+//  velocity is in [%map/tick] = MAP_SIZE / ((s/map) * (ticks/s))
+constexpr double PLAYER_CROSSING_Y = 3.0;
+constexpr double PLAYER_CROSSING_X = 4.0;
+constexpr double ENEMY_CROSSING_Y = 7.5;
+constexpr double ENEMY_CROSSING_X = 15.0;
+constexpr double BULLET_CROSSING = 2.0;
+constexpr double OBSTACLE_CROSSING = 10.0;
+
+// Note: fire rates are in [shoots/s], they are converted for the tick rate of the game:
+//  fire delay is in [ticks/shoot] = (ticks/s) / (shoots/s)
+constexpr double PLAYER_FIRE_RATE = 1.5;
+constexpr double ENEMY_FIRE_RATE = 0.6;
+constexpr double BOSS_FIRE_RATE = 0.75;  // x2
+constexpr double HENCHMAN_FIRE_RATE = 0.8;
 
 constexpr unsigned SCORE_TOUCH_ENEMY = 50;
 constexpr unsigned SCORE_KILL_ENEMY = 250;
@@ -89,6 +106,20 @@ constexpr int GAME_KEY_SHOOT_LEFT = GAME_KEY_SHOOT + GAME_KEY_LEFT;
 constexpr int GAME_KEY_SHOOT_UP_LEFT = GAME_KEY_SHOOT + GAME_KEY_UP_LEFT;        // 24
 constexpr int GAME_KEY_SHOOT_DOWN_LEFT = GAME_KEY_SHOOT + GAME_KEY_DOWN_LEFT;    // 25
 
+// Game inputs carry the index of the player in their lower bits
+constexpr int PLAYER_INPUT_BITS = 3;
+static_assert(MAX_PLAYERS <= 1 << PLAYER_INPUT_BITS, "Not enough bits to address every player");
+
+constexpr int gameInput(int key, unsigned nPlayer) {
+  return key * (1 << PLAYER_INPUT_BITS) + int(nPlayer);
+}
+constexpr int inputKey(int input) {
+  return input >> PLAYER_INPUT_BITS;
+}
+constexpr unsigned inputPlayer(int input) {
+  return unsigned(input & ((1 << PLAYER_INPUT_BITS) - 1));
+}
+
 constexpr int CHEAT_CODE_LENGHT = 4;
 constexpr int CHEAT_CODE_CHAR = '/';
 constexpr int CHEAT_CODE_LIFE = 100;
@@ -96,8 +127,14 @@ constexpr int CHEAT_CODE_GHOST = 101;
 constexpr int CHEAT_CODE_HULK = 102;
 constexpr int CHEAT_CODE_SKIP_LEVEL = 103;
 
+// Inputs applied by the server itself, refused from clients (recorded in replays)
+// Like cheat codes, they fall on a key that no player input uses
+constexpr int SERVER_CODE_CAP_DROPS = 104;
+constexpr int SERVER_CODE_UNCAP_DROPS = 105;
+
 // Textual fields
 constexpr unsigned ACTIVITYID_LENGTH = 32;
+constexpr const char* GAME_CHANNEL_SUFFIX = "-game";  // Channel of the frames, beside the one of the client
 constexpr int USERNAME_MIN = 3;
 constexpr int USERNAME_MAX = 16;
 constexpr int LEVEL_MIN = 3;
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ErrorHandler.hpp"
+#include "server/MessageExchanger.hpp"
+
+/* Remove the channels left behind by clients.
+ * A client keeps the channel named after its pid for its whole session, and
+ *  the one of its frames beside it (see `Token::getGameChannel`); it removes
+ *  them when it exits. The channels of clients that crashed are collected
+ *  periodically once their process is gone, closing the descriptors of the
+ *  server with them.
+ * Other channels, listened by the server, are never collected.
+ */
+class ChannelManager {
+ private:
+  static constexpr std::chrono::seconds GC_PERIOD{10};
+
+  MessageExchanger& _messageExchanger;
+  const ErrorHandler& _errorHandler;
+
+  std::thread _thread = {};
+  std::mutex _mutex = {};
+  std::condition_variable _wakeUp = {};
+  bool _stopping = false;
+  std::atomic<unsigned long> _collected = {0};
+
+  void _run() noexcept;
+
+ public:
+  ChannelManager(MessageExchanger&, const ErrorHandler&) noexcept;
+  ~ChannelManager() noexcept;
+  ChannelManager(const ChannelManager&) = delete;
+  ChannelManager& operator=(const ChannelManager&) = delete;
+
+  /* Collect the channels every `GC_PERIOD`, until `stop`.
+   */
+  void start();
+  void stop() noexcept;
+
+  /* Remove the channels of the clients that are gone, return how many were removed.
+   */
+  std::size_t collect();
+
+  /* Pid of the client owning a channel, 0 if it is not the channel of a client.
+   */
+  static pid_t clientOf(const std::string& channel) noexcept;
+
+  /* Channels removed since the start.
+   */
+  unsigned long collected() const noexcept;
+};
@@ -1,21 +1,32 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "EntityInfo.hpp"
 #include "GameSettings.hpp"
+#include "InputLatency.hpp"
 #include "MessageData.hpp"
 #include "SandboxEdition.hpp"
 #include "SandboxSettings.hpp"
 #include "Token.hpp"
 
+class ChannelHandle;
+class FrameRing;
+
 class CommunicationAPI {
  private:
   Token _token = Token();
-  std::string _channel;
+  std::shared_ptr<ChannelHandle> _session;    // Named after the pid, kept whatever the token
+  std::shared_ptr<ChannelHandle> _channel;    // Read by the client: the session channel, or the one of the frames during a game
+  std::shared_ptr<ChannelHandle> _gameInput;  // Written at every input
   bool _secondPlayer = false;
   bool _isAdmin = false;
+  mutable InputLatency _inputLatency = {};  // Inputs are numbered as they are sent
+  mutable long _lastInputSent = 0;          // µs, on the monotonic clock
+  std::shared_ptr<FrameRing> _spectated = nullptr;
+  std::vector<unsigned char> _spectatedFrame = {};
 
   template<typename Data>
   Data _read(std::size_t nData = 1) const;
@@ -33,6 +44,9 @@ class CommunicationAPI {
   std::string getUsername() const noexcept;
   std::string getGuestUsername() const noexcept;
   bool isAdmin() const noexcept;
+  /* ID of the current game, to be given to its spectators.
+   */
+  std::string getGameID() const noexcept;
 
   ClientInfo signIn(const std::string& username, const std::string& password);
   ClientInfo signUp(const std::string& username, const std::string& password);
@@ -48,9 +62,30 @@ class CommunicationAPI {
   bool unfollow(const std::string& username) const;
 
   bool createGame(const GameSettings&);
+  /* Send an input of the client, polled at every refresh.
+   * No key pressed sends nothing, but an empty key once in a while, so that
+   *  the server does not take an idle player for a disconnected one.
+   */
   void sendGameInput(int key) const;
-  RefreshFrame getGameState(std::vector<EntityFrame>& dest) const;
+  RefreshFrame getGameState(std::vector<PlayerFrame>& players, std::vector<EntityFrame>& dest) const;
   void quitGame();
+  /* Latency of the inputs of the current game: call `show` once a refresh is displayed.
+   */
+  InputLatency& inputLatency() noexcept;
+
+  /* Watch a running game, return false if there is no such game.
+   * Its frames are read with `getSpectatedState` until `stopSpectating`.
+   */
+  bool spectateGame(const std::string& gameID);
+  /* Wait for the next frame of the game spectated, the frames a spectator is
+   *  too slow to read are skipped. Return false once the game was quit and
+   *  every frame was read.
+   */
+  bool getSpectatedState(RefreshFrame&, std::vector<PlayerFrame>& players, std::vector<EntityFrame>& dest);
+  /* Frames skipped since the start of the spectating.
+   */
+  unsigned long spectatedSkips() const noexcept;
+  void stopSpectating() noexcept;
 
   void rateLevel(int lvlID, unsigned rating) const;
   std::vector<LevelInfo>& getLevels(std::vector<LevelInfo>& dest, const std::string& username, int nbEntries, int offset = 0) const;
@@ -65,4 +100,8 @@ class CommunicationAPI {
   std::vector<PackKey>& getPackKeys(std::vector<PackKey>& dest);
   std::string addPackKey(const std::string& pack, const std::string& key, int uses);
   void removePackKey(const std::string& key);
+
+  /* Get a snapshot of the load of the server, return false if the user is not an administrator.
+   */
+  bool getServerStats(ServerStats&, std::vector<ChannelStats>& channels) const;
 };
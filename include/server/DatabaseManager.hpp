@@ -8,10 +8,17 @@
 
 #include "EntityInfo.hpp"
 #include "MessageData.hpp"
+#include "Histogram.hpp"
+#include "server/game/LevelSource.hpp"
 
-class DatabaseManager {
+class DatabaseManager: public LevelSource {
  private:
   sqlite3* _db = nullptr;
+  Histogram _queryTimes = {};
+
+  /* Record the duration of each statement run, as a trace callback of SQLite.
+   */
+  static int _profileQuery(unsigned type, void* databaseManager, void* stmt, void* duration);
 
   /* Return true if the operation was successful.
    */
@@ -45,10 +52,14 @@ class DatabaseManager {
 
   DatabaseManager() = delete;
   DatabaseManager(const std::string& dbPath);
-  ~DatabaseManager() noexcept;
+  ~DatabaseManager() noexcept override;
   DatabaseManager(const DatabaseManager&) = delete;
   DatabaseManager& operator=(const DatabaseManager&) = delete;
 
+  /* Duration of every query run so far, in ns.
+   */
+  const Histogram& queryTimes() const noexcept;
+
   bool isAdmin(std::string username) const;
 
   std::vector<PlayerInfo>& populateLeaderboard(std::vector<PlayerInfo>& leaderboard, int size, int offset = 0);
@@ -77,9 +88,11 @@ class DatabaseManager {
   bool usePackKey(const std::string& key, const std::string& username);
   void removePackKey(const std::string& key = std::string());
 
-  LevelInfo getLevelInfo(int id) const;
+  LevelInfo getLevelInfo(int id) const override;
   std::vector<LevelInfo>& getLevels(std::vector<LevelInfo>& dest, int nbEntries = -1, int offset = 0, const std::string& username = "");
-  std::map<unsigned, std::vector<EntityInfo>>& populateLevel(std::map<unsigned, std::vector<EntityInfo>>&, int id);
+  std::vector<LevelInfo>& getCampaign(std::vector<LevelInfo>& dest) override;
+  Level& populateLevel(Level&, int id) override;
+  LevelPatterns& populatePatterns(LevelPatterns&, int id) override;
   std::vector<EntityInfo>& populateLevel(std::vector<EntityInfo>&, int id, unsigned progress);
   void addLevelEntity(int levelId, unsigned progress, const EntityInfo& entity);
   void removeLevelEntity(int levelId, unsigned progress, const EntityInfo& entity);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "server/FrameRing.hpp"
+#include "server/MessageExchanger.hpp"
+#include "server/game/FrameArena.hpp"
+
+/* Delivery of the frames of a game to its client and its spectators, without ever waiting for them.
+ * A frame is only written once the client read the previous ones, all but
+ *  part of one, so that it never reads a backlog of stale frames. Until then
+ *  the newest frame waits in the mailbox, the one it replaces is dropped.
+ * The frame waiting is the front frame of the game (see `FrameArena`), it is
+ *  not copied. Only the end of a frame partly written is, to be written first
+ *  the next time.
+ * A client that took no frame for `CLIENT_TIMEOUT` seconds is stalled.
+ * Spectators read every frame posted in a ring of their own (see `FrameRing`).
+ */
+class FrameMailbox {
+ private:
+  ChannelPtr _channel;
+  std::shared_ptr<FrameRing> _spectators;
+  std::atomic<unsigned long>& _droppedFrames;  // Of the server
+  std::vector<unsigned char> _rest = {};       // End of the last frame written
+  std::size_t _lastSize = 1;                   // Of the last frame written, the pipe starts empty
+  bool _pending = false;
+  long _waitingSince = 0;  // µs, on the monotonic clock
+
+  bool _writeRest();
+  void _write(const FrameArena&);
+
+ public:
+  /* The channel is made non-blocking.
+   */
+  FrameMailbox(ChannelPtr channel, std::shared_ptr<FrameRing> spectators, std::atomic<unsigned long>& droppedFrames);
+  ~FrameMailbox() noexcept = default;
+  FrameMailbox(const FrameMailbox&) = delete;
+  FrameMailbox& operator=(const FrameMailbox&) = delete;
+
+  /* Post the frame just built, in place of the one waiting if any.
+   */
+  void post(const FrameArena&);
+  /* Deliver the frame waiting if the client caught up, `frame` being still
+   *  the one posted last. Return whether everything posted was delivered.
+   */
+  bool flush(const FrameArena& frame);
+
+  bool stalled(long now) const noexcept;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Frames of a game shared with its spectators, in shared memory (see `shm_open`).
+ * The server copies each frame once in the ring, whatever the number of
+ *  spectators. Spectators map the ring read-only and read it at their own
+ *  pace with a cursor of their own, the server never waits for them: a
+ *  spectator that falls a ring behind skips to the newest frame.
+ * Frames are copied out and checked afterwards, the copy of a frame
+ *  overwritten meanwhile is retried on a newer one.
+ */
+class FrameRing {
+ public:
+  static constexpr std::size_t SIZE = 1 << 20;  // Bytes of frames
+  static constexpr unsigned long SLOTS = 64;    // Frames kept
+
+ private:
+  struct Slot {
+    std::atomic<unsigned long> frame;     // Number of the frame, 0 while it is written
+    std::atomic<unsigned long> position;  // Of its first byte, counted since the first frame
+    std::atomic<unsigned long> size;
+  };
+  struct Header {
+    std::atomic<unsigned long> published;  // Frames published, the newest one is the last
+    std::atomic<unsigned long> reserved;   // Bytes written or being written since the first frame
+    std::atomic<bool> closed;
+    Slot slots[SLOTS];
+  };
+  static_assert(std::atomic<unsigned long>::is_always_lock_free, "The ring is shared between processes");
+
+  const std::string _name;
+  const bool _writer;
+  std::atomic<Header*> _header = {nullptr};
+  std::mutex _openMutex = {};
+
+  // Of the writer
+  unsigned long _published = 0;
+  unsigned long _reserved = 0;
+
+  // Of a reader
+  unsigned long _cursor = 0;  // Last frame read
+  unsigned long _skipped = 0;
+
+  unsigned char* _data() const noexcept;
+  bool _copy(unsigned long frame, std::vector<unsigned char>& dest) const;
+
+ public:
+  /* The writer creates the ring once opened, a reader maps the ring of a
+   *  game already opened by the server, and starts at its newest frame.
+   */
+  FrameRing(const std::string& gameID, bool writer);
+  ~FrameRing() noexcept;
+  FrameRing(const FrameRing&) = delete;
+  FrameRing& operator=(const FrameRing&) = delete;
+
+  /* Create the shared memory of the ring if needed, frames are only published from then on.
+   */
+  void open();
+  /* Copy a frame in the ring, if it is open. A single thread publishes.
+   */
+  void publish(const void* frame, std::size_t size) noexcept;
+
+  /* Copy the frame following the last one read in `dest`, or the newest one
+   *  if it was overwritten. Return false if no frame was published since, or
+   *  if the writer overwrote the frames as they were copied.
+   */
+  bool read(std::vector<unsigned char>& dest);
+  /* Whether the game was quit, no frame is published anymore.
+   */
+  bool closed() const noexcept;
+  /* Frames overwritten before this reader read them.
+   */
+  unsigned long skipped() const noexcept;
+};
@@ -1,13 +1,80 @@
 #pragma once
 
+#include <sys/types.h>
+
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
+/* A channel opened by a `MessageExchanger` (see `MessageExchanger::getChannel`).
+ * Messages are read and written through it without looking the channel up by
+ *  name, which hot paths do once and keep the handle.
+ * Its descriptor is closed once the channel is closed by the exchanger and no
+ *  handle to it is left, so that a handle stays valid while it is used.
+ */
+class ChannelHandle {
+ private:
+  const std::string _name;
+  const int _fd;
+
+  std::atomic<unsigned long> _messagesRead = {0};
+  std::atomic<unsigned long> _bytesRead = {0};
+  std::atomic<unsigned long> _bytesWritten = {0};
+
+ public:
+  ChannelHandle(const std::string& name, int fd) noexcept;
+  ~ChannelHandle() noexcept;
+  ChannelHandle(const ChannelHandle&) = delete;
+  ChannelHandle& operator=(const ChannelHandle&) = delete;
+
+  const std::string& name() const noexcept;
+
+  /* Read `nData` Data in `dest`, see `MessageExchanger::readMessage`.
+   * Wait until all of them are read, fewer are only read at the end of the channel.
+   */
+  template<typename Data>
+  ssize_t read(Data* dest, std::size_t nData = 1);
+
+  template<typename Data>
+  void write(const Data& data);
+  template<typename Data>
+  void write(const std::vector<Data>& data);
+  /* Write `size` bytes already laid out as messages, in a single write.
+   */
+  void writeBytes(const void* data, std::size_t size);
+  /* Same as `writeBytes` on a non-blocking channel, without waiting for room in the pipe.
+   * Return the number of bytes written, only part of them if the pipe is almost full.
+   */
+  std::size_t tryWriteBytes(const void* data, std::size_t size);
+
+  /* Writes no longer wait for the reader, see `tryWriteBytes`.
+   */
+  void setNonBlocking();
+  /* Bytes written and not read yet.
+   */
+  std::size_t unread() const;
+
+  /* Discard the messages waiting on the channel, without blocking.
+   * Return the number of bytes discarded.
+   */
+  std::size_t drain();
+
+  unsigned long messagesRead() const noexcept;
+  unsigned long bytesRead() const noexcept;
+  unsigned long bytesWritten() const noexcept;
+};
+
+using ChannelPtr = std::shared_ptr<ChannelHandle>;
+
 /* A `MessageExchanger` allows processes to communicate by `Message`.
  * A `Message` in sent within a channel specified on writing or listening.
  * Channels are listened simultaneously.
+ * Open channels are kept in a registry, only locked to open and close them.
  */
 class MessageExchanger {
  private:
@@ -20,8 +87,13 @@ class MessageExchanger {
   using ThreadsMap = std::map<const std::string, std::thread>;
   ThreadsMap _listeningThreads = {};
 
-  using FileDescriptors = std::map<const std::string, int>;
-  FileDescriptors _fileDescriptors = {};
+  using ChannelMap = std::map<const std::string, ChannelPtr>;
+  ChannelMap _channels = {};
+  mutable std::mutex _channelsMutex = {};  // Channels are opened and closed by several threads
+
+  // Channels listened so far, whose messages are counted by their listening thread
+  ChannelMap _listenedChannels = {};
+  mutable std::mutex _listenedMutex = {};
 
   /* Check whether a channel is under listening or not.
    */
@@ -32,7 +104,7 @@ class MessageExchanger {
    * Note that the callback function is supposed to be a member function.
    */
   template<typename Data, typename This>
-  void _readMessages(const std::string& channelName, CallbackFunction<Data, This> callback, This* thisArg);
+  void _readMessages(ChannelPtr channel, CallbackFunction<Data, This> callback, This* thisArg);
 
  public:
   MessageExchanger() noexcept = default;
@@ -42,10 +114,18 @@ class MessageExchanger {
    */
   void init() const;
 
+  /* Get the handle of a channel, opening it if necessary.
+   */
+  ChannelPtr getChannel(const std::string& channelName);
+
   /* Open a new communication channel.
    */
   void openChannel(const std::string& channelName);
   void closeChannel(const std::string& channelName);
+  /* Close a channel and remove it from the pipe directory, return whether it was there.
+   * Processes that still have it open can use it until they close it.
+   */
+  bool removeChannel(const std::string& channelName);
 
   /* Start waiting a message on a specified channel.
    * The second parameter is a callback function to call with the message as parameter.
@@ -58,6 +138,18 @@ class MessageExchanger {
    */
   void stopListening(const std::string& channelName);
 
+  /* Get the number of messages read on each channel listened so far.
+   */
+  std::vector<std::pair<std::string, unsigned long>>& getMessageCounts(std::vector<std::pair<std::string, unsigned long>>& dest) const;
+
+  /* Number of channels in the pipe directory, whether they are open or were left behind.
+   */
+  std::size_t countChannels() const noexcept;
+  std::vector<std::string>& listChannels(std::vector<std::string>& dest) const;
+  /* Channels opened by this process, whether they are still in the pipe directory or not.
+   */
+  std::vector<std::string>& listOpenChannels(std::vector<std::string>& dest) const;
+
   /* Read a signle message on the given channelName and copy it in the given destination.
    * The return value can be:
    *  0 for EOF
@@ -75,6 +167,9 @@ class MessageExchanger {
    */
   template<typename Data>
   void writeMessage(const std::string& channelName, const std::vector<Data>& data);
+  /* Write `size` bytes already laid out as messages, in a single write.
+   */
+  void writeBytes(const std::string& channelName, const void* data, std::size_t size);
 };
 
 inline bool MessageExchanger::_isChannelListening(const std::string& channelName) const {
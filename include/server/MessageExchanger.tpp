@@ -4,32 +4,68 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <cstring>
 #include <utility>
 
 #include "Error.hpp"
 #include "server/MessageExchanger.hpp"
 
+template<typename Data>
+ssize_t ChannelHandle::read(Data* dest, std::size_t nData) {
+  // Frames may be written in several parts (see `FrameMailbox`), messages are read whole
+  std::size_t size = sizeof(Data) * nData;
+  std::size_t done = 0;
+  while (done != size) {
+    ssize_t n = ::read(_fd, reinterpret_cast<char*>(dest) + done, size - done);
+    if (n == -1 && errno == EINTR) continue;
+    if (n == -1) {
+      throw Error("Error while reading a message on the pipe " + _name);
+    }
+    if (n == 0) break;
+    done += std::size_t(n);
+  }
+  if (done != 0) {
+    _messagesRead.fetch_add(1, std::memory_order_relaxed);
+    _bytesRead.fetch_add(done, std::memory_order_relaxed);
+  }
+  return ssize_t(done);
+}
+
+template<typename Data>
+void ChannelHandle::write(const Data& msg) {
+  writeBytes(&msg, sizeof(Data));
+}
+
+template<typename Data>
+void ChannelHandle::write(const std::vector<Data>& data) {
+  writeBytes(&data[0], sizeof(Data) * data.size());
+}
+
 template<typename Data, typename This>
 void MessageExchanger::startListening(const std::string& channelName, CallbackFunction<Data, This> fct, This* objPtr) {
   if (_isChannelListening(channelName)) {
     throw Error("This pipe is already under listening");
   }
 
-  openChannel(channelName);
+  ChannelPtr channel = getChannel(channelName);
+  {
+    std::lock_guard<std::mutex> lock(_listenedMutex);
+    _listenedChannels[channelName] = channel;
+  }
 
   // Create a new thread to listen on this channel
-  std::thread newThread(&MessageExchanger::_readMessages<Data, This>, this, channelName, fct, objPtr);
+  std::thread newThread(&MessageExchanger::_readMessages<Data, This>, this, channel, fct, objPtr);
   _listeningThreads.insert({channelName, std::move(newThread)});
 }
 
 template<typename Data, typename This>
-void MessageExchanger::_readMessages(const std::string& channelName, CallbackFunction<Data, This> fct, This* objPtr) {
+void MessageExchanger::_readMessages(ChannelPtr channel, CallbackFunction<Data, This> fct, This* objPtr) {
   Data* data = static_cast<Data*>(malloc(sizeof(Data)));
 
   ssize_t n;
   // Read messages on pipe
-  while ((n = readMessage(data, channelName)) != -1) {
+  while ((n = channel->read(data)) != -1) {
     if (n != 0) {
       (objPtr->*fct)(*data);
     }
@@ -40,32 +76,15 @@ void MessageExchanger::_readMessages(const std::string& channelName, CallbackFun
 
 template<typename Data>
 ssize_t MessageExchanger::readMessage(Data* dest, const std::string& channelName, std::size_t nData) {
-  // Open the channel if necessary
-  openChannel(channelName);
-
-  ssize_t n;
-  if ((n = read(_fileDescriptors.at(channelName), dest, sizeof(Data) * nData)) == -1) {
-    throw Error("Error while reading a message on the pipe " + channelName);
-  }
-  return n;
+  return getChannel(channelName)->read(dest, nData);
 }
 
 template<typename Data>
 void MessageExchanger::writeMessage(const std::string& channelName, const Data& msg) {
-  // Open the channel if necessary
-  openChannel(channelName);
-
-  if (write(_fileDescriptors.at(channelName), &msg, sizeof(Data)) == -1) {
-    throw Error("Error while writing a message on the pipe " + channelName);
-  }
+  getChannel(channelName)->write(msg);
 }
 
 template<typename Data>
 void MessageExchanger::writeMessage(const std::string& channelName, const std::vector<Data>& data) {
-  // Open the channel if necessary
-  openChannel(channelName);
-
-  if (write(_fileDescriptors.at(channelName), &data[0], sizeof(Data) * data.size()) == -1) {
-    throw Error("Error while writing a message on the pipe " + channelName);
-  }
+  getChannel(channelName)->write(data);
 }
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "ErrorHandler.hpp"
+#include "Histogram.hpp"
+
+/* Degradation levels of the server, each level includes the previous ones.
+ */
+enum OverloadLevel: unsigned {
+  OVERLOAD_NONE,
+  OVERLOAD_COALESCE,   // Late ticks do not send their frame, the next tick on time sends a newer one
+  OVERLOAD_SEND_RATE,  // Games are sent at half their send rate
+  OVERLOAD_SPAWNS,     // Enemies drop no power-up
+  OVERLOAD_REFUSE,     // New games are refused
+};
+
+/* Watch the cost and the lateness of the ticks of every game, and step
+ *  through the degradation levels so that the server degrades gracefully
+ *  instead of all games running late.
+ * Ticks are reported by the game threads, the level is evaluated once per
+ *  window: it goes up by one level while ticks are late or over budget, and
+ *  down by one level once the server stayed idle enough for a few windows.
+ * Transitions are logged, metrics can be written to a file after each window.
+ */
+class OverloadController {
+ public:
+  struct Metrics {
+    OverloadLevel level = OVERLOAD_NONE;
+    unsigned long transitions = 0;
+    unsigned long ticks = 0;
+    unsigned long lateTicks = 0;
+    unsigned long coalescedFrames = 0;
+    unsigned long skippedFrames = 0;  // Frames not sent because of the lowered send rate
+    unsigned long refusedGames = 0;
+    double load = 0;  // Mean cost of a tick over its budget during the last window
+    double lateRatio = 0;  // Late ticks over ticks during the last window
+  };
+
+ private:
+  static constexpr long WINDOW = 1000000;        // µs
+  static constexpr double LATE_FRACTION = 0.5;   // Lateness of a late tick, in ticks
+  static constexpr double RAISE_LOAD = 0.9;
+  static constexpr double RAISE_LATE_RATIO = 0.05;
+  static constexpr double LOWER_LOAD = 0.5;
+  static constexpr double LOWER_LATE_RATIO = 0.005;
+  static constexpr unsigned LOWER_WINDOWS = 5;  // Idle windows before lowering the level
+
+  const ErrorHandler& _errorHandler;
+  std::string _metricsPath = "";
+  bool _enabled = true;
+
+  std::atomic<unsigned> _level = {OVERLOAD_NONE};
+  std::atomic<unsigned long> _coalescedFrames = {0};
+  std::atomic<unsigned long> _skippedFrames = {0};
+  std::atomic<unsigned long> _refusedGames = {0};
+  Histogram _lateness = {};  // µs
+
+  // Protects the window and the metrics below
+  mutable std::mutex _mutex = {};
+  long _windowStart = 0;
+  unsigned long _windowTicks = 0;
+  unsigned long _windowLateTicks = 0;
+  double _windowLoad = 0;
+  unsigned _idleWindows = 0;
+  Metrics _metrics = {};
+
+  void _evaluate(long now);
+  void _setLevel(OverloadLevel, const char* reason);
+  void _writeMetrics() const noexcept;
+
+ public:
+  explicit OverloadController(const ErrorHandler&) noexcept;
+  ~OverloadController() noexcept = default;
+  OverloadController(const OverloadController&) = delete;
+  OverloadController& operator=(const OverloadController&) = delete;
+
+  /* Disable the controller, the level then stays at OVERLOAD_NONE.
+   */
+  void disable() noexcept;
+
+  /* Write the metrics to `path` after each window, in the text format of
+   *  Prometheus (one "name value" line per metric).
+   */
+  void exportMetrics(const std::string& path) noexcept;
+
+  // Late ticks in a row whose frame may be coalesced with the next one
+  static constexpr unsigned MAX_COALESCED_FRAMES = 2;
+
+  /* Whether a tick that started `lateness` µs after it was due, with a budget of `budget` µs, is late.
+   */
+  static bool isLate(long lateness, long budget) noexcept;
+
+  /* Report a tick that cost `cost` µs, started `lateness` µs after it was due,
+   *  and had `budget` µs to run.
+   */
+  void reportTick(long cost, long lateness, long budget) noexcept;
+
+  /* Evaluate the level if the window elapsed, even without ticks reported.
+   */
+  void update() noexcept;
+
+  OverloadLevel level() const noexcept;
+
+  void countCoalescedFrame() noexcept;
+  void countSkippedFrame() noexcept;
+  void countRefusedGame() noexcept;
+
+  Metrics metrics() const noexcept;
+
+  /* How late every reported tick started, in µs.
+   */
+  const Histogram& lateness() const noexcept;
+};
+
+const char* overloadLevelName(OverloadLevel) noexcept;
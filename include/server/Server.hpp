@@ -1,8 +1,13 @@
 #pragma once
 
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "ErrorHandler.hpp"
 #include "GameSettings.hpp"
@@ -11,9 +16,14 @@
 #include "SandboxEdition.hpp"
 #include "SandboxSettings.hpp"
 #include "Token.hpp"
+#include "server/ChannelManager.hpp"
 #include "server/DatabaseManager.hpp"
+#include "server/FrameMailbox.hpp"
 #include "server/MessageExchanger.hpp"
+#include "server/OverloadController.hpp"
+#include "server/TickProfiler.hpp"
 #include "server/game/Game.hpp"
+#include "server/game/GameBatch.hpp"
 #include "server/sandbox/Sandbox.hpp"
 
 /* The main server class.
@@ -22,34 +32,88 @@
  */
 class Server final {
  private:
+  /* Thread refreshing a batch of games (see `batchGames`).
+   * The games of a worker run at the same tick rate.
+   */
+  struct GameWorker {
+    GameBatch batch = {};
+    std::map<const Game*, std::unique_ptr<FrameMailbox>> mailboxes = {};
+    std::vector<const Game*> leaving = {};  // Ended games whose last frame is not delivered yet
+    std::map<const Game*, std::shared_ptr<TickProfiler>> profilers = {};
+    std::mutex mutex = {};
+    std::thread* thread = nullptr;
+    unsigned tickRate = FPS;
+    unsigned long ticks = 0;
+    unsigned coalescedFrames = 0;  // Frames coalesced in a row
+    std::set<const Game*> owedFrames = {};  // Games whose coalesced frame is sent on the next tick on time
+  };
+
   struct GameStatus {
-    Activity* ptr;
-    std::string tokenSignature;
-    std::string usernames[2];
+    Activity* ptr = nullptr;
+    std::string channel;  // Of the client, frames are sent beside it (see `Token::getGameChannel`)
+    std::vector<std::string> usernames;  // Players with an account, in the order of the game
+    std::shared_ptr<FrameRing> spectators;
     std::thread* thread = nullptr;
+    GameWorker* worker = nullptr;  // Set instead of `thread` when games are batched
   };
   using GameMap = std::map<const std::string, GameStatus>;
 
   struct SandboxStatus {
-    Activity* ptr;
-    std::string tokenSignature;
+    Activity* ptr = nullptr;
+    std::string channel;
     std::string username;
   };
   using SandboxMap = std::map<const std::string, SandboxStatus>;
 
-  static inline bool _isTokenValid(const Token& token) noexcept;
+  /* Check the signature of a token, counting the invalid ones.
+   */
+  inline bool _isTokenValid(const Token& token) noexcept;
 
   ErrorHandler _errorHandler;
   DatabaseManager _databaseManager;
   MessageExchanger _messageExchanger = {};
+  ChannelManager _channelManager{_messageExchanger, _errorHandler};
+  OverloadController _overloadController{_errorHandler};
 
   GameMap _activeGames = {};
+  mutable std::mutex _gamesMutex = {};  // Games are added, looked up and quit by several listening threads
   SandboxMap _activeSandboxes = {};
 
-  /* Create a communication channel to the client.
-  *  Return an access token.
+  std::string _replayDirectory = "";
+
+  // Games by worker thread, 0 gives each game its own thread
+  std::size_t _batchSize = 0;
+  std::vector<GameWorker*> _workers = {};
+  std::atomic<bool> _stopping = {false};
+
+  // Rates forced on every game, 0 keeps the rate of the game settings
+  unsigned _tickRate = 0;
+  unsigned _sendRate = 0;
+
+  // Entities from which the ticks of a game are split across cores, 0 disables it
+  std::size_t _parallelThreshold = PARALLEL_TICK_THRESHOLD;
+
+  // Tick profiling, switched by SIGUSR2 and dumped to `_profilePath` on SIGUSR1
+  std::atomic<bool> _profiling = {false};
+  std::string _profilePath = "";
+  TickProfiler _profiler{};
+  std::mutex _profilersMutex = {};
+  std::map<const std::string, std::shared_ptr<TickProfiler>> _gameProfilers = {};
+
+  // Operational metrics (see `_serverStats`)
+  long _startTime = 0;
+  std::atomic<unsigned long> _tokenFailures = {0};
+  std::atomic<unsigned long> _droppedFrames = {0};
+  std::atomic<unsigned long> _stalledClients = {0};
+  std::mutex _statsMutex = {};
+  long _lastStatsTime = 0;
+  std::map<std::string, unsigned long> _lastMessageCounts = {};
+
+  /* Return an access token for the client listening on `channel`.
+   * The client keeps its channel whatever the token, so that no channel is created per token.
    */
-  Token _initCommunicationToClient(const std::string& username, const std::string& gameID = "", const std::string& secondUsername = "") noexcept;
+  Token _initCommunicationToClient(
+      const std::string& username, const std::string& gameID, const std::string& channel, const std::string& secondUsername = "") noexcept;
 
   /* Check if the given username and password match.
    * Will send a response to the client: Message<bool> with a completed
@@ -100,12 +164,66 @@ class Server final {
    */
   void _addNewGame(const Message<GameSettings>&);
 
-  /* Apply a client input on its related game.
+  /* Queue a client input on its related game, applied at the start of its next tick.
+   * Inputs of every game are read by a single thread, the one listening to them.
+   */
+  void _applyInput(const Message<GameInput>&);
+
+  /* Send a refresh of the game to its client: RefreshFrame, PlayerFrames then EntityFrames.
+   * Building and posting the frame are recorded in `profiler` if given.
+   */
+  void _sendRefresh(FrameMailbox&, Game&, TickProfiler* profiler = nullptr);
+
+  /* Deliver the frame waiting in the mailbox of a game, stopping the game if its client stalled.
+   */
+  void _flushRefresh(FrameMailbox&, Game&);
+
+  /* Whether the refresh following the tick `tick` is sent to the client.
+   * Refreshes are spread evenly over the ticks of a second, at half the send
+   *  rate of the game while the server is overloaded.
    */
-  void _applyInput(const Message<int>&);
+  bool _isSendTick(unsigned long tick, const Game&) noexcept;
 
-  void _playGame(const std::string& gameID);
-  void _quitGame(const Message<Channel>&);
+  /* Whether the frames of a tick that started `lateness` µs late are
+   *  coalesced with the next ones, `coalescedFrames` being the frames
+   *  coalesced in a row so far.
+   * A coalesced frame is owed: it is sent on the next tick on time, even if
+   *  that tick is not a send tick (see `_isSendTick`).
+   */
+  bool _coalesceFrames(long lateness, long tickDuration, unsigned& coalescedFrames) noexcept;
+
+  /* Cap the drops of the game while the server is overloaded.
+   */
+  void _capDrops(Game&);
+
+  void _playGame(Game*, ChannelPtr channel, std::shared_ptr<FrameRing> spectators, std::shared_ptr<TickProfiler>);
+
+  /* Add a started game to a worker of its tick rate with room left, creating one if needed.
+   */
+  GameWorker* _addToWorker(Game*, ChannelPtr channel, std::shared_ptr<FrameRing> spectators, std::shared_ptr<TickProfiler>);
+
+  /* Refresh the games of a worker until the server stops.
+   * Ended games leave the batch, and the worker once their last frame is delivered.
+   */
+  void _playGames(GameWorker*);
+  void _quitGame(const Message<bool>&);
+
+  /* Let a client watch a running game, its frames are shared with every
+   *  spectator of the game (see `FrameRing`). Answer whether the game exists.
+   */
+  void _spectateGame(const Message<SpectateRequest>&);
+
+  /* Profiler of a new game, feeding the one of the server. It is dumped until the game is quit.
+   */
+  std::shared_ptr<TickProfiler> _newGameProfiler(const std::string& gameID);
+
+  /* Switch the tick profiling, histograms start over each time it is switched on.
+   */
+  void _toggleProfiling();
+
+  /* Write the histograms of the server then of each game to the profile file.
+   */
+  void _dumpProfile();
 
   /* Check if the sandbox exists.
    */
@@ -142,7 +260,7 @@ class Server final {
    */
   void _getLvlProgress(const Message<unsigned>&);
 
-  void _quitSandbox(const Message<Channel>&);
+  void _quitSandbox(const Message<bool>&);
 
   /* Get existing packs with a flag indicating if the user
    *  already own it or not.
@@ -161,11 +279,20 @@ class Server final {
    */
   void _getPackKeys(const Message<PackKeyRequest>&);
 
+  /* Get a snapshot of the load of the server, for administrators only.
+   * Will send a response to the client: bool indicating whether the user is
+   *  an administrator, then ServerStats followed by as many ChannelStats as
+   *  listened channels.
+   */
+  void _serverStats(const Message<bool>&);
+
  public:
   Server() noexcept;
   ~Server() noexcept;
 
   /* Start the server.
+   * The calling thread then waits for SIGUSR1, which dumps the tick profile,
+   *  and SIGUSR2, which switches the tick profiling on or off.
    * Will start listening on these channels:
    *  - connectClient
    *  - connectPlayer
@@ -178,16 +305,55 @@ class Server final {
    *  - newGame
    *  - gameInput
    *  - stopGame
+   *  - spectateGame
    *  - levelRequest
    *  - rateLevel
    *  - newSandbox
    *  - sandboxEdition
    *  - getLvlProgress
    *  - stopSandbox
+   *  - serverStats
    */
   void start() noexcept;
 
   /* Stop the server.
    */
   void stop() noexcept;
+
+  /* Record the replay of every new game in `directory` (see `ReplayRecorder`).
+   * Replays are named after the game ID.
+   */
+  void recordReplays(const std::string& directory) noexcept;
+
+  /* Refresh up to `gamesPerThread` games together on each game thread (see `GameBatch`).
+   * 0, the default, gives each game its own thread.
+   * Must be called before the server starts.
+   */
+  void batchGames(std::size_t gamesPerThread) noexcept;
+
+  /* Simulate every new game at `tickRate` ticks/s, and send it to its client
+   *  `sendRate` times per second, whatever the game settings ask for.
+   * 0 keeps the rate of the game settings.
+   */
+  void setRates(unsigned tickRate, unsigned sendRate) noexcept;
+
+  /* Split the ticks of every new game across cores once it holds at least
+   *  `threshold` entities (see `Game::setParallelThreshold`).
+   * 0, the default, disables it: each crowded game starts its own OpenMP team,
+   *  so a few of them oversubscribe the host unless OMP_NUM_THREADS bounds the teams.
+   */
+  void parallelTicks(std::size_t threshold) noexcept;
+
+  /* Write the overload metrics to `path` once per second (see `OverloadController`).
+   */
+  void exportOverloadMetrics(const std::string& path) noexcept;
+
+  /* Keep every game at full rate, whatever the load of the server.
+   */
+  void disableOverloadControl() noexcept;
+
+  /* Profile the phases of every tick from the start, and dump the profile to
+   *  `path` instead of the log directory (see `start`).
+   */
+  void profileTicks(const std::string& path) noexcept;
 };
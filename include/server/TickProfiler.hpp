@@ -0,0 +1,53 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include "Histogram.hpp"
+#include "server/game/Game.hpp"
+
+/* Profiled phases: the phases of `Game::refresh`, then the ones of the server.
+ */
+enum ProfiledPhase: unsigned {
+  PHASE_MOVES,
+  PHASE_OFF_SCREEN,
+  PHASE_LOAD_LEVEL,
+  PHASE_ATTACKS,
+  PHASE_COLLISIONS,
+  PHASE_STATES,
+  PHASE_FRAME,  // Building the frame sent to the client
+  PHASE_WRITE,  // Writing it on the channel of the client
+  PHASE_TICK,   // Whole tick, from the refresh to the write
+  NB_PHASES,
+};
+
+const char* profiledPhaseName(ProfiledPhase) noexcept;
+
+/* Histograms of the duration of each phase of a tick.
+ * Durations recorded in a profiler are recorded in its parent as well, so
+ *  that the profiler of each game feeds the one of the whole server.
+ */
+class TickProfiler {
+ private:
+  TickProfiler* _parent;
+  Histogram _phases[NB_PHASES] = {};
+
+ public:
+  explicit TickProfiler(TickProfiler* parent = nullptr) noexcept;
+  ~TickProfiler() noexcept = default;
+  TickProfiler(const TickProfiler&) = delete;
+  TickProfiler& operator=(const TickProfiler&) = delete;
+
+  void record(ProfiledPhase, long ns) noexcept;
+  /* Record the phases of one tick of `Game::refresh`.
+   */
+  void record(const TickPhases&) noexcept;
+  void reset() noexcept;
+
+  const Histogram& phase(ProfiledPhase) const noexcept;
+
+  /* Write a table of the phases under a `title` line: count, mean, percentiles and maximum, in µs.
+   * Phases never recorded are left out.
+   */
+  void dump(std::ostream&, const std::string& title) const;
+};
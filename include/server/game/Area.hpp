@@ -0,0 +1,18 @@
+#pragma once
+
+#include "constants.hpp"
+
+/* Rectangle of the world, in map units.
+ * The default area is the screen.
+ */
+struct Area {
+  int xMin = 0;
+  int yMin = 0;
+  int xMax = MAP_WIDTH;
+  int yMax = MAP_HEIGHT;
+
+  friend bool operator==(const Area& a, const Area& b) noexcept {
+    return a.xMin == b.xMin && a.yMin == b.yMin && a.xMax == b.xMax && a.yMax == b.yMax;
+  }
+  friend bool operator!=(const Area& a, const Area& b) noexcept { return !(a == b); }
+};
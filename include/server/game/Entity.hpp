@@ -7,20 +7,58 @@
 #include "server/game/Map.hpp"
 #include "PhysicsBox.hpp"
 #include "constants.hpp"
+#include "server/game/MovePattern.hpp"
+#include "server/game/Real.hpp"
+#include "server/game/Snapshot.hpp"
 
 class Group;
 class Map;
 class Boss;
 class Henchman;
 
+/* Physics box of an entity, in the simulation number type.
+ */
+struct Body {
+  Real xPos;
+  Real yPos;
+  int xSize;
+  int ySize;
+  Real xVelocity;
+  Real yVelocity;
+
+  Body(Real xPos, Real yPos, int xSize, int ySize, Real xVelocity, Real yVelocity) noexcept;
+  Body(const PhysicsBox&) noexcept;
+};
+
 class Entity {
+  friend class PhysicsEngine;
+
  private:
   unsigned _ID;
-  PhysicsBox _physicsBox;
+  Body _physicsBox;
+
+  // Last collision pass during which the death of this entity was checked
+  unsigned _collisionEpoch = 0;
+
+  // Displacement during the last move, zero for an entity spawned or teleported since
+  Real _xMove = 0;
+  Real _yMove = 0;
+
+  // Index of the entity in the snapshot being taken
+  std::int32_t _snapshotIndex = NO_ENTITY;
 
   void _moveX() noexcept;
   void _moveY() noexcept;
 
+  /* Whether the last move of the entity is larger than its size on an axis.
+   */
+  bool _isFast() const noexcept;
+
+  /* Whether the boxes overlap at any time of the last move, both entities
+   *  moving in a straight line from their previous position.
+   */
+  bool _isSweptTouching(const Entity*) const noexcept;
+
  protected:
   Map* _map;
   Group* _group;
@@ -28,12 +66,16 @@ class Entity {
   unsigned _state = MOVE_STATE;
   unsigned _stateStep = 0;
 
-  void setxPos(double) noexcept;
-  void setyPos(double) noexcept;
+  void setxPos(Real) noexcept;
+  void setyPos(Real) noexcept;
   void resetVelocity();
 
+  /* Index of an entity in the snapshot being taken, NO_ENTITY for nullptr.
+   */
+  static std::int32_t _snapshotIndexOf(const Entity*) noexcept;
+
  public:
-  Entity(unsigned, const PhysicsBox&, Map*, Group*) noexcept;
+  Entity(unsigned, const Body&, Map*, Group*) noexcept;
   virtual ~Entity() noexcept;
   Entity(const Entity&) = delete;
   Entity& operator=(const Entity&) = delete;
@@ -43,64 +85,86 @@ class Entity {
   virtual unsigned state() const noexcept;
   unsigned stateStep() const noexcept;
 
-  double xPos() const noexcept;
-  double yPos() const noexcept;
+  Real xPos() const noexcept;
+  Real yPos() const noexcept;
   int xSize() const noexcept;
   int ySize() const noexcept;
-  double xVelocity() const noexcept;
-  double yVelocity() const noexcept;
+  Real xVelocity() const noexcept;
+  Real yVelocity() const noexcept;
 
-  void setVelocityX(double);
-  void setVelocityY(double);
+  void setVelocityX(Real);
+  void setVelocityY(Real);
 
   virtual void move();
   virtual void refreshState() noexcept;
 
   void removeFromGroup();
 
+  /* Whether the boxes of the entities overlap.
+   * Fast entities could tunnel through thin ones between two ticks, so when one
+   *  of them moved more than its size the whole move is tested instead (swept AABB).
+   */
   bool isTouching(const Entity*) const noexcept;
   virtual void touch(Entity*) noexcept = 0;
+
+  /* Write the state of the entity to a snapshot record (see `PhysicsEngine::snapshot`).
+   * The group of the entity is written by the physics engine.
+   */
+  virtual void save(EntityRecord&) const noexcept;
+
+  /* Read the state of the entity from a snapshot record.
+   * `entities` are the entities restored from the snapshot, by index.
+   */
+  virtual void load(const EntityRecord&, Entity* const* entities) noexcept;
 };
 
 class PowerUp: public Entity {
  private:
-  double _fireDamageFactor;
-  double _fireRateFactor;
+  Real _fireDamageFactor;
+  Real _fireRateFactor;
 
  public:
-  PowerUp(unsigned, const PhysicsBox&, Map*, double additionnalDamage, double additionnalFireRate) noexcept;
+  PowerUp(unsigned, const Body&, Map*, Real additionnalDamage, Real additionnalFireRate) noexcept;
   ~PowerUp() noexcept override = default;
 
-  double fireDamageFactor() const noexcept;
-  double fireRateFactor() const noexcept;
+  Real fireDamageFactor() const noexcept;
+  Real fireRateFactor() const noexcept;
 
   void touch(Entity*) noexcept override {}
+
+  void save(EntityRecord&) const noexcept override;
+  void load(const EntityRecord&, Entity* const*) noexcept override;
 };
 
 class PhysicalEntity: public Entity {
  protected:
-  double _hp;
-  double _damage;
+  Real _hp;
+  Real _damage;
 
  public:
-  PhysicalEntity(unsigned, const PhysicsBox&, Map*, Group*, double hp, double damage) noexcept;
+  PhysicalEntity(unsigned, const Body&, Map*, Group*, Real hp, Real damage) noexcept;
   ~PhysicalEntity() noexcept override = 0;
 
-  double getDamage() const noexcept;
-  double hp() const noexcept;
+  Real getDamage() const noexcept;
+  Real hp() const noexcept;
 
   virtual bool checkDeath() noexcept;
 
-  virtual void hurt(double damage) noexcept;
+  virtual void hurt(Real damage) noexcept;
   void touch(Entity*) noexcept override;
   virtual void kill() noexcept;
+
+  void save(EntityRecord&) const noexcept override;
+  void load(const EntityRecord&, Entity* const*) noexcept override;
 };
 
 class Obstacle: public PhysicalEntity {
  public:
   Obstacle() = delete;
   ~Obstacle() noexcept override = default;
-  Obstacle(unsigned, const PhysicsBox&, Map*) noexcept;
+  Obstacle(unsigned, const Body&, Map*) noexcept;
+
+  void save(EntityRecord&) const noexcept override;
 };
 
 class Player;
@@ -109,94 +173,125 @@ class Bullet: public PhysicalEntity {
   Player* _shooter;
 
  public:
-  Bullet(unsigned, const PhysicsBox&, Map*, double fireDamage, Player* shooter = nullptr) noexcept;
+  Bullet(unsigned, const Body&, Map*, Real fireDamage, Player* shooter = nullptr) noexcept;
   ~Bullet() noexcept override = default;
   Bullet(const Bullet&) = delete;
   Bullet& operator=(const Bullet&) = delete;
 
   Player* getShooter() const noexcept;
+
+  void save(EntityRecord&) const noexcept override;
+  void load(const EntityRecord&, Entity* const*) noexcept override;
 };
 
 class Character: public PhysicalEntity {
  protected:
-  double _fireDamage;
+  Real _fireDamage;
   unsigned _fireDelay;
   unsigned _remainingDelay = 0;
 
-  virtual Bullet* _createBullet(double xOffset, double xVelocity = 0) noexcept = 0;
+  virtual Bullet* _createBullet(Real xOffset, Real xVelocity = 0) noexcept = 0;
 
  public:
-  Character(unsigned, const PhysicsBox&, Map*, Group*, double hp, double damage, double fireDamage, unsigned fireDelay) noexcept;
+  Character(unsigned, const Body&, Map*, Group*, Real hp, Real damage, Real fireDamage, unsigned fireDelay) noexcept;
   ~Character() noexcept override = default;
 
-  virtual double fireDamage() const noexcept;
+  virtual Real fireDamage() const noexcept;
   virtual unsigned fireDelay() const noexcept;
 
   bool checkDeath() noexcept override;
 
   virtual void shoot() noexcept;
+
+  void save(EntityRecord&) const noexcept override;
+  void load(const EntityRecord&, Entity* const*) noexcept override;
 };
 
 class Enemy: public Character {
+  friend class PhysicsEngine;
+
  private:
-  std::size_t _counter = 0;
+  std::size_t _counter = 0;  // Cursor in the movement pattern
+  const MovePattern* _levelPattern = nullptr;
 
   PowerUp* _dropPowerUp() const noexcept;
 
  protected:
-  Bullet* _createBullet(double xOffset, double xVelocity = 0) noexcept override;
+  Bullet* _createBullet(Real xOffset, Real xVelocity = 0) noexcept override;
 
-  const double _bonusProbability;
-  const double _difficulty;
+  const Real _bonusProbability;
+  const Real _difficulty;
 
  public:
-  Enemy(unsigned, const PhysicsBox&, Map*, double hp, unsigned fireDelay, double fireDamage, double bonusProbability, double difficulty) noexcept;
+  Enemy(unsigned, const Body&, Map*, Real hp, unsigned fireDelay, Real fireDamage, Real bonusProbability, Real difficulty) noexcept;
   ~Enemy() noexcept override = default;
 
   void touch(Entity*) noexcept override;
   void kill() noexcept override;
 
   void move() override;
-  virtual const std::vector<std::array<int, 2>>& getMoves() const = 0;
+
+  /* Built-in movement pattern of this kind of enemy.
+   */
+  virtual const MovePattern& pattern() const noexcept = 0;
+
+  /* Replace the built-in pattern by a pattern defined by the level.
+   * The pattern must outlive the enemy.
+   */
+  void setLevelPattern(const MovePattern*) noexcept;
+
+  /* Pattern followed during the next move.
+   */
+  const MovePattern& currentPattern() const noexcept;
+
+  /* The level pattern is only flagged in the record, the physics engine sets it back on load.
+   */
+  void save(EntityRecord&) const noexcept override;
+  void load(const EntityRecord&, Entity* const*) noexcept override;
 };
 
 class Enemy_1: public Enemy {
  private:
-  static const std::vector<std::array<int, 2>> _moves;
+  static const MovePattern _pattern;
 
  public:
-  Enemy_1(unsigned, const PhysicsBox&, Map*, double bonusProbability, double difficulty) noexcept;
+  Enemy_1(unsigned, const Body&, Map*, Real bonusProbability, Real difficulty) noexcept;
   ~Enemy_1() noexcept override = default;
 
-  const std::vector<std::array<int, 2>>& getMoves() const override;
+  const MovePattern& pattern() const noexcept override;
+  void save(EntityRecord&) const noexcept override;
 };
 
 class Enemy_2: public Enemy {
  private:
-  static const std::vector<std::array<int, 2>> _moves;
+  static const MovePattern _pattern;
 
  public:
-  Enemy_2(unsigned, const PhysicsBox&, Map*, double bonusProbability, double difficulty) noexcept;
+  Enemy_2(unsigned, const Body&, Map*, Real bonusProbability, Real difficulty) noexcept;
   ~Enemy_2() noexcept override = default;
 
-  const std::vector<std::array<int, 2>>& getMoves() const override;
+  const MovePattern& pattern() const noexcept override;
+  void save(EntityRecord&) const noexcept override;
 };
 
 class Enemy_3: public Enemy {
  private:
-  static const std::vector<std::array<int, 2>> _moves;
+  static const MovePattern _pattern;
 
  public:
-  Enemy_3(unsigned, const PhysicsBox&, Map*, double bonusProbability, double difficulty) noexcept;
+  Enemy_3(unsigned, const Body&, Map*, Real bonusProbability, Real difficulty) noexcept;
   ~Enemy_3() noexcept override = default;
 
-  const std::vector<std::array<int, 2>>& getMoves() const override;
+  const MovePattern& pattern() const noexcept override;
+  void save(EntityRecord&) const noexcept override;
 };
 
 class Player: public Character {
+  friend class PhysicsEngine;
+
  private:
-  double _spawnX;
-  double _spawnY;
+  Real _spawnX;
+  Real _spawnY;
   unsigned _score = 0;
   unsigned _invincibilityTime = 0;
 
@@ -209,15 +304,15 @@ class Player: public Character {
   const bool _friendlyFire;
   const unsigned _initialLives;
 
-  Bullet* _createBullet(double xOffset, double xVelocity = 0) noexcept override;
+  Bullet* _createBullet(Real xOffset, Real xVelocity = 0) noexcept override;
 
  public:
-  Player(unsigned, const PhysicsBox&, Map*, bool friendlyFire, unsigned initialLives) noexcept;
-  ~Player() noexcept = default;
+  Player(unsigned, const Body&, Map*, bool friendlyFire, unsigned initialLives) noexcept;
+  ~Player() noexcept override;
   Player(const Player&) = delete;
   Player& operator=(const Player&) = delete;
 
-  double fireDamage() const noexcept override;
+  Real fireDamage() const noexcept override;
   unsigned fireDelay() const noexcept override;
   unsigned score() const noexcept;
   unsigned powerUpID() const noexcept;
@@ -228,7 +323,7 @@ class Player: public Character {
   void refreshState() noexcept override;
   void resetState() noexcept;
 
-  void hurt(double damage) noexcept override;
+  void hurt(Real damage) noexcept override;
   void pick(PowerUp*) noexcept;
   void touch(Entity*) noexcept override;
   void respawn() noexcept;
@@ -236,6 +331,9 @@ class Player: public Character {
   void addLife() noexcept;
   void toggleGhost() noexcept;
   void toggleHulk() noexcept;
+
+  void save(EntityRecord&) const noexcept override;
+  void load(const EntityRecord&, Entity* const*) noexcept override;
 };
 
 
@@ -245,8 +343,8 @@ class Player: public Character {
 
 class Boss: public Enemy {
  private:
-  const static std::vector<std::array<int, 2>> _movesBefore;  // Before killing henchmen
-  const static std::vector<std::array<int, 2>> _movesAfter;   // After killed henchmen
+  static const MovePattern _patternBefore;  // Before killing henchmen
+  static const MovePattern _patternAfter;   // After killed henchmen
 
   bool _gatlingMode = false;
 
@@ -257,14 +355,22 @@ class Boss: public Enemy {
   unsigned _remainingDelay2;
 
  public:
-  Boss(unsigned ID, const PhysicsBox& physicsBox, Map* map, double hp, unsigned fireDelay, double bonusProbability, double difficulty) noexcept;
+  Boss(unsigned ID, const Body& physicsBox, Map* map, Real hp, unsigned fireDelay, Real bonusProbability, Real difficulty) noexcept;
   ~Boss() noexcept override = default;
 
-  const std::vector<std::array<int, 2>>& getMoves() const override;
-  void hurt(double damage) noexcept override;
+  const MovePattern& pattern() const noexcept override;
+  void hurt(Real damage) noexcept override;
   virtual void shoot() noexcept override;
 
   virtual void spawnHenchmen(int henchmanWidth, int henchmanHeight, unsigned nHenchman) noexcept;
+
+  /* Spawn the henchmen escorting this kind of boss.
+   * Called once by the physics engine when the boss enters the map, not when it is restored.
+   */
+  virtual void spawnEscort() noexcept = 0;
+
+  void save(EntityRecord&) const noexcept override;
+  void load(const EntityRecord&, Entity* const*) noexcept override;
 };
 
 class Boss_1 final: public Boss {
@@ -273,8 +379,11 @@ class Boss_1 final: public Boss {
   Henchman* _createHenchman_2(int xPos, int henchmanWidth, int henchmanHeight) noexcept override;
 
  public:
-  Boss_1(unsigned ID, const PhysicsBox& physicsBox, Map* map, double bonusProbability, double difficulty) noexcept;
+  Boss_1(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept;
   ~Boss_1() noexcept override = default;
+
+  void spawnEscort() noexcept override;
+  void save(EntityRecord&) const noexcept override;
 };
 
 class Boss_2 final: public Boss {
@@ -283,8 +392,11 @@ class Boss_2 final: public Boss {
   Henchman* _createHenchman_2(int xPos, int henchmanWidth, int henchmanHeight) noexcept override;
 
  public:
-  Boss_2(unsigned ID, const PhysicsBox& physicsBox, Map* map, double bonusProbability, double difficulty) noexcept;
+  Boss_2(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept;
   ~Boss_2() noexcept override = default;
+
+  void spawnEscort() noexcept override;
+  void save(EntityRecord&) const noexcept override;
   void spawnHenchmen(int henchmanWidth, int henchmanHeight, unsigned nHenchman) noexcept override;
 };
 
@@ -294,44 +406,49 @@ class Boss_3 final: public Boss {
   Henchman* _createHenchman_2(int xPos, int henchmanWidth, int henchmanHeight) noexcept override;
 
  public:
-  Boss_3(unsigned ID, const PhysicsBox& physicsBox, Map* map, double bonusProbability, double difficulty) noexcept;
+  Boss_3(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept;
   ~Boss_3() noexcept override = default;
+
+  void spawnEscort() noexcept override;
+  void save(EntityRecord&) const noexcept override;
   void spawnHenchmen(int henchmanWidth, int henchmanHeight, unsigned nHenchman) noexcept override;
 };
 
 class Henchman: public Enemy {
  private:
-  const static std::vector<std::array<int, 2>> _moves;
-
-  Boss* _creator;
+  static const MovePattern _pattern;
 
  public:
-  Henchman(unsigned ID, const PhysicsBox& physicsBox, Map* map, Boss* creator, double hp, unsigned fireDelay, double bonusProbability, double difficulty) noexcept;
+  Henchman(unsigned ID, const Body& physicsBox, Map* map, Real hp, unsigned fireDelay, Real bonusProbability, Real difficulty) noexcept;
   ~Henchman() noexcept override = default;
-  Henchman(const Henchman&) = delete;
-  Henchman& operator=(const Henchman&) = delete;
 
-  const std::vector<std::array<int, 2>>& getMoves() const override;
+  const MovePattern& pattern() const noexcept override;
   void shoot() noexcept override;
 };
 
 // Tentacles
 class Henchman_1: public Henchman {
  public:
-  Henchman_1(unsigned ID, const PhysicsBox& physicsBox, Map* map, Boss* creator, double bonusProbability, double difficulty) noexcept;
+  Henchman_1(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept;
   ~Henchman_1() noexcept override = default;
+
+  void save(EntityRecord&) const noexcept override;
 };
 
 // Little space invaders
 class Henchman_2: public Henchman {
  public:
-  Henchman_2(unsigned ID, const PhysicsBox& physicsBox, Map* map, Boss* creator, double bonusProbability, double difficulty) noexcept;
+  Henchman_2(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept;
   ~Henchman_2() noexcept override = default;
+
+  void save(EntityRecord&) const noexcept override;
 };
 
 // Yooda
 class Henchman_3: public Henchman {
  public:
-  Henchman_3(unsigned ID, const PhysicsBox& physicsBox, Map* map, Boss* creator, double bonusProbability, double difficulty) noexcept;
+  Henchman_3(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept;
   ~Henchman_3() noexcept override = default;
+
+  void save(EntityRecord&) const noexcept override;
 };
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+/* A signed Q16.16 fixed-point number.
+ * Every operation is done with integer arithmetic so that results are
+ *  bit-identical whatever the compiler, the flags or the host.
+ * Range is [-32768, 32768[ with a resolution of 2^-16.
+ */
+class Fixed {
+ public:
+  using Raw = std::int32_t;
+  static constexpr int FRACTION_BITS = 16;
+  static constexpr Raw ONE = Raw(1) << FRACTION_BITS;
+
+ private:
+  Raw _raw = 0;
+
+  struct RawTag {};
+  constexpr Fixed(Raw raw, RawTag) noexcept: _raw(raw) {}
+
+ public:
+  constexpr Fixed() noexcept = default;
+
+  /* Integers are converted exactly.
+   */
+  template<typename Int, typename std::enable_if<std::is_integral<Int>::value, int>::type = 0>
+  constexpr Fixed(Int value) noexcept: _raw(Raw(value) * ONE) {}
+
+  /* Doubles are rounded to the nearest representable value (ties away from zero).
+   * Scaling by a power of 2 is exact, so the conversion does not depend on the host.
+   */
+  constexpr explicit Fixed(double value) noexcept
+      : _raw(Raw(value * ONE + ((value < 0) ? -0.5 : 0.5))) {}
+
+  static constexpr Fixed fromRaw(Raw raw) noexcept { return Fixed(raw, RawTag()); }
+
+  /* Exact rounding of num/den (ties away from zero).
+   */
+  static constexpr Fixed ratio(long num, long den) noexcept {
+    long scaled = num * long(ONE) * 2 / den;
+    return fromRaw(Raw((scaled + ((scaled < 0) ? -1 : 1)) / 2));
+  }
+
+  constexpr Raw raw() const noexcept { return _raw; }
+
+  constexpr double toDouble() const noexcept { return double(_raw) / ONE; }
+
+  // Truncate toward zero, as a cast from a double would do
+  constexpr int toInt() const noexcept { return (_raw < 0) ? -(-_raw >> FRACTION_BITS) : _raw >> FRACTION_BITS; }
+
+  constexpr explicit operator double() const noexcept { return toDouble(); }
+  constexpr explicit operator int() const noexcept { return toInt(); }
+  constexpr explicit operator unsigned() const noexcept { return unsigned(toInt()); }
+
+  constexpr Fixed operator-() const noexcept { return fromRaw(-_raw); }
+
+  constexpr Fixed& operator+=(Fixed other) noexcept {
+    _raw += other._raw;
+    return *this;
+  }
+  constexpr Fixed& operator-=(Fixed other) noexcept {
+    _raw -= other._raw;
+    return *this;
+  }
+  constexpr Fixed& operator*=(Fixed other) noexcept {
+    _raw = Raw((std::int64_t(_raw) * other._raw) >> FRACTION_BITS);
+    return *this;
+  }
+  constexpr Fixed& operator/=(Fixed other) noexcept {
+    _raw = Raw((std::int64_t(_raw) << FRACTION_BITS) / other._raw);
+    return *this;
+  }
+
+  friend constexpr Fixed operator+(Fixed a, Fixed b) noexcept { return a += b; }
+  friend constexpr Fixed operator-(Fixed a, Fixed b) noexcept { return a -= b; }
+  friend constexpr Fixed operator*(Fixed a, Fixed b) noexcept { return a *= b; }
+  friend constexpr Fixed operator/(Fixed a, Fixed b) noexcept { return a /= b; }
+
+  friend constexpr bool operator==(Fixed a, Fixed b) noexcept { return a._raw == b._raw; }
+  friend constexpr bool operator!=(Fixed a, Fixed b) noexcept { return a._raw != b._raw; }
+  friend constexpr bool operator<(Fixed a, Fixed b) noexcept { return a._raw < b._raw; }
+  friend constexpr bool operator>(Fixed a, Fixed b) noexcept { return a._raw > b._raw; }
+  friend constexpr bool operator<=(Fixed a, Fixed b) noexcept { return a._raw <= b._raw; }
+  friend constexpr bool operator>=(Fixed a, Fixed b) noexcept { return a._raw >= b._raw; }
+
+  friend constexpr Fixed floor(Fixed x) noexcept { return fromRaw(x._raw & ~(ONE - 1)); }
+  friend constexpr Fixed ceil(Fixed x) noexcept { return -floor(-x); }
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "MessageData.hpp"
+
+/* Refresh of a game laid out as it is sent to the client: a RefreshFrame,
+ *  its PlayerFrames then its EntityFrames, back to back.
+ * Two buffers are kept, the last built frame stays readable in one while the
+ *  next one is written in the other. Buffers only grow, so once they fit the
+ *  largest frame of the game, building a frame no longer allocates.
+ */
+class FrameArena {
+ private:
+  std::vector<unsigned char> _buffers[2] = {};
+  std::size_t _sizes[2] = {0, 0};
+  unsigned _front = 0;
+
+  std::size_t _nbPlayers = 0;
+  std::size_t _nbEntities = 0;
+
+  unsigned char* _back() noexcept;
+  std::size_t _entitiesOffset() const noexcept;
+
+ public:
+  FrameArena() noexcept = default;
+  ~FrameArena() noexcept = default;
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  /* Start a frame in the back buffer, with room for `maxEntities` entities.
+   */
+  void begin(std::size_t nbPlayers, std::size_t maxEntities);
+  void setPlayer(std::size_t nPlayer, const PlayerFrame&) noexcept;
+  /* Append an entity, at most `maxEntities` entities are appended.
+   */
+  void addEntity(const EntityFrame&) noexcept;
+  /* Write the refresh frame, its counts are the ones of the frame written,
+   *  then make the frame the front one.
+   */
+  void commit(RefreshFrame) noexcept;
+
+  /* Front frame, the last one committed.
+   */
+  const unsigned char* data() const noexcept;
+  std::size_t size() const noexcept;
+  RefreshFrame refreshFrame() const noexcept;
+};
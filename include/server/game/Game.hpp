@@ -1,36 +1,151 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "GameSettings.hpp"
 #include "MessageData.hpp"
 #include "server/Activity.hpp"
-#include "server/DatabaseManager.hpp"
+#include "server/game/FrameArena.hpp"
+#include "server/game/InputQueue.hpp"
 #include "server/game/LevelManager.hpp"
+#include "server/game/LevelSource.hpp"
 #include "server/game/PhysicsEngine.hpp"
+#include "server/game/Replay.hpp"
+#include "server/game/Snapshot.hpp"
+
+/* Time spent in each phase of a tick (ns).
+ */
+struct TickPhases {
+  long moves = 0;
+  long offScreen = 0;
+  long loadLevel = 0;
+  long attacks = 0;
+  long collisions = 0;
+  long states = 0;
+};
+
+/* Run a phase of a tick, adding its duration to `elapsed` if given.
+ */
+template<typename Fct>
+inline void timePhase(long* elapsed, Fct phase) {
+  if (!elapsed) {
+    phase();
+    return;
+  }
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  phase();
+  *elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
 
 class Game: public Activity {
+  friend class GameBatch;
+
  private:
   PhysicsEngine _physicsEngine;
   LevelManager _levelManager;
   long _lastInteraction = 0;
+  unsigned _sendRate;
+
+  ReplayInfo _replayInfo;
+  std::unique_ptr<ReplayRecorder> _recorder = nullptr;
+
+  FrameArena _frames = {};
+
+  // Inputs received and not simulated yet, then the last input simulated with its times (see `RefreshFrame`)
+  struct InputTrace {
+    unsigned sequence = 0;
+    long received = 0;
+    long applied = 0;
+  };
+  InputQueue _inputs = {};
+  InputTrace _appliedInput = {};
 
   void _loadLevel();
+  /* Apply the inputs queued before the tick starting, in the order they were received.
+   */
+  void _applyQueuedInputs();
+  bool _lost(long now) const noexcept;
+  int _gameState(long now) const noexcept;
+  EntityFrame _entityFrame(const Entity*, double xCamera, double yCamera) const noexcept;
+
+  /* Phases of a tick following the moves and the removal of off-screen entities.
+   */
+  void _refreshEntities(TickPhases*);
 
  public:
   Game() = delete;
   ~Game() override = default;
-  Game(const GameSettings&, DatabaseManager*, const std::vector<int> levelIDs) noexcept;
+  Game(const GameSettings&, LevelSource*, const std::vector<int> levelIDs, std::uint64_t seed) noexcept;
+
+  /* Simulated ticks per second, and refreshes to send to the clients per second.
+   */
+  unsigned tickRate() const noexcept;
+  unsigned sendRate() const noexcept;
 
   bool won() const noexcept;
   bool lost() const noexcept;
   bool hasEnded() const noexcept;
 
+  /* Frames only hold the entities in the view of the camera of the team,
+   *  positioned in the view, so that clients draw a screen whatever the size of the world.
+   */
   RefreshFrame getRefreshFrame() const noexcept;
+  std::vector<PlayerFrame>& getPlayerFrames(std::vector<PlayerFrame>& dest) const noexcept;
   std::vector<EntityFrame>& getEntityFrames(std::vector<EntityFrame>& dest) const noexcept;
 
+  /* Build the refresh of the current tick in the frame arena of the game, in
+   *  one pass over the world, and return it (see `FrameArena`).
+   * Does not allocate once the arena fits the largest frame of the game.
+   */
+  const FrameArena& buildFrame();
+  const FrameArena& frame() const noexcept;
+
+  /* Split ticks across cores once the game holds at least `threshold` entities (0 disables it).
+   */
+  void setParallelThreshold(std::size_t threshold) noexcept;
+
+  /* Record the replay of the game in the file at `path` (see `ReplayRecorder`).
+   * Must be called before the game starts.
+   */
+  void record(const std::string& path);
+
+  /* Hash of the simulation state: entities, scores and progress.
+   * Two games fed with the same replay have the same hash at every tick.
+   */
+  std::uint64_t stateHash() const noexcept;
+
+  /* Save the whole simulation state: entities, timers, level progress and random generator.
+   * Restoring the snapshot later rewinds (or fast-forwards) the game to the
+   *  tick of the snapshot. Snapshots only apply to games created with the
+   *  same settings, levels and level source.
+   * The recorded replay, if any, is not rewound.
+   */
+  void snapshot(GameSnapshot&) const;
+  void restore(const GameSnapshot&);
+
   void start();
-  void refresh();
 
+  /* Simulate one tick.
+   * If `phases` is given, the time spent in each phase is added to it.
+   */
+  void refresh(TickPhases* phases = nullptr);
+
+  /* Apply an input right away, from the thread refreshing the game.
+   */
   void applyInput(int key);
+  /* Queue an input of a client, applied at the start of the next tick.
+   * Only one thread may queue inputs, return false if too many are queued.
+   * The next refreshes hold its sequence once it is simulated, until a newer input is.
+   */
+  bool queueInput(const QueuedInput&) noexcept;
+
+  /* Stop or restart power-up drops, to lighten an overloaded server.
+   * The change is recorded in the replay, as an input applied by the server.
+   */
+  void capDrops(bool);
+  bool dropsCapped() const noexcept;
 };
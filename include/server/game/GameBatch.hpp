@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "server/game/Game.hpp"
+#include "server/game/WorldStore.hpp"
+
+/* Several games stepped together by one thread.
+ * Their entities are copied in a shared store, so that movements and bounds
+ *  are computed for every game in one pass. Attacks, collisions and states
+ *  stay per game.
+ * Each game is simulated exactly as if it was refreshed on its own.
+ */
+class GameBatch {
+ private:
+  std::vector<Game*> _games = {};
+  WorldStore _store = {};
+
+  // Index of the first entity of each game in the store, by group
+  std::vector<std::size_t> _offsets = {};
+
+ public:
+  GameBatch() noexcept = default;
+  ~GameBatch() noexcept = default;
+  GameBatch(const GameBatch&) = delete;
+  GameBatch& operator=(const GameBatch&) = delete;
+
+  /* Games must be started before being added.
+   * The batch does not own the games.
+   */
+  void add(Game*);
+  void remove(const Game*) noexcept;
+
+  std::size_t size() const noexcept;
+  const std::vector<Game*>& games() const noexcept;
+
+  /* Simulate one tick of every game.
+   * If `phases` is given, the time spent in each phase is added to it.
+   */
+  void refresh(TickPhases* phases = nullptr);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/* Input of a client, received by the server and not simulated yet.
+ */
+struct QueuedInput {
+  int key;            // Directions and shoot of a player (see `gameInput`), or a code
+  unsigned sequence;  // Numbered by the client (see `InputLatency`)
+  long received;      // µs, on the monotonic clock
+};
+
+/* Inputs of a game, queued by the thread listening to the inputs and applied
+ *  by the thread refreshing the game at the start of its next tick, so that
+ *  inputs never race with the simulation.
+ * A single thread pushes and a single thread pops, without lock. Inputs are
+ *  refused once the queue is full, when a client sends them faster than the
+ *  ticks are simulated.
+ */
+class InputQueue {
+ private:
+  static constexpr std::size_t CAPACITY = 64;  // Power of 2
+  static constexpr std::size_t CACHE_LINE = 64;
+
+  QueuedInput _inputs[CAPACITY] = {};
+  // Each index is written by one side only, on its own cache line
+  alignas(CACHE_LINE) std::atomic<std::size_t> _head = {0};  // Next input to pop
+  alignas(CACHE_LINE) std::atomic<std::size_t> _tail = {0};  // Next input to push
+
+ public:
+  InputQueue() noexcept = default;
+  ~InputQueue() noexcept = default;
+  InputQueue(const InputQueue&) = delete;
+  InputQueue& operator=(const InputQueue&) = delete;
+
+  /* Queue an input, return false if the queue is full.
+   * Only called by the producer.
+   */
+  bool push(const QueuedInput&) noexcept;
+
+  /* Take the oldest input, return false if the queue is empty.
+   * Only called by the consumer.
+   */
+  bool pop(QueuedInput&) noexcept;
+};
@@ -4,28 +4,38 @@
 #include <vector>
 
 #include "EntityInfo.hpp"
-#include "server/DatabaseManager.hpp"
+#include "server/game/LevelSource.hpp"
 #include "server/game/PhysicsEngine.hpp"
+#include "server/game/Snapshot.hpp"
 
-
-using Level = std::map<unsigned, std::vector<EntityInfo>>;
-
+/* Spawn the entities of the levels, at the time they are given in seconds.
+ * The progress is counted in ticks of the game.
+ * The world of a level spans the screen and the boxes of all its entities,
+ *  so that entities placed beyond the screen make a level larger than the view.
+ */
 class LevelManager {
  private:
   unsigned _progress = 0;
   PhysicsEngine* _physicsEngine;
-  DatabaseManager* _dbManager;
+  const unsigned _tickRate;
+  const unsigned _ticksByLevel;
+  LevelSource* _levelSource;
 
   std::vector<LevelInfo> _levels = {};
   Level* _currentLevel = nullptr;
+  unsigned _loadedLevel = 0;  // Index of `_currentLevel` in `_levels`
 
   bool _lockedProgress = false;
 
   void _lockProgress() noexcept;
   void _unlockProgress() noexcept;
 
+  /* Read the level at `nLevel` in `_levels` and give its movement patterns to the physics engine.
+   */
+  void _readLevel(unsigned nLevel);
+
  public:
-  LevelManager(PhysicsEngine&, DatabaseManager*, const std::vector<int> levelIDs) noexcept;
+  LevelManager(PhysicsEngine&, LevelSource*, const std::vector<int> levelIDs) noexcept;
   ~LevelManager();
   LevelManager(const LevelManager&) = delete;
   LevelManager& operator=(const LevelManager&) = delete;
@@ -35,8 +45,17 @@ class LevelManager {
   void nextLevel();
   void loadLevel();
 
-  inline unsigned currentLevel() const noexcept { return _progress / FRAMES_BY_LEVEL; }
-  inline unsigned levelProgress() const noexcept { return _progress % FRAMES_BY_LEVEL; }
+  inline unsigned currentLevel() const noexcept { return _progress / _ticksByLevel; }
+  inline unsigned levelProgress() const noexcept { return _progress % _ticksByLevel; }
+  inline unsigned progress() const noexcept { return _progress; }
 
   void skipLevel() noexcept;
+
+  /* Save and restore the progress in the levels (see `Game::snapshot`).
+   * Restoring a snapshot taken in another level reads that level again, which
+   *  also resets the level patterns of the physics engine: the level must be
+   *  restored before the entities.
+   */
+  void snapshot(GameSnapshot&) const noexcept;
+  void restore(const GameSnapshot&);
 };
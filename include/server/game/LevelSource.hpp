@@ -0,0 +1,36 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "EntityInfo.hpp"
+#include "MessageData.hpp"
+#include "server/game/MovePattern.hpp"
+
+using Level = std::map<unsigned, std::vector<EntityInfo>>;
+
+/* Provide the levels played by a `LevelManager`.
+ * The server reads them from the database, benchmarks and tools may build
+ *  their own levels.
+ */
+class LevelSource {
+ public:
+  virtual ~LevelSource() noexcept = default;
+
+  /* Get the levels of the campaign, in the order they are played.
+   */
+  virtual std::vector<LevelInfo>& getCampaign(std::vector<LevelInfo>& dest) = 0;
+
+  virtual LevelInfo getLevelInfo(int id) const = 0;
+
+  /* Get the entities of a level, indexed by their spawn time (in seconds).
+   */
+  virtual Level& populateLevel(Level&, int id) = 0;
+
+  /* Get the movement patterns defined by a level, by entity type.
+   * By default, levels keep the built-in patterns of the enemies.
+   */
+  virtual LevelPatterns& populatePatterns(LevelPatterns& dest, int) {
+    return dest;
+  }
+};
@@ -2,10 +2,14 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <random>
 
 #include "constants.hpp"
+#include "server/game/Area.hpp"
 #include "server/game/Entity.hpp"
 #include "server/game/Group.hpp"
+#include "server/game/Timing.hpp"
 
 class Entity;
 class Group;
@@ -19,11 +23,18 @@ class Map {
 
  private:
   std::array<Group*, NB_GROUPS> _groups = {};
+  std::mt19937_64 _random;
+  const Timing _timing;
+  bool _dropsCapped = false;
+
+  Area _world = {};
+  Real _xCamera = 0;
+  Real _yCamera = 0;
 
   void _setCollisionGroups() noexcept;
 
  public:
-  Map() noexcept;
+  explicit Map(unsigned tickRate = FPS) noexcept;
   ~Map() noexcept;
 
   Groups& groups();
@@ -34,4 +45,47 @@ class Map {
   std::size_t nbEntities(std::size_t nGroup) const noexcept;
 
   bool isOffMap(const Entity*) const noexcept;
+
+  /* Bounds of the world of the level, entities leaving it are deleted.
+   * Setting the world brings the camera back to the screen at the origin.
+   */
+  const Area& world() const noexcept;
+  void setWorld(const Area&) noexcept;
+
+  /* Top-left corner of the view of the team: a screen of MAP_WIDTH x MAP_HEIGHT,
+   *  kept within the world. Players are kept within the view.
+   */
+  Real xCamera() const noexcept;
+  Real yCamera() const noexcept;
+  void moveCamera(Real xPos, Real yPos) noexcept;
+
+  /* Region simulated at full rate: the view extended by ACTIVE_MARGIN.
+   * Return whether it covers the whole world, no entity is dormant then.
+   */
+  bool activeRegion(Real& xMin, Real& yMin, Real& xMax, Real& yMax) const noexcept;
+
+  /* Constants of the simulation at the tick rate of the game.
+   */
+  const Timing& timing() const noexcept;
+
+  /* While drops are capped, killed enemies drop no power-up.
+   * The random draws of the drop and of its kind still happen, so that capping
+   *  drops does not shift the random numbers of the game.
+   */
+  bool dropsCapped() const noexcept;
+  void capDrops(bool) noexcept;
+
+  /* Seed the random generator of the game.
+   * Two maps with the same seed draw the same numbers, which makes games replayable.
+   */
+  void seedRandom(std::uint64_t seed) noexcept;
+
+  /* Get a random double in [min, max[ from the generator of the game.
+   */
+  double genRandomDouble(double min, double max) noexcept;
+
+  /* State of the random generator, to snapshot and restore the game.
+   */
+  const std::mt19937_64& randomState() const noexcept;
+  void setRandomState(const std::mt19937_64&) noexcept;
 };
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "server/game/Real.hpp"
+#include "server/game/Timing.hpp"
+
+/* Direction of an enemy during one frame (1/FPS s).
+ * Each component is multiplied by the enemy velocity of the game (see `Timing`).
+ */
+struct MoveStep {
+  std::int8_t x;
+  std::int8_t y;
+};
+
+/* A movement pattern: a read-only view over steps followed in a loop.
+ * Patterns are shared by every enemy of a kind, each enemy only keeps its
+ *  cursor in the pattern.
+ */
+class MovePattern {
+ private:
+  const MoveStep* _steps;
+  std::size_t _length;
+
+ public:
+  constexpr MovePattern(const MoveStep* steps, std::size_t length) noexcept: _steps(steps), _length(length) {}
+
+  template<std::size_t N>
+  constexpr MovePattern(const MoveStep (&steps)[N]) noexcept: _steps(steps), _length(N) {}
+
+  constexpr std::size_t length() const noexcept { return _length; }
+
+  /* The cursor wraps around the pattern.
+   */
+  constexpr const MoveStep& step(std::size_t cursor) const noexcept { return _steps[cursor % _length]; }
+};
+
+/* Patterns defined by a level, by entity type.
+ * They replace the built-in pattern of the enemies of this type spawned by the level.
+ */
+using LevelPatterns = std::map<unsigned, std::vector<MoveStep>>;
+
+/* Parse the steps of a pattern written as "x:y x:y ...".
+ * Throw an `Error` if the text is not a valid pattern.
+ */
+std::vector<MoveStep> parseMoveSteps(const std::string&);
+
+/* Evaluate the patterns of n enemies of games running at the same tick rate.
+ * The velocity of the i-th enemy is set from the step of `patterns[i]` at
+ *  `cursors[i]`, then its cursor is moved by one tick.
+ * Cursors count time in 1/(FPS * tickRate) s, so that a step lasts one frame
+ *  and enemies follow the same path at any tick rate.
+ */
+void evaluatePatterns(
+    const MovePattern* const* patterns, std::size_t* cursors, std::size_t n, const Timing&,
+    RealRaw* xVelocity, RealRaw* yVelocity) noexcept;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <map>
 #include <vector>
 
 #include "GameSettings.hpp"
@@ -7,51 +8,245 @@
 #include "EntityInfo.hpp"
 #include "server/game/Group.hpp"
 #include "server/game/Map.hpp"
+#include "server/game/MovePattern.hpp"
+#include "server/game/Snapshot.hpp"
+#include "server/game/WorldStore.hpp"
 
 class PhysicsEngine {
  private:
+  /* Physics boxes of a group packed as structure of arrays for the batch kernels.
+   * Index i of the batch matches index i of the gathered group.
+   * Entities removed from the group afterwards stay in the batch, marked dead,
+   *  so that a removal never moves the other entities of the batch.
+   * Buffers are kept from one tick to another to avoid reallocations.
+   * Values are stored raw (see `rawValue`) so that the kernels also work in fixed-point.
+   */
+  struct Batch {
+    std::vector<RealRaw> xPos = {};
+    std::vector<RealRaw> yPos = {};
+    std::vector<RealRaw> xSize = {};
+    std::vector<RealRaw> ySize = {};
+    std::vector<RealRaw> xVelocity = {};
+    std::vector<RealRaw> yVelocity = {};
+    std::vector<unsigned char> mask = {};
+    std::vector<unsigned char> dead = {};  // Entities removed since the batch was gathered
+
+    // Boxes covered by the entities during their last move, tested by the collision broad phase
+    std::vector<RealRaw> xSweep = {};
+    std::vector<RealRaw> ySweep = {};
+    std::vector<RealRaw> xSweepSize = {};
+    std::vector<RealRaw> ySweepSize = {};
+
+    // Position of the entity used to compute the touch mask
+    RealRaw xRef = 0;
+    RealRaw yRef = 0;
+
+    std::size_t size() const noexcept { return xPos.size(); }
+    /* First entity not dead from index `idx`, `size()` if there is none.
+     */
+    std::size_t nextLive(std::size_t idx) const noexcept;
+  };
+
+  static constexpr unsigned COLLISION_TOUCHED = 1;
+  static constexpr unsigned COLLISION_REMOVED_1 = 2;
+  static constexpr unsigned COLLISION_REMOVED_2 = 4;
+
   Map* _map;
-  Player* _players[2] = {nullptr, nullptr};
-  void _checkCollision(Group::Entities::iterator&, Group::Entities::iterator&);
+  std::vector<Player*> _players = {};
+
+  Batch _batch = {};
+  unsigned _collisionEpoch = 0;
+
+  // Movement patterns of the gathered enemies, evaluated in batch
+  std::vector<const MovePattern*> _patterns = {};
+  std::vector<std::size_t> _cursors = {};
+
+  // Patterns defined by the current level, by entity type
+  LevelPatterns _levelSteps = {};
+  std::map<unsigned, MovePattern> _levelPatterns = {};
+
+  // Parallel tick: used when the map holds at least `_parallelThreshold` entities (0 disables it)
+  std::size_t _parallelThreshold = PARALLEL_TICK_THRESHOLD;
+  bool _parallel = false;
+
+  // Touch masks of every entity of a group against the gathered batch, computed in parallel
+  std::vector<unsigned char> _touchRows = {};
+  std::size_t _rowLength = 0;
+
+  // Entities created by the last restore, by index in the snapshot
+  std::vector<Entity*> _restored = {};
+
+  /* Entity sleeping out of the active region, with the group it wakes up in.
+   */
+  struct Dormant {
+    Entity* entity;
+    std::size_t group;
+  };
+
+  // Dormant entities by cell of the world, row by row (see `DORMANT_CELL_SIZE`)
+  std::vector<std::vector<Dormant>> _dormantCells = {};
+  std::size_t _cellsByRow = 0;
+  std::size_t _nbDormant = 0;
+  int _maxDormantSize = 0;  // Largest side of an entity put to sleep, to find the cells to wake
+
+  std::size_t _cellOf(const Entity*) const noexcept;
+  void _sleep(Entity*, std::size_t nGroup);
+  void _deleteDormant() noexcept;
+  bool _isVisible(const Entity*) const noexcept;
+
+  void _updateParallelMode() noexcept;
+  bool _precomputeTouchRows(Group&, bool sameGroup) noexcept;
+
+  void _gather(Group::Entities&) noexcept;
+  void _moveEnemies(Group::Entities&) noexcept;
+  void _update(std::size_t, const Entity*) noexcept;
+
+  /* Box covered by an entity during its last move: its box at its previous
+   *  position and at its current one, and every box in between.
+   * Pairs whose swept boxes do not overlap can not touch (see `Entity::isTouching`).
+   */
+  static void _sweptBox(const Entity*, RealRaw& xPos, RealRaw& yPos, RealRaw& xSize, RealRaw& ySize) noexcept;
+  void _gatherSwept(Group::Entities&) noexcept;
+  void _updateSwept(std::size_t, const Entity*) noexcept;
+  void _computeTouchMask(const Entity*, std::size_t from) noexcept;
+
+  /* Resolve a collision between two entities.
+   * Return a combination of COLLISION_* flags.
+   */
+  unsigned _checkCollision(Entity*, Entity*);
+  void _checkCollisions(Group&, Group&);
+  void _checkPlayerDeaths(Group&);
+
+  /* Create an entity of the kind of a snapshot record, out of the map.
+   */
+  Entity* _createEntity(const EntityRecord&);
 
   bool _friendlyFire;
   unsigned _initialLives;
-  double _bonusProbability;
-  double _difficulty;
+  Real _bonusProbability;
+  Real _difficulty;
 
  public:
-  PhysicsEngine(bool friendlyFire, unsigned initialLives, double bonusProbability, double difficulty) noexcept;
+  PhysicsEngine(bool friendlyFire, unsigned initialLives, double bonusProbability, double difficulty, unsigned tickRate = FPS) noexcept;
   ~PhysicsEngine() noexcept;
   PhysicsEngine(const PhysicsEngine&) = delete;
   PhysicsEngine& operator=(const PhysicsEngine&) = delete;
 
+  /* Split the tick across cores when the map holds at least `threshold` entities.
+   * The result of a parallel tick is identical to the serial one.
+   * A threshold of 0 disables the parallel tick.
+   */
+  void setParallelThreshold(std::size_t threshold) noexcept;
+  bool isParallel() const noexcept;
+
+  /* Constants of the simulation at the tick rate of the game.
+   */
+  const Timing& timing() const noexcept;
+
+  /* Stop or restart power-up drops (see `Map::capDrops`).
+   */
+  void capDrops(bool) noexcept;
+  bool dropsCapped() const noexcept;
+
+  /* Seed the random generator of the map (see `Map::seedRandom`).
+   */
+  void seedRandom(std::uint64_t seed) noexcept;
+
+  /* Set the world of the level (see `Map::setWorld`).
+   * Dormant entities are kept, sorted again in the cells of the new world.
+   */
+  void setWorld(const Area&);
+  const Area& world() const noexcept;
+
+  /* Put to sleep the entities that left the active region, and wake up the
+   *  dormant ones that entered it. Bullets leaving it are deleted.
+   * Only the cells of the world near the active region are visited, so the
+   *  cost does not depend on the size of the level.
+   */
+  void updateDormancy();
+
+  /* Center the camera of the team on the players in the map.
+   */
+  void followPlayers() noexcept;
+
+  /* Set the movement patterns defined by the level.
+   * Enemies spawned afterwards by `newEntity` follow them instead of their built-in pattern.
+   * Must be called when the map holds no enemy spawned with the previous patterns.
+   */
+  void setLevelPatterns(const LevelPatterns&);
+
   void newEntity(const EntityInfo&);
-  void newPlayer(std::size_t nPlayer, const EntityInfo&) noexcept;
+  /* Add a player, players are indexed in the order they are added.
+   */
+  void newPlayer(const EntityInfo&);
 
   void makeMoves();
   void cleanOffScreen();
+
+  /* Moves of several games computed in a shared store (see `GameBatch`).
+   * `storeGroup` appends the entities of a group to the store, enemies must be
+   *  stored before any other entity. Once the store is computed, `loadMoves`
+   *  applies the new positions to the group stored from index `from`, and
+   *  `cleanOffScreen` deletes its entities flagged in the mask of the store.
+   */
+  void storeGroup(WorldStore&, std::size_t nGroup);
+  void loadMoves(const WorldStore&, std::size_t nGroup, std::size_t from) noexcept;
+  void cleanOffScreen(const WorldStore&, std::size_t nGroup, std::size_t from);
   void checkCollisions();
 
   /* Delete all entities excepted players.
    */
   void clearMap();
 
+  /* Take a snapshot of every entity, of the random generator and of the collision epoch.
+   * Restoring it brings the engine back to the same state: the following ticks
+   *  are identical to the ones that followed the snapshot.
+   * Level patterns are not part of the snapshot, they must be set to the
+   *  patterns of the level of the snapshot before restoring it.
+   */
+  void snapshot(WorldSnapshot&) const;
+  void restore(const WorldSnapshot&);
+
   void refreshStates();
   void makeAttacks();
   void resetStates();
 
-  void setPlayerVelocityX(int nPlayer, int direction);
-  void setPlayerVelocityY(int nPlayer, int direction);
-  void playerShoot(int);
+  void setPlayerVelocityX(unsigned nPlayer, int direction);
+  void setPlayerVelocityY(unsigned nPlayer, int direction);
+  void playerShoot(unsigned nPlayer);
 
-  void getPlayers(const Player*& player1, const Player*& player2) const noexcept;
+  const std::vector<Player*>& players() const noexcept;
 
   std::size_t getEntityNumber() const noexcept;
   std::size_t getEnemyNumber() const noexcept;
 
+  /* Get the entities in the map, then the dormant ones.
+   */
   std::vector<Entity*>& getAllEntities(std::vector<Entity*>& dest) const noexcept;
 
+  /* Get the entities overlapping the view of the camera, the ones sent to the client.
+   */
+  std::vector<Entity*>& getVisibleEntities(std::vector<Entity*>& dest) const noexcept;
+  std::size_t getVisibleNumber() const noexcept;
+  /* Call `fct` on each entity overlapping the view, in the order of `getVisibleEntities`.
+   */
+  template<typename Fct>
+  void forEachVisibleEntity(Fct fct) const;
+  Real xCamera() const noexcept;
+  Real yCamera() const noexcept;
+
   void playersNewLife() const noexcept;
   void playersToggleGhost() const noexcept;
   void playersToggleHulk() const noexcept;
 };
+
+template<typename Fct>
+void PhysicsEngine::forEachVisibleEntity(Fct fct) const {
+  for (Group* group: _map->groups()) {
+    for (const Entity* entity: group->entities()) {
+      if (_isVisible(entity)) {
+        fct(entity);
+      }
+    }
+  }
+}
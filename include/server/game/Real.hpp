@@ -0,0 +1,33 @@
+#pragma once
+
+/* Number type used by the simulation.
+ * Build with -DFIXED_POINT (make FIXED_POINT=1) to simulate with fixed-point
+ *  integer arithmetic: two runs with the same inputs then give bit-identical
+ *  states on any host. Otherwise the simulation uses doubles.
+ */
+
+#ifdef FIXED_POINT
+
+#include "server/game/Fixed.hpp"
+
+using Real = Fixed;
+using RealRaw = Fixed::Raw;
+constexpr bool REAL_IS_FIXED = true;
+
+constexpr RealRaw rawValue(Real value) noexcept { return value.raw(); }
+constexpr Real fromRaw(RealRaw raw) noexcept { return Fixed::fromRaw(raw); }
+constexpr double toDouble(Real value) noexcept { return value.toDouble(); }
+
+#else
+
+#include <cmath>
+
+using Real = double;
+using RealRaw = double;
+constexpr bool REAL_IS_FIXED = false;
+
+constexpr RealRaw rawValue(Real value) noexcept { return value; }
+constexpr Real fromRaw(RealRaw raw) noexcept { return raw; }
+constexpr double toDouble(Real value) noexcept { return value; }
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "GameSettings.hpp"
+
+/* Replay log of a game: everything needed to simulate it again.
+ * File layout (native byte order):
+ *  - header: magic, version, flags, game settings, level IDs, RNG seed
+ *  - one record per tick: a varint with the number of inputs applied
+ *     before the tick, each input as a zigzag varint, then the 64 bits
+ *     state hash at the end of the tick (see `Game::stateHash`)
+ * An idle tick takes 9 bytes.
+ */
+struct ReplayInfo {
+  GameSettings settings = {};
+  std::vector<int> levelIDs = {};
+  std::uint64_t seed = 0;
+  bool fixedPoint = false;  // The game was simulated with FIXED_POINT
+};
+
+/* Write the replay of a game while it is played.
+ * Inputs may be recorded from another thread than the ticks.
+ */
+class ReplayRecorder {
+ private:
+  std::ofstream _file;
+  std::vector<int> _inputs = {};
+  std::mutex _mutex = {};
+  unsigned _ticks = 0;
+  unsigned _tickRate;
+
+ public:
+  ReplayRecorder(const std::string& path, const ReplayInfo&);
+  ~ReplayRecorder() noexcept = default;
+  ReplayRecorder(const ReplayRecorder&) = delete;
+  ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+  /* Record an input applied before the next tick.
+   */
+  void input(int key) noexcept;
+
+  /* Close the record of the current tick.
+   */
+  void endTick(std::uint64_t stateHash) noexcept;
+};
+
+/* Read a replay written by a `ReplayRecorder`.
+ */
+class ReplayReader {
+ private:
+  std::ifstream _file;
+  ReplayInfo _info = {};
+
+ public:
+  ReplayReader(const std::string& path);
+  ~ReplayReader() noexcept = default;
+
+  const ReplayInfo& info() const noexcept;
+
+  /* Read the record of the next tick.
+   * Return false once the end of the replay is reached.
+   */
+  bool nextTick(std::vector<int>& inputs, std::uint64_t& stateHash);
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "server/game/Area.hpp"
+#include "server/game/Real.hpp"
+
+/* Concrete class of a snapshotted entity.
+ */
+enum EntityKind: std::uint8_t {
+  KIND_POWERUP,
+  KIND_OBSTACLE,
+  KIND_BULLET,
+  KIND_PLAYER,
+  KIND_ENEMY_1,
+  KIND_ENEMY_2,
+  KIND_ENEMY_3,
+  KIND_BOSS_1,
+  KIND_BOSS_2,
+  KIND_BOSS_3,
+  KIND_HENCHMAN_1,
+  KIND_HENCHMAN_2,
+  KIND_HENCHMAN_3,
+};
+
+// Reference to no entity in a snapshot
+constexpr std::int32_t NO_ENTITY = -1;
+
+/* State of one entity, as a plain record.
+ * Entities refer to each other by their index in the snapshot instead of by
+ *  pointer, so that a snapshot can be copied as a flat block of memory.
+ * Fields that do not apply to the kind of the entity are left to zero.
+ */
+struct EntityRecord {
+  EntityKind kind = KIND_POWERUP;
+  std::int8_t group = -1;  // Group of the map holding the entity, -1 if out of the map
+  bool dormant = false;    // Sleeping out of the active region, wakes up in `group`
+  unsigned ID = 0;
+
+  RealRaw xPos = 0;
+  RealRaw yPos = 0;
+  int xSize = 0;
+  int ySize = 0;
+  RealRaw xVelocity = 0;
+  RealRaw yVelocity = 0;
+
+  unsigned state = 0;
+  unsigned stateStep = 0;
+  unsigned collisionEpoch = 0;
+
+  // PhysicalEntity
+  RealRaw hp = 0;
+  RealRaw damage = 0;
+
+  // Character
+  RealRaw fireDamage = 0;
+  unsigned fireDelay = 0;
+  unsigned remainingDelay = 0;
+
+  // Enemy
+  std::uint64_t counter = 0;
+  bool levelPattern = false;  // Follows the pattern of the level for its type
+
+  // Boss
+  bool gatlingMode = false;
+  unsigned remainingDelay2 = 0;
+
+  // Player
+  RealRaw spawnX = 0;
+  RealRaw spawnY = 0;
+  unsigned score = 0;
+  unsigned invincibilityTime = 0;
+  bool ghost = false;
+  bool hulk = false;
+
+  // PowerUp
+  RealRaw fireDamageFactor = 0;
+  RealRaw fireRateFactor = 0;
+
+  // Shooter of a bullet, power-up picked by a player
+  std::int32_t reference = NO_ENTITY;
+};
+
+/* State of a `PhysicsEngine`.
+ * Entities of the map are recorded group by group, in the order of their
+ *  group, followed by the dormant entities cell by cell, then by the entities
+ *  out of the map (dead players, picked power-ups).
+ * Buffers are kept when a snapshot is taken again, so that snapshotting every
+ *  tick does not allocate once the buffers are large enough.
+ */
+struct WorldSnapshot {
+  std::vector<EntityRecord> entities = {};
+  std::vector<std::int32_t> players = {};  // Index of each player in `entities`
+  std::mt19937_64 random = {};
+  unsigned collisionEpoch = 0;
+  bool dropsCapped = false;
+  Area world = {};
+  RealRaw xCamera = 0;
+  RealRaw yCamera = 0;
+};
+
+/* State of a `Game`: its world and its progress in the levels.
+ */
+struct GameSnapshot {
+  WorldSnapshot world = {};
+  unsigned progress = 0;
+  bool lockedProgress = false;
+  unsigned loadedLevel = 0;  // Level whose entities are spawned
+};
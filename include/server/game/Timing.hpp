@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+#include "constants.hpp"
+#include "server/game/Real.hpp"
+
+/* Constants of the simulation converted for the tick rate of a game.
+ * Speeds and delays are defined in seconds (see constants.hpp), so that a game
+ *  lasts as long and plays the same way whatever its tick rate.
+ */
+struct Timing {
+  unsigned tickRate;      // ticks/s
+  unsigned ticksByLevel;  // ticks
+  unsigned stateDuration;
+  unsigned respawnDuration;
+
+  // %map/tick
+  Real playerVelocityX;
+  Real playerVelocityY;
+  Real enemyVelocityX;
+  Real enemyVelocityY;
+  Real bulletVelocity;
+  Real obstacleVelocity;
+
+  // ticks/shoot
+  unsigned playerFireDelay;
+  unsigned enemyFireDelay;
+  unsigned bossFireDelay;
+  unsigned henchmanFireDelay;
+
+  /* The tick rate is clamped to [MIN_TICK_RATE, MAX_TICK_RATE].
+   */
+  explicit Timing(unsigned tickRate = FPS) noexcept;
+
+  static unsigned clampTickRate(unsigned tickRate) noexcept;
+
+  /* Convert a number of ticks to frames, the unit of the progress and of the
+   *  state steps sent to clients.
+   */
+  unsigned toFrames(unsigned ticks) const noexcept {
+    return unsigned(std::uint64_t(ticks) * FPS / tickRate);
+  }
+};
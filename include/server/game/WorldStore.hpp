@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "server/game/MovePattern.hpp"
+#include "server/game/Real.hpp"
+
+class Entity;
+
+/* Physics boxes of the entities of several games, packed as structure of arrays.
+ * The entities of a group of a game are contiguous. The enemies of every game
+ *  are stored first, so that their patterns are evaluated in one pass.
+ * Buffers are kept from one tick to another to avoid reallocations.
+ */
+struct WorldStore {
+  std::vector<RealRaw> xPos = {};
+  std::vector<RealRaw> yPos = {};
+  std::vector<RealRaw> xSize = {};
+  std::vector<RealRaw> ySize = {};
+  std::vector<RealRaw> xVelocity = {};
+  std::vector<RealRaw> yVelocity = {};
+  std::vector<unsigned char> mask = {};
+
+  // Movement patterns of the stored enemies
+  std::vector<const MovePattern*> patterns = {};
+  std::vector<std::size_t> cursors = {};
+
+  std::size_t size() const noexcept { return xPos.size(); }
+
+  /* Remove every entity, keeping the buffers.
+   */
+  void clear() noexcept;
+};
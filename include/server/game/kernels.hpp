@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Batch kernels working on entities stored as structure of arrays.
+ * Each kernel has a scalar, an SSE2 and an AVX implementation, the best one
+ *  supported by the host is selected at runtime on first use.
+ * All variants produce bit-identical results: they only perform the same
+ *  additions and comparisons than the scalar code, lane by lane.
+ * Every kernel also has an overload working on raw fixed-point values (see
+ *  `Fixed`) used when the simulation is built with FIXED_POINT.
+ */
+
+enum KernelISA {
+  KERNEL_SCALAR = 0,
+  KERNEL_SSE2 = 1,
+  KERNEL_AVX = 2,
+};
+
+/* Get the instruction set currently used by the kernels.
+ */
+KernelISA kernelISA() noexcept;
+
+/* Get the best instruction set supported by the host.
+ */
+KernelISA bestKernelISA() noexcept;
+
+/* Force the instruction set used by the kernels.
+ * The requested set is clamped to the best one supported by the host.
+ */
+void setKernelISA(KernelISA) noexcept;
+
+const char* kernelISAName(KernelISA) noexcept;
+
+/* Integrate positions: pos += velocity for the n entities.
+ */
+void integratePositions(double* xPos, double* yPos, const double* xVelocity, const double* yVelocity, std::size_t n) noexcept;
+
+/* Flag entities lying entirely outside of [xMin, xMax]x[yMin, yMax].
+ * mask[i] is set to 1 if the i-th entity is off the bounds, 0 otherwise.
+ */
+void offBoundsMask(
+    const double* xPos, const double* yPos, const double* xSize, const double* ySize, std::size_t n,
+    double xMin, double yMin, double xMax, double yMax,
+    unsigned char* mask) noexcept;
+
+/* Test one AABB against a batch of AABBs.
+ * mask[i] is set to 1 if the boxes overlap (same test as `Entity::isTouching`), 0 otherwise.
+ */
+void touchMask(
+    double xPos, double yPos, double xSize, double ySize,
+    const double* xPosBatch, const double* yPosBatch, const double* xSizeBatch, const double* ySizeBatch, std::size_t n,
+    unsigned char* mask) noexcept;
+
+void integratePositions(std::int32_t* xPos, std::int32_t* yPos, const std::int32_t* xVelocity, const std::int32_t* yVelocity, std::size_t n) noexcept;
+
+void offBoundsMask(
+    const std::int32_t* xPos, const std::int32_t* yPos, const std::int32_t* xSize, const std::int32_t* ySize, std::size_t n,
+    std::int32_t xMin, std::int32_t yMin, std::int32_t xMax, std::int32_t yMax,
+    unsigned char* mask) noexcept;
+
+void touchMask(
+    std::int32_t xPos, std::int32_t yPos, std::int32_t xSize, std::int32_t ySize,
+    const std::int32_t* xPosBatch, const std::int32_t* yPosBatch, const std::int32_t* xSizeBatch, const std::int32_t* ySizeBatch, std::size_t n,
+    unsigned char* mask) noexcept;
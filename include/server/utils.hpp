@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -7,6 +8,10 @@
  */
 std::string genRandomStr(unsigned int length) noexcept;
 
+/* Generate a random seed for a game.
+ */
+std::uint64_t genRandomSeed() noexcept;
+
 /* Get key from file.
  */
 std::string getKey(const std::string& path);
@@ -28,6 +28,11 @@ std::string getStrTime(const std::string& timeFormat) noexcept;
  */
 long int getTimestamp() noexcept;
 
+/* Get the time of a monotonic clock (µs).
+ * Unlike timestamps, it never goes back, and it is the same for every process of the host.
+ */
+long int getMonotonicTimestamp() noexcept;
+
 /* Get the current timestamp in a string.
  */
 std::string getStrTimestamp() noexcept;
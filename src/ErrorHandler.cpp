@@ -3,13 +3,11 @@
 #include <sys/stat.h>
 
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
 
 #include "utils.hpp"
 
 const std::string TIME_FILE_FORMAT = "%Y%m%d%H%M%S";
-const std::string TIME_LOG_FORMAT = "%Y-%m-%d %H:%M:%S";
 
 /* Build the full log path from the log directory
  */
@@ -19,6 +17,7 @@ inline std::string getLogPath(const std::string& logDir) noexcept {
 
 ErrorHandler::ErrorHandler(const std::string& logDir): _logPath(getLogPath(logDir)) {
   _createLogDirectory(logDir);
+  _logger = std::make_unique<Logger>((_logToFile) ? _logPath : "");
 }
 
 inline void ErrorHandler::_createLogDirectory(const std::string& logDir) {
@@ -30,26 +29,23 @@ inline void ErrorHandler::_createLogDirectory(const std::string& logDir) {
   };
 }
 
-inline void ErrorHandler::_logError(const std::exception& error) const noexcept {
-  // Append the error message at the end of the log file
-  std::ofstream logFile(_logPath, std::ios::app);
-  logFile << "[" << getStrTime(TIME_LOG_FORMAT) << "] " << error.what() << std::endl;
-  logFile.close();
-}
-
-inline void ErrorHandler::_printError(const std::exception& error) const noexcept {
-  std::cerr << error.what() << std::endl;
-}
-
-void ErrorHandler::handleError(const std::exception& error) const noexcept {
-  if (_logToFile) {
-    _logError(error);
-  } else {
-    _printError(error);
-  }
+void ErrorHandler::handleError(const std::exception& error, const LogFields& fields) const noexcept {
+  logMessage(error.what(), fields);
 
   // A fatal error will cause the program to stop.
   if (dynamic_cast<const FatalError*>(&error)) {
+    if (_logger) {
+      _logger->flush();
+    }
     std::exit(1);
   }
 }
+
+void ErrorHandler::logMessage(const std::string& message, const LogFields& fields) const noexcept {
+  if (_logger) {
+    _logger->log(message, fields);
+  } else {
+    // Before the logger starts
+    std::cerr << message << std::endl;
+  }
+}
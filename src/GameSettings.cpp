@@ -3,12 +3,12 @@
 #include <cmath>
 
 GameSettings::GameSettings(
-    bool _secondPlayer,
+    unsigned _nbPlayers,
     unsigned int _initialLives,
     double _difficulty,
     double _bonusProbability,
     bool _friendlyFire) noexcept
-    : secondPlayer(_secondPlayer),
+    : nbPlayers((_nbPlayers == 0) ? 1 : (_nbPlayers <= MAX_PLAYERS) ? _nbPlayers : MAX_PLAYERS),
       initialLives(_initialLives),
       difficulty((_difficulty <= 1.0) ? _difficulty : 1),
       bonusProbability((_bonusProbability <= 1.0) ? _bonusProbability : 1),
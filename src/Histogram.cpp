@@ -0,0 +1,87 @@
+#include "Histogram.hpp"
+
+#include <algorithm>
+
+std::size_t Histogram::_bucketOf(unsigned long value) noexcept {
+  value = std::min(value, (1UL << MAX_BITS) - 1);
+  if (value < SUB_BUCKETS) {
+    return std::size_t(value);
+  }
+
+  unsigned exponent = unsigned(63 - __builtin_clzl(value));  // >= SUB_BITS
+  unsigned shift = exponent - SUB_BITS;
+  return std::size_t(shift + 1) * SUB_BUCKETS + std::size_t((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+unsigned long Histogram::_valueOf(std::size_t bucket) noexcept {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+
+  unsigned shift = unsigned(bucket / SUB_BUCKETS) - 1;
+  unsigned long sub = bucket % SUB_BUCKETS;
+  return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void Histogram::record(long value) noexcept {
+  unsigned long v = (value > 0) ? (unsigned long)value : 0;
+  _counts[_bucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+  _total.fetch_add(1, std::memory_order_relaxed);
+  _sum.fetch_add(v, std::memory_order_relaxed);
+
+  unsigned long max = _max.load(std::memory_order_relaxed);
+  while (v > max && !_max.compare_exchange_weak(max, v, std::memory_order_relaxed)) {}
+}
+
+void Histogram::add(const Histogram& other) noexcept {
+  for (std::size_t bucket = 0; bucket != NB_BUCKETS; ++bucket) {
+    _counts[bucket].fetch_add(other._counts[bucket].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  _total.fetch_add(other.count(), std::memory_order_relaxed);
+  _sum.fetch_add(other._sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+  unsigned long v = other.max();
+  unsigned long max = _max.load(std::memory_order_relaxed);
+  while (v > max && !_max.compare_exchange_weak(max, v, std::memory_order_relaxed)) {}
+}
+
+void Histogram::reset() noexcept {
+  for (std::atomic<unsigned long>& count: _counts) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  _total.store(0, std::memory_order_relaxed);
+  _sum.store(0, std::memory_order_relaxed);
+  _max.store(0, std::memory_order_relaxed);
+}
+
+unsigned long Histogram::count() const noexcept {
+  return _total.load(std::memory_order_relaxed);
+}
+
+double Histogram::mean() const noexcept {
+  unsigned long total = count();
+  return (total) ? double(_sum.load(std::memory_order_relaxed)) / double(total) : 0;
+}
+
+unsigned long Histogram::max() const noexcept {
+  return _max.load(std::memory_order_relaxed);
+}
+
+unsigned long Histogram::percentile(double percentile) const noexcept {
+  // Buckets are summed rather than using `_total`, which may be ahead of them while recording
+  unsigned long total = 0;
+  for (const std::atomic<unsigned long>& count: _counts) {
+    total += count.load(std::memory_order_relaxed);
+  }
+  if (total == 0) return 0;
+
+  double rank = std::max(1.0, std::min(percentile, 100.0) / 100 * double(total));
+  unsigned long seen = 0;
+  for (std::size_t bucket = 0; bucket != NB_BUCKETS; ++bucket) {
+    seen += _counts[bucket].load(std::memory_order_relaxed);
+    if (double(seen) >= rank) {
+      return std::min(_valueOf(bucket), max());
+    }
+  }
+  return max();
+}
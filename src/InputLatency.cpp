@@ -0,0 +1,57 @@
+#include "InputLatency.hpp"
+
+#include "utils.hpp"
+
+const char* latencyStageName(LatencyStage stage) noexcept {
+  switch (stage) {
+    case LATENCY_SEND:
+      return "send";
+    case LATENCY_QUEUE:
+      return "queue";
+    case LATENCY_TICK:
+      return "tick";
+    case LATENCY_DELIVERY:
+      return "delivery";
+    case LATENCY_TOTAL:
+      return "total";
+    case NB_LATENCY_STAGES:
+      break;
+  }
+  return "unknown";
+}
+
+unsigned InputLatency::send() noexcept {
+  ++_lastSent;
+  _sentTimes[_lastSent % WINDOW] = getMonotonicTimestamp();
+  return _lastSent;
+}
+
+void InputLatency::show(const RefreshFrame& refresh) noexcept {
+  unsigned sequence = refresh.inputSequence;
+  // Inputs of a previous game, or already shown
+  if (sequence <= _lastShown || sequence > _lastSent) return;
+
+  long now = getMonotonicTimestamp();
+  unsigned first = (sequence - _lastShown > WINDOW) ? sequence - WINDOW + 1 : _lastShown + 1;
+  for (unsigned s = first; s <= sequence; ++s) {
+    _stages[LATENCY_TOTAL].record(now - _sentTimes[s % WINDOW]);
+  }
+
+  _stages[LATENCY_SEND].record(refresh.inputReceived - _sentTimes[sequence % WINDOW]);
+  _stages[LATENCY_QUEUE].record(refresh.inputApplied - refresh.inputReceived);
+  _stages[LATENCY_TICK].record(refresh.sent - refresh.inputApplied);
+  _stages[LATENCY_DELIVERY].record(now - refresh.sent);
+  _lastShown = sequence;
+}
+
+void InputLatency::reset() noexcept {
+  _lastSent = 0;
+  _lastShown = 0;
+  for (Histogram& histogram: _stages) {
+    histogram.reset();
+  }
+}
+
+const Histogram& InputLatency::stage(LatencyStage stage) const noexcept {
+  return _stages[stage];
+}
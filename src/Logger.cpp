@@ -0,0 +1,202 @@
+#include "Logger.hpp"
+
+#include <new>
+
+Logger::Logger(const std::string& path): _path(path) {
+  _thread = std::thread(&Logger::_run, this);
+}
+
+Logger::~Logger() noexcept {
+  _stopping = true;
+  _wakeUp.notify_one();
+  _thread.join();
+
+  if (_file && _file != stderr) {
+    std::fclose(_file);
+  }
+}
+
+void Logger::_push(Record* record) noexcept {
+  record->next.store(nullptr, std::memory_order_relaxed);
+  Record* previous = _head.exchange(record, std::memory_order_acq_rel);
+  previous->next.store(record, std::memory_order_release);
+}
+
+Logger::Record* Logger::_pop() noexcept {
+  Record* tail = _tail;
+  Record* next = tail->next.load(std::memory_order_acquire);
+  if (tail == &_stub) {
+    if (!next) return nullptr;
+    _tail = next;
+    tail = next;
+    next = next->next.load(std::memory_order_acquire);
+  }
+  if (next) {
+    _tail = next;
+    return tail;
+  }
+
+  // `tail` is the last record pushed, unless a producer is between its exchange and its link
+  if (tail != _head.load(std::memory_order_acquire)) return nullptr;
+  _push(&_stub);
+  next = tail->next.load(std::memory_order_acquire);
+  if (next) {
+    _tail = next;
+    return tail;
+  }
+  return nullptr;
+}
+
+void Logger::log(const std::string& message, const LogFields& fields) noexcept {
+  if (_pending.fetch_add(1, std::memory_order_relaxed) >= MAX_PENDING) {
+    _pending.fetch_sub(1, std::memory_order_relaxed);
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  Record* record = new (std::nothrow) Record();
+  if (!record) {
+    _pending.fetch_sub(1, std::memory_order_relaxed);
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  try {
+    record->time = std::chrono::system_clock::now();
+    record->message = message;
+    record->fields = fields;
+  } catch (std::exception&) {
+    // Logged without its text rather than lost
+  }
+  _push(record);
+
+  if (_sleeping.load(std::memory_order_acquire)) {
+    _wakeUp.notify_one();
+  }
+}
+
+void Logger::flush() noexcept {
+  std::unique_lock<std::mutex> lock(_mutex);
+  unsigned long request = ++_flushRequests;
+  _wakeUp.notify_one();
+  _flushed.wait(lock, [this, request]() { return _flushes >= request; });
+}
+
+void Logger::_run() noexcept {
+  while (true) {
+    bool stopping = _stopping.load();
+    unsigned long flushRequests;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      flushRequests = _flushRequests;
+    }
+
+    bool written = false;
+    while (Record* record = _pop()) {
+      _write(*record);
+      delete record;
+      _pending.fetch_sub(1, std::memory_order_relaxed);
+      written = true;
+    }
+    if (unsigned long dropped = _dropped.exchange(0, std::memory_order_relaxed)) {
+      _writeLine(std::chrono::system_clock::now(), std::to_string(dropped) + " messages dropped, the log could not keep up");
+      written = true;
+    }
+    if (stopping) {
+      _writeRepeats(std::chrono::system_clock::now());
+    }
+    if (_file && (written || stopping)) {
+      std::fflush(_file);
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (flushRequests != _flushes) {
+      _flushes = flushRequests;
+      _flushed.notify_all();
+    }
+    if (stopping) return;
+
+    // Producers only notify a sleeping thread, waiting is bounded in case a notification comes in between
+    _sleeping.store(true, std::memory_order_release);
+    if (_head.load(std::memory_order_acquire) == _tail && _flushRequests == _flushes && !_stopping) {
+      _wakeUp.wait_for(lock, IDLE_WAIT);
+    }
+    _sleeping.store(false, std::memory_order_relaxed);
+  }
+}
+
+void Logger::_open() noexcept {
+  _file = (_path.empty()) ? nullptr : std::fopen(_path.c_str(), "a");
+  if (!_file) {
+    _file = stderr;
+    _fileSize = 0;
+    return;
+  }
+  std::fseek(_file, 0, SEEK_END);
+  _fileSize = std::ftell(_file);
+}
+
+void Logger::_rotate() noexcept {
+  std::fclose(_file);
+  for (unsigned n = MAX_ROTATED_FILES; n > 1; --n) {
+    std::rename((_path + "." + std::to_string(n - 1)).c_str(), (_path + "." + std::to_string(n)).c_str());
+  }
+  std::rename(_path.c_str(), (_path + ".1").c_str());
+  _open();
+}
+
+void Logger::_writeLine(std::chrono::system_clock::time_point time, const std::string& line) noexcept {
+  // The text of the time only changes once per second
+  // The file is only created once there is something to write in it
+  if (!_file) {
+    _open();
+  }
+
+  std::time_t second = std::chrono::system_clock::to_time_t(time);
+  if (second != _lastSecond) {
+    std::tm tm;
+    localtime_r(&second, &tm);
+    std::strftime(_timeText, sizeof(_timeText), "%Y-%m-%d %H:%M:%S", &tm);
+    _lastSecond = second;
+  }
+
+  int size = std::fprintf(_file, "[%s] %s\n", _timeText, line.c_str());
+  if (_file != stderr && size > 0) {
+    _fileSize += size;
+    if (_fileSize > MAX_FILE_SIZE) {
+      _rotate();
+    }
+  }
+}
+
+void Logger::_writeRepeats(std::chrono::system_clock::time_point time) noexcept {
+  if (_repeats) {
+    _writeLine(time, "Previous message repeated " + std::to_string(_repeats) + " times");
+    _repeats = 0;
+  }
+}
+
+void Logger::_write(const Record& record) noexcept {
+  try {
+    std::string line = record.message;
+    if (!record.fields.channel.empty()) {
+      line += " channel=" + record.fields.channel;
+    }
+    if (!record.fields.username.empty()) {
+      line += " user=" + record.fields.username;
+    }
+    if (!record.fields.activityID.empty()) {
+      line += " activity=" + record.fields.activityID;
+    }
+
+    if (line == _lastMessage && record.time - _lastWritten < REPEAT_WINDOW) {
+      ++_repeats;
+      return;
+    }
+    _writeRepeats(record.time);
+    _writeLine(record.time, line);
+    _lastMessage = std::move(line);
+    _lastWritten = record.time;
+  } catch (std::exception&) {
+    _writeLine(record.time, record.message);
+  }
+}
@@ -5,12 +5,14 @@
 Token::Token(
     const std::string& username,
     const std::string& gameID,
+    const std::string& channel,
     const std::string& timestamp,
     const std::string& sig,
     const std::string& guestUsername) noexcept {
   strcpy(_username, username.c_str());
   strcpy(_guestUsername, guestUsername.c_str());
   strcpy(_activityID, gameID.c_str());
+  strcpy(_channel, channel.c_str());
   strcpy(_timestamp, timestamp.c_str());
   strcpy(_sig, sig.c_str());
 }
@@ -23,6 +25,14 @@ std::string Token::getActivityID() const noexcept {
   return _activityID;
 }
 
+std::string Token::getChannel() const noexcept {
+  return _channel;
+}
+
+std::string Token::getGameChannel() const noexcept {
+  return _channel + std::string(GAME_CHANNEL_SUFFIX);
+}
+
 std::string Token::getTimestamp() const noexcept {
   return _timestamp;
 }
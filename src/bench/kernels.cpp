@@ -0,0 +1,127 @@
+/* Microbenchmark of the physics batch kernels.
+ * Every kernel is run with every instruction set supported by the host on
+ *  batches of several sizes. Results of each variant are checked against the
+ *  scalar implementation.
+ * Kernels suffixed by /q16 work on raw fixed-point values.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "constants.hpp"
+#include "server/game/Fixed.hpp"
+#include "server/game/kernels.hpp"
+
+/* Random boxes, stored as doubles or as raw Q16.16 fixed-point values.
+ */
+template<typename T>
+struct Boxes {
+  std::vector<T> xPos, yPos, xSize, ySize, xVelocity, yVelocity;
+
+  explicit Boxes(std::size_t n)
+      : xPos(n), yPos(n), xSize(n), ySize(n), xVelocity(n), yVelocity(n) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<> pos(-10, MAP_WIDTH + 10);
+    std::uniform_int_distribution<> size(1, 8);
+    std::uniform_real_distribution<> velocity(-2, 2);
+    for (std::size_t i = 0; i != n; ++i) {
+      xPos[i] = value(pos(gen));
+      yPos[i] = value(pos(gen) * MAP_HEIGHT / MAP_WIDTH);
+      xSize[i] = value(size(gen));
+      ySize[i] = value(size(gen));
+      xVelocity[i] = value(velocity(gen));
+      yVelocity[i] = value(velocity(gen));
+    }
+  }
+
+  static T value(double x) noexcept {
+    return std::is_same<T, double>::value ? T(x) : T(Fixed(x).raw());
+  }
+};
+
+/* Run `fct` until at least 50ms have elapsed and return the mean time of a call in ns.
+ */
+template<typename Fct>
+static double timeIt(Fct fct) {
+  using Clock = std::chrono::steady_clock;
+  std::size_t iterations = 0;
+  Clock::time_point start = Clock::now();
+  Clock::duration elapsed;
+  do {
+    for (int r = 0; r != 64; ++r) fct();
+    iterations += 64;
+    elapsed = Clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(50));
+  return double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / double(iterations);
+}
+
+static void report(const char* kernel, KernelISA isa, std::size_t n, double ns, bool valid) {
+  printf("%-14s %-7s %6zu %12.1f %10.2f %s\n", kernel, kernelISAName(isa), n, ns, double(n) / ns * 1000, valid ? "ok" : "MISMATCH");
+}
+
+template<typename T>
+static bool benchmark(const char* suffix, std::size_t n) {
+  using B = Boxes<T>;
+  B boxes(n);
+  std::vector<unsigned char> reference(n), mask(n);
+  const T xMax = B::value(MAP_WIDTH), yMax = B::value(MAP_HEIGHT);
+  const T xRef = B::value(MAP_WIDTH / 2), yRef = B::value(MAP_HEIGHT / 2), size = B::value(4);
+  char name[32];
+
+  bool allValid = true;
+  for (int isa = KERNEL_SCALAR; isa <= bestKernelISA(); ++isa) {
+    // integratePositions
+    std::vector<T> xRefs = boxes.xPos, yRefs = boxes.yPos, x = boxes.xPos, y = boxes.yPos;
+    setKernelISA(KERNEL_SCALAR);
+    integratePositions(xRefs.data(), yRefs.data(), boxes.xVelocity.data(), boxes.yVelocity.data(), n);
+    setKernelISA(KernelISA(isa));
+    integratePositions(x.data(), y.data(), boxes.xVelocity.data(), boxes.yVelocity.data(), n);
+    bool valid = x == xRefs && y == yRefs;
+    double ns = timeIt([&]() { integratePositions(x.data(), y.data(), boxes.xVelocity.data(), boxes.yVelocity.data(), n); });
+    snprintf(name, sizeof(name), "integrate%s", suffix);
+    report(name, KernelISA(isa), n, ns, valid);
+    allValid &= valid;
+
+    // offBoundsMask
+    setKernelISA(KERNEL_SCALAR);
+    offBoundsMask(boxes.xPos.data(), boxes.yPos.data(), boxes.xSize.data(), boxes.ySize.data(), n, T(0), T(0), xMax, yMax, reference.data());
+    setKernelISA(KernelISA(isa));
+    offBoundsMask(boxes.xPos.data(), boxes.yPos.data(), boxes.xSize.data(), boxes.ySize.data(), n, T(0), T(0), xMax, yMax, mask.data());
+    valid = mask == reference;
+    ns = timeIt([&]() { offBoundsMask(boxes.xPos.data(), boxes.yPos.data(), boxes.xSize.data(), boxes.ySize.data(), n, T(0), T(0), xMax, yMax, mask.data()); });
+    snprintf(name, sizeof(name), "offBounds%s", suffix);
+    report(name, KernelISA(isa), n, ns, valid);
+    allValid &= valid;
+
+    // touchMask
+    setKernelISA(KERNEL_SCALAR);
+    touchMask(xRef, yRef, size, size, boxes.xPos.data(), boxes.yPos.data(), boxes.xSize.data(), boxes.ySize.data(), n, reference.data());
+    setKernelISA(KernelISA(isa));
+    touchMask(xRef, yRef, size, size, boxes.xPos.data(), boxes.yPos.data(), boxes.xSize.data(), boxes.ySize.data(), n, mask.data());
+    valid = mask == reference;
+    ns = timeIt([&]() { touchMask(xRef, yRef, size, size, boxes.xPos.data(), boxes.yPos.data(), boxes.xSize.data(), boxes.ySize.data(), n, mask.data()); });
+    snprintf(name, sizeof(name), "touch%s", suffix);
+    report(name, KernelISA(isa), n, ns, valid);
+    allValid &= valid;
+  }
+  return allValid;
+}
+
+int main() {
+  const std::size_t sizes[] = {16, 256, 4096};
+
+  printf("best instruction set: %s\n", kernelISAName(bestKernelISA()));
+  printf("%-14s %-7s %6s %12s %10s\n", "kernel", "isa", "n", "ns/call", "Melem/s");
+
+  bool allValid = true;
+  for (std::size_t n: sizes) {
+    allValid &= benchmark<double>("", n);
+    allValid &= benchmark<std::int32_t>("/q16", n);
+  }
+
+  return allValid ? 0 : 1;
+}
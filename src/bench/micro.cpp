@@ -0,0 +1,408 @@
+/* Microbenchmarks of the hot paths of the server.
+ * Usage: bench-micro [--filter TEXT] [--time SECONDS]
+ *  --filter: only run the benchmarks whose name holds TEXT
+ *  --time:   time spent measuring each benchmark (default: 0.2)
+ * Benchmarks:
+ *  - ipc_roundtrip:  a message written on a channel and echoed back by another process
+ *  - ipc_throughput: messages written back to back, read by another process
+ *  - channel_lookup: handle of an open channel looked up by name, among N open channels
+ *  - token_sign, token_check: signature of a token, and its check on each request
+ *  - db_*:           queries of the database run on each login, game or refresh of a menu,
+ *                    on a copy of static/ltype.db
+ *  - collisions:     `PhysicsEngine::checkCollisions` with N enemies and obstacles
+ *  - frame_build:    building the refresh of a game holding N entities (see `FrameArena`)
+ * One line is printed per benchmark and parameter, as tab separated columns
+ *  under a header, so that runs can be diffed or joined on the first two
+ *  columns. Each operation is timed on its own: the columns give the count,
+ *  mean, median, 99th percentile of an operation (ns), and operations per second.
+ *  The throughput is only measured as a mean, its percentiles are 0.
+ * Must be run from the root of the repository, where the database and the keys are.
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "EntityInfo.hpp"
+#include "GameSettings.hpp"
+#include "Histogram.hpp"
+#include "Token.hpp"
+#include "assetsID.hpp"
+#include "constants.hpp"
+#include "server/DatabaseManager.hpp"
+#include "server/MessageExchanger.hpp"
+#include "server/game/Game.hpp"
+#include "server/game/LevelSource.hpp"
+#include "server/game/PhysicsEngine.hpp"
+#include "server/utils.hpp"
+#include "utils.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static const std::string DB_PATH = "static/ltype.db";
+
+struct Options {
+  std::string filter = "";
+  double seconds = 0.2;
+};
+
+static bool selected(const Options& options, const char* name) {
+  return std::strstr(name, options.filter.c_str()) != nullptr;
+}
+
+static void report(const char* name, const std::string& param, unsigned long count, double ns, unsigned long p50, unsigned long p99) {
+  printf("%s\t%s\t%lu\t%.1f\t%lu\t%lu\t%.0f\n", name, param.c_str(), count, ns, p50, p99, (ns > 0) ? 1e9 / ns : 0);
+  fflush(stdout);
+}
+
+/* Run `fct` a few times to warm up, then for `options.seconds` (and at least
+ *  16 times), timing each call, and report it.
+ */
+template<typename Fct>
+static void measure(const Options& options, const char* name, const std::string& param, Fct fct) {
+  for (int r = 0; r != 4; ++r) fct();
+
+  Histogram histogram;
+  long budget = long(options.seconds * 1e9);
+  long elapsed = 0;
+  while (elapsed < budget || histogram.count() < 16) {
+    Clock::time_point start = Clock::now();
+    fct();
+    long ns = long(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    histogram.record(ns);
+    elapsed += ns;
+  }
+  report(name, param, histogram.count(), histogram.mean(), histogram.percentile(50), histogram.percentile(99));
+}
+
+/**********************************************************************
+ *                                IPC                                 *
+ **********************************************************************/
+
+template<std::size_t SIZE>
+struct Payload {
+  char bytes[SIZE];
+};
+
+/* Messages of the size of `Payload`, exchanged with a child process through
+ *  two channels: every `burst`-th message read is answered by the child.
+ */
+template<std::size_t SIZE>
+static void benchIPC(const Options& options) {
+  if (!selected(options, "ipc_roundtrip") && !selected(options, "ipc_throughput")) return;
+
+  using Data = Payload<SIZE>;
+  const std::string ping = "bench-ping-" + std::to_string(getpid());
+  const std::string pong = "bench-pong-" + std::to_string(getpid());
+  const std::string param = "size=" + std::to_string(SIZE);
+  const unsigned burst = 1000;
+
+  // Channels are created before forking, so that no message is written before the other end exists
+  {
+    MessageExchanger exchanger;
+    exchanger.init();
+    exchanger.openChannel(ping);
+    exchanger.openChannel(pong);
+  }
+
+  pid_t child = fork();
+  if (child == 0) {
+    MessageExchanger exchanger;
+    ChannelPtr in = exchanger.getChannel(ping);
+    ChannelPtr out = exchanger.getChannel(pong);
+    Data data;
+    // The first byte of a message tells whether to answer it (1), or to stop (2)
+    while (in->read(&data) > 0 && data.bytes[0] != 2) {
+      if (data.bytes[0] == 1) {
+        out->write(data);
+      }
+    }
+    std::_Exit(0);
+  }
+
+  // Channels are used through their handles, like the hot paths of the server
+  MessageExchanger exchanger;
+  ChannelPtr out = exchanger.getChannel(ping);
+  ChannelPtr in = exchanger.getChannel(pong);
+  Data data;
+  std::memset(&data, 0, sizeof(data));
+
+  if (selected(options, "ipc_roundtrip")) {
+    data.bytes[0] = 1;
+    measure(options, "ipc_roundtrip", param, [&]() {
+      out->write(data);
+      in->read(&data);
+    });
+  }
+
+  if (selected(options, "ipc_throughput")) {
+    unsigned long messages = 0;
+    Clock::time_point start = Clock::now();
+    do {
+      data.bytes[0] = 0;
+      for (unsigned m = 1; m != burst; ++m) {
+        out->write(data);
+      }
+      data.bytes[0] = 1;
+      out->write(data);
+      in->read(&data);
+      messages += burst;
+    } while (Clock::now() - start < std::chrono::duration<double>(options.seconds));
+    double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()) / double(messages);
+    report("ipc_throughput", param, messages, ns, 0, 0);
+  }
+
+  data.bytes[0] = 2;
+  out->write(data);
+  waitpid(child, nullptr, 0);
+  exchanger.removeChannel(ping);
+  exchanger.removeChannel(pong);
+}
+
+/* What the hot paths save by keeping the handles of their channels.
+ * Names are as long as the signatures clients used to be named after.
+ */
+static void benchChannelLookup(const Options& options, unsigned nChannels) {
+  MessageExchanger exchanger;
+  exchanger.init();
+  std::vector<std::string> names;
+  for (unsigned c = 0; c != nChannels; ++c) {
+    std::string name = "bench-" + std::to_string(getpid()) + "-" + std::to_string(c);
+    names.push_back(name + std::string(64 - name.size(), 'x'));
+    exchanger.openChannel(names.back());
+  }
+
+  std::size_t c = 0;
+  measure(options, "channel_lookup", "n=" + std::to_string(nChannels), [&]() {
+    exchanger.getChannel(names[c]);
+    c = (c + 1) % names.size();
+  });
+
+  for (const std::string& name: names) {
+    exchanger.removeChannel(name);
+  }
+}
+
+/**********************************************************************
+ *                               TOKENS                               *
+ **********************************************************************/
+
+static void benchTokens(const Options& options) {
+  std::string username = "bench";
+  std::string gameID = "0123456789";
+  std::string channel = std::to_string(getpid());
+  std::string timestamp = std::to_string(getTimestamp());
+  std::string signature = genSignature(username + gameID + channel + timestamp);
+
+  if (selected(options, "token_sign")) {
+    measure(options, "token_sign", "-", [&]() { genSignature(username + gameID + channel + timestamp); });
+  }
+
+  // Same check as `Server::_isTokenValid`
+  if (selected(options, "token_check")) {
+    Token token(username, gameID, channel, timestamp, signature);
+    bool valid = true;
+    measure(options, "token_check", "-", [&]() {
+      valid &= genSignature(token.getUsername() + token.getActivityID() + token.getGuestUsername() + token.getChannel() +
+                            token.getTimestamp()) == token.getSignature();
+    });
+    if (!valid) {
+      fprintf(stderr, "token_check: the token was refused\n");
+    }
+  }
+}
+
+/**********************************************************************
+ *                              DATABASE                              *
+ **********************************************************************/
+
+struct Query {
+  const char* name;
+  void (*run)(DatabaseManager&, int levelID);
+};
+
+static const Query QUERIES[] = {
+    {"db_sign_in", [](DatabaseManager& database, int) { database.signIn("bench", "password"); }},
+    {"db_is_admin", [](DatabaseManager& database, int) { database.isAdmin("bench"); }},
+    {"db_leaderboard", [](DatabaseManager& database, int) {
+       std::vector<PlayerInfo> leaderboard;
+       database.populateLeaderboard(leaderboard, 10);
+     }},
+    {"db_follows", [](DatabaseManager& database, int) {
+       std::vector<PlayerInfo> follows;
+       database.populateFollows(follows, "bench");
+     }},
+    {"db_campaign", [](DatabaseManager& database, int) {
+       std::vector<LevelInfo> levels;
+       database.getCampaign(levels);
+     }},
+    {"db_level_info", [](DatabaseManager& database, int levelID) { database.getLevelInfo(levelID); }},
+    {"db_level", [](DatabaseManager& database, int levelID) {
+       Level level;
+       database.populateLevel(level, levelID);
+     }},
+    {"db_patterns", [](DatabaseManager& database, int levelID) {
+       LevelPatterns patterns;
+       database.populatePatterns(patterns, levelID);
+     }},
+    {"db_new_score", [](DatabaseManager& database, int) { database.newScore("bench", 100); }},
+};
+
+static void benchDatabase(const Options& options) {
+  bool any = false;
+  for (const Query& query: QUERIES) {
+    any |= selected(options, query.name);
+  }
+  if (!any) return;
+
+  // Scores are written, the database of the repository is left untouched
+  std::string path = "/tmp/ltype-bench-" + std::to_string(getpid()) + ".db";
+  {
+    std::ifstream source(DB_PATH, std::ios::binary);
+    std::ofstream copy(path, std::ios::binary);
+    copy << source.rdbuf();
+  }
+
+  {
+    DatabaseManager database(path);
+    database.signUp("bench", "password");
+    std::vector<LevelInfo> campaign;
+    database.getCampaign(campaign);
+    int levelID = campaign.empty() ? 1 : campaign[0].id;
+
+    for (const Query& query: QUERIES) {
+      if (selected(options, query.name)) {
+        measure(options, query.name, "-", [&]() { query.run(database, levelID); });
+      }
+    }
+  }
+
+  unlink(path.c_str());
+}
+
+/**********************************************************************
+ *                              PHYSICS                               *
+ **********************************************************************/
+
+/* `n` enemies and obstacles scattered over the upper half of the map.
+ */
+static std::vector<EntityInfo> scatteredEntities(unsigned n) {
+  const unsigned enemies[][3] = {
+      {ASSET_ENEMY_1_ID, ASSET_ENEMY_1_WIDTH, ASSET_ENEMY_1_HEIGHT},
+      {ASSET_ENEMY_2_ID, ASSET_ENEMY_2_WIDTH, ASSET_ENEMY_2_HEIGHT},
+      {ASSET_ENEMY_3_ID, ASSET_ENEMY_3_WIDTH, ASSET_ENEMY_3_HEIGHT},
+      {ASSET_OBSTACLE_1_ID, ASSET_OBSTACLE_1_WIDTH, ASSET_OBSTACLE_1_HEIGHT},
+  };
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<> xPos(0, MAP_WIDTH - 3);
+  std::uniform_real_distribution<> yPos(0, MAP_HEIGHT / 2);
+  std::uniform_int_distribution<unsigned> type(0, 3);
+
+  std::vector<EntityInfo> entities;
+  for (unsigned e = 0; e != n; ++e) {
+    const unsigned* enemy = enemies[type(gen)];
+    entities.push_back({enemy[0], {xPos(gen), yPos(gen), int(enemy[1]), int(enemy[2]), 0, 0}});
+  }
+  return entities;
+}
+
+/* Enemies and obstacles only collide with players and bullets: with the players
+ *  at the bottom of the map, every check does the same work, and no entity dies.
+ */
+static void benchCollisions(const Options& options, unsigned n) {
+  PhysicsEngine physicsEngine(false, 5, 0, 0.5);
+  physicsEngine.newPlayer({ASSET_PLAYER_1_ID, {MAP_WIDTH / 3.0, MAP_HEIGHT - 5.0, ASSET_PLAYER_1_WIDTH, ASSET_PLAYER_1_HEIGHT, 0, 0}});
+  physicsEngine.newPlayer({ASSET_PLAYER_2_ID, {2 * MAP_WIDTH / 3.0, MAP_HEIGHT - 5.0, ASSET_PLAYER_2_WIDTH, ASSET_PLAYER_2_HEIGHT, 0, 0}});
+  for (const EntityInfo& entity: scatteredEntities(n)) {
+    physicsEngine.newEntity(entity);
+  }
+  measure(options, "collisions", "n=" + std::to_string(n), [&]() { physicsEngine.checkCollisions(); });
+}
+
+/* A single level spawning its entities in its first second.
+ */
+class FrameLevels: public LevelSource {
+ private:
+  Level _level = {};
+
+ public:
+  explicit FrameLevels(unsigned n) {
+    _level[1] = scatteredEntities(n);
+  }
+
+  std::vector<LevelInfo>& getCampaign(std::vector<LevelInfo>& dest) override {
+    dest.push_back(getLevelInfo(0));
+    return dest;
+  }
+
+  LevelInfo getLevelInfo(int id) const override {
+    return {id, "bench", "frames"};
+  }
+
+  Level& populateLevel(Level& level, int) override {
+    level = _level;
+    return level;
+  }
+};
+
+static void benchFrames(const Options& options, unsigned n) {
+  FrameLevels levels(n);
+  Game game(GameSettings(), &levels, {0}, 42);
+  game.start();
+  game.applyInput(CHEAT_CODE_GHOST);
+  // The entities are loaded after a second of play
+  for (unsigned tick = 0; tick != 2 * FPS; ++tick) {
+    game.refresh();
+  }
+  measure(options, "frame_build", "n=" + std::to_string(n), [&]() { game.buildFrame(); });
+}
+
+int main(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      options.filter = argv[++i];
+    } else if (std::strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+      options.seconds = std::atof(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: %s [--filter TEXT] [--time SECONDS]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  try {
+    printf("benchmark\tparam\tcount\tmean_ns\tp50_ns\tp99_ns\tops_per_s\n");
+    benchIPC<16>(options);
+    benchIPC<256>(options);
+    benchIPC<4096>(options);
+    for (unsigned n: {16u, 256u}) {
+      if (selected(options, "channel_lookup")) {
+        benchChannelLookup(options, n);
+      }
+    }
+    benchTokens(options);
+    benchDatabase(options);
+    for (unsigned n: {64u, 512u, 4096u}) {
+      if (selected(options, "collisions")) {
+        benchCollisions(options, n);
+      }
+    }
+    for (unsigned n: {64u, 512u, 4096u}) {
+      if (selected(options, "frame_build")) {
+        benchFrames(options, n);
+      }
+    }
+  } catch (std::exception& err) {
+    fprintf(stderr, "%s\n", err.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,472 @@
+/* Headless benchmark of the game simulation.
+ * Usage: bench-sim [--scenario campaign|boss|synthetic|world|all] [--ticks N]
+ *                  [--entities N] [--inputs random|idle] [--parallel THRESHOLD]
+ *                  [--batch GAMES] [--players N] [--snapshot] [--tick-rate HZ]
+ *  - campaign:  levels of the campaign, read from static/ltype.db
+ *  - boss:      the three boss fights, without the rest of their level
+ *  - synthetic: a level spawning thousands of enemies and obstacles
+ *  - world:     the same entities spread over a world twenty screens tall, mostly dormant
+ * Games are simulated at 30 ticks/s (or HZ) without sleeping, with invincible players (two by
+ *  default) driven by random (seeded) or no inputs. For each scenario, the
+ *  tool reports the tick rate, the mean time of each phase of a tick, the
+ *  allocations per tick, the cost and allocations of building the frame sent
+ *  to the client after each tick, and the peak number of entities.
+ * With --parallel, a serial game plays the same seed and inputs alongside,
+ *  untimed, and the tool fails at the first tick where the state hashes of
+ *  both games differ.
+ * With --batch, each scenario is played by GAMES games instead, refreshed one
+ *  after another then together in a `GameBatch`, and the tool compares the
+ *  number of game ticks simulated per second.
+ * With --snapshot, a snapshot of the game is taken every tick, the tick is
+ *  simulated, then rolled back and simulated again. The tool reports the cost
+ *  of a snapshot and of a restore, the size of the snapshot, and checks that
+ *  the rolled back game ends in the same state as a game played straight.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "assetsID.hpp"
+#include "constants.hpp"
+#include "server/DatabaseManager.hpp"
+#include "server/game/Game.hpp"
+#include "server/game/GameBatch.hpp"
+#include "server/game/LevelSource.hpp"
+
+/**********************************************************************
+ *                            ALLOCATIONS                             *
+ **********************************************************************/
+
+static std::atomic<unsigned long> allocations(0);
+
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+/**********************************************************************
+ *                          SYNTHETIC LEVELS                          *
+ **********************************************************************/
+
+/* Levels built in memory instead of being read from the database.
+ */
+class SyntheticLevels: public LevelSource {
+ private:
+  std::vector<Level> _levels = {};
+
+ public:
+  int add(const Level& level) {
+    _levels.push_back(level);
+    return int(_levels.size()) - 1;
+  }
+
+  std::vector<LevelInfo>& getCampaign(std::vector<LevelInfo>& dest) override {
+    for (std::size_t l = 0; l != _levels.size(); ++l) {
+      dest.push_back(getLevelInfo(int(l)));
+    }
+    return dest;
+  }
+
+  LevelInfo getLevelInfo(int id) const override {
+    return {id, "bench", "synthetic"};
+  }
+
+  Level& populateLevel(Level& level, int id) override {
+    level = _levels.at(std::size_t(id));
+    return level;
+  }
+};
+
+static EntityInfo entityAt(unsigned typeID, int width, int height, double xPos, double yPos) {
+  return {typeID, {xPos, yPos, width, height, 0, 0}};
+}
+
+static void addBossLevels(SyntheticLevels& levels) {
+  const unsigned bosses[][3] = {
+      {ASSET_BOSS_1_ID, ASSET_BOSS_1_WIDTH, ASSET_BOSS_1_HEIGHT},
+      {ASSET_BOSS_2_ID, ASSET_BOSS_2_WIDTH, ASSET_BOSS_2_HEIGHT},
+      {ASSET_BOSS_3_ID, ASSET_BOSS_3_WIDTH, ASSET_BOSS_3_HEIGHT},
+  };
+  for (const unsigned* boss: bosses) {
+    Level level;
+    level[1].push_back(entityAt(boss[0], int(boss[1]), int(boss[2]), 40, 0));
+    levels.add(level);
+  }
+}
+
+/* Ten waves, one per second, each holding `entities / 10` enemies and
+ *  obstacles scattered over the upper half of the map.
+ */
+static void addSyntheticLevel(SyntheticLevels& levels, unsigned entities) {
+  const unsigned enemies[][3] = {
+      {ASSET_ENEMY_1_ID, ASSET_ENEMY_1_WIDTH, ASSET_ENEMY_1_HEIGHT},
+      {ASSET_ENEMY_2_ID, ASSET_ENEMY_2_WIDTH, ASSET_ENEMY_2_HEIGHT},
+      {ASSET_ENEMY_3_ID, ASSET_ENEMY_3_WIDTH, ASSET_ENEMY_3_HEIGHT},
+      {ASSET_OBSTACLE_1_ID, ASSET_OBSTACLE_1_WIDTH, ASSET_OBSTACLE_1_HEIGHT},
+  };
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<> xPos(0, MAP_WIDTH - 3);
+  std::uniform_real_distribution<> yPos(0, MAP_HEIGHT / 2);
+  std::uniform_int_distribution<unsigned> type(0, 3);
+
+  Level level;
+  unsigned waveSize = std::max(1u, entities / 10);
+  for (unsigned second = 1; second <= 10; ++second) {
+    for (unsigned e = 0; e != waveSize; ++e) {
+      const unsigned* enemy = enemies[type(gen)];
+      level[second].push_back(entityAt(enemy[0], int(enemy[1]), int(enemy[2]), xPos(gen), yPos(gen)));
+    }
+  }
+  levels.add(level);
+}
+
+/* `entities` enemies and obstacles spawned at once, scattered over a world
+ *  twenty screens tall above the screen. Only the ones near the view are simulated.
+ */
+static void addWorldLevel(SyntheticLevels& levels, unsigned entities) {
+  const unsigned enemies[][3] = {
+      {ASSET_ENEMY_1_ID, ASSET_ENEMY_1_WIDTH, ASSET_ENEMY_1_HEIGHT},
+      {ASSET_ENEMY_2_ID, ASSET_ENEMY_2_WIDTH, ASSET_ENEMY_2_HEIGHT},
+      {ASSET_ENEMY_3_ID, ASSET_ENEMY_3_WIDTH, ASSET_ENEMY_3_HEIGHT},
+      {ASSET_OBSTACLE_1_ID, ASSET_OBSTACLE_1_WIDTH, ASSET_OBSTACLE_1_HEIGHT},
+  };
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<> xPos(0, MAP_WIDTH - 3);
+  std::uniform_real_distribution<> yPos(-20 * MAP_HEIGHT, MAP_HEIGHT / 2);
+  std::uniform_int_distribution<unsigned> type(0, 3);
+
+  Level level;
+  for (unsigned e = 0; e != entities; ++e) {
+    const unsigned* enemy = enemies[type(gen)];
+    level[1].push_back(entityAt(enemy[0], int(enemy[1]), int(enemy[2]), xPos(gen), yPos(gen)));
+  }
+  levels.add(level);
+}
+
+/**********************************************************************
+ *                             BENCHMARK                              *
+ **********************************************************************/
+
+struct Options {
+  unsigned ticks = 3000;
+  unsigned entities = 2000;
+  bool randomInputs = true;
+  long parallelThreshold = -1;  // -1 keeps the default threshold
+  unsigned batch = 0;           // 0 benchmarks a single game
+  unsigned players = 2;
+  bool snapshot = false;
+  unsigned tickRate = FPS;
+};
+
+static int randomKey(std::mt19937& gen, unsigned nPlayer) {
+  static const int keys[] = {
+      EMPTY_KEY, GAME_KEY_UP, GAME_KEY_DOWN, GAME_KEY_RIGHT, GAME_KEY_LEFT,
+      GAME_KEY_UP_RIGHT, GAME_KEY_UP_LEFT, GAME_KEY_DOWN_RIGHT, GAME_KEY_DOWN_LEFT,
+      GAME_KEY_SHOOT, GAME_KEY_SHOOT_UP, GAME_KEY_SHOOT_DOWN, GAME_KEY_SHOOT_RIGHT, GAME_KEY_SHOOT_LEFT};
+  return gameInput(keys[gen() % (sizeof(keys) / sizeof(keys[0]))], nPlayer);
+}
+
+static void benchmark(const char* scenario, LevelSource& levels, const std::vector<int>& levelIDs, const Options& options) {
+  using Clock = std::chrono::steady_clock;
+
+  GameSettings settings;
+  settings.nbPlayers = options.players;
+  settings.tickRate = options.tickRate;
+  Game game(settings, &levels, levelIDs, 42);
+  std::unique_ptr<Game> serial;  // Same game ticked serially, to check the parallel tick against
+  if (options.parallelThreshold >= 0) {
+    game.setParallelThreshold(std::size_t(options.parallelThreshold));
+    serial.reset(new Game(settings, &levels, levelIDs, 42));
+    serial->setParallelThreshold(0);
+    serial->start();
+    serial->applyInput(CHEAT_CODE_GHOST);
+  }
+  game.start();
+  game.applyInput(CHEAT_CODE_GHOST);
+
+  std::mt19937 gen(42);
+  TickPhases phases;
+  unsigned long tickAllocations = 0;
+  unsigned long frameAllocations = 0;
+  std::size_t peakEntities = 0;
+  unsigned ticks = 0;
+
+  Clock::duration elapsed = Clock::duration::zero();
+  Clock::duration framesElapsed = Clock::duration::zero();
+  for (; ticks != options.ticks && !game.won(); ++ticks) {
+    if (options.randomInputs) {
+      for (unsigned p = 0; p != options.players; ++p) {
+        int input = randomKey(gen, p);
+        game.applyInput(input);
+        if (serial) {
+          serial->applyInput(input);
+        }
+      }
+    }
+
+    unsigned long allocationsBefore = allocations.load(std::memory_order_relaxed);
+    Clock::time_point start = Clock::now();
+    game.refresh(&phases);
+    elapsed += Clock::now() - start;
+    tickAllocations += allocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+    allocationsBefore = allocations.load(std::memory_order_relaxed);
+    start = Clock::now();
+    const FrameArena& frame = game.buildFrame();
+    framesElapsed += Clock::now() - start;
+    frameAllocations += allocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+    peakEntities = std::max(peakEntities, frame.refreshFrame().nbEntities);
+
+    if (serial) {
+      serial->refresh();
+      if (serial->stateHash() != game.stateHash()) {
+        throw std::runtime_error(std::string(scenario) + ": the parallel tick " + std::to_string(ticks) + " differs from the serial one");
+      }
+    }
+  }
+
+  double us = double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / 1000;
+  double perTick = (ticks) ? 1.0 / (1000 * ticks) : 0;  // ns -> µs/tick
+  double frameUs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(framesElapsed).count()) / 1000;
+  printf("%-10s %6u %10.0f %9.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %10.1f %8.2f %12.3f %6zu\n",
+         scenario, ticks, (us > 0) ? ticks / us * 1e6 : 0, (ticks) ? us / ticks : 0,
+         double(phases.moves) * perTick, double(phases.offScreen) * perTick, double(phases.loadLevel) * perTick,
+         double(phases.attacks) * perTick, double(phases.collisions) * perTick, double(phases.states) * perTick,
+         (ticks) ? double(tickAllocations) / ticks : 0, (ticks) ? frameUs / ticks : 0,
+         (ticks) ? double(frameAllocations) / ticks : 0, peakEntities);
+}
+
+/* Play `nGames` games, each with its own seed, either refreshed one after another or in a batch.
+ * Return the number of game ticks per second, and the combined state hash of the games in `hash`.
+ */
+static double playGames(LevelSource& levels, const std::vector<int>& levelIDs, const Options& options, bool batched, std::uint64_t& hash) {
+  using Clock = std::chrono::steady_clock;
+
+  GameSettings settings;
+  settings.nbPlayers = options.players;
+  settings.tickRate = options.tickRate;
+  std::vector<Game*> games;
+  GameBatch batch;
+  for (unsigned g = 0; g != options.batch; ++g) {
+    games.push_back(new Game(settings, &levels, levelIDs, 42 + g));
+    games.back()->start();
+    games.back()->applyInput(CHEAT_CODE_GHOST);
+    batch.add(games.back());
+  }
+
+  std::mt19937 gen(42);
+  unsigned long gameTicks = 0;
+  Clock::duration elapsed = Clock::duration::zero();
+  for (unsigned tick = 0; tick != options.ticks && batch.size(); ++tick) {
+    // Finished games leave the batch
+    for (Game* game: games) {
+      if (game->won()) {
+        batch.remove(game);
+      }
+    }
+    if (options.randomInputs) {
+      for (Game* game: batch.games()) {
+        for (unsigned p = 0; p != options.players; ++p) {
+          game->applyInput(randomKey(gen, p));
+        }
+      }
+    }
+
+    Clock::time_point start = Clock::now();
+    if (batched) {
+      batch.refresh();
+    } else {
+      for (Game* game: batch.games()) {
+        game->refresh();
+      }
+    }
+    elapsed += Clock::now() - start;
+    gameTicks += batch.size();
+  }
+
+  hash = 0;
+  for (Game* game: games) {
+    hash = hash * 31 + game->stateHash();
+    delete game;
+  }
+  double us = double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / 1000;
+  return (us > 0) ? double(gameTicks) / us * 1e6 : 0;
+}
+
+static void benchmarkBatch(const char* scenario, LevelSource& levels, const std::vector<int>& levelIDs, const Options& options) {
+  std::uint64_t separateHash, batchedHash;
+  double separate = playGames(levels, levelIDs, options, false, separateHash);
+  double batched = playGames(levels, levelIDs, options, true, batchedHash);
+  printf("%-10s %6u %6u %14.0f %14.0f %8.2f %10s\n",
+         scenario, options.batch, options.ticks, separate, batched, (separate > 0) ? batched / separate : 0,
+         (separateHash == batchedHash) ? "yes" : "NO");
+}
+
+/* Play the scenario straight, then with a rollback every tick.
+ * Return the state hash of the game played straight.
+ */
+static std::uint64_t playStraight(LevelSource& levels, const std::vector<int>& levelIDs, const Options& options) {
+  GameSettings settings;
+  settings.nbPlayers = options.players;
+  settings.tickRate = options.tickRate;
+  Game game(settings, &levels, levelIDs, 42);
+  game.start();
+  game.applyInput(CHEAT_CODE_GHOST);
+
+  std::mt19937 gen(42);
+  for (unsigned tick = 0; tick != options.ticks && !game.won(); ++tick) {
+    if (options.randomInputs) {
+      for (unsigned p = 0; p != options.players; ++p) {
+        game.applyInput(randomKey(gen, p));
+      }
+    }
+    game.refresh();
+  }
+  return game.stateHash();
+}
+
+static void benchmarkSnapshot(const char* scenario, LevelSource& levels, const std::vector<int>& levelIDs, const Options& options) {
+  using Clock = std::chrono::steady_clock;
+
+  GameSettings settings;
+  settings.nbPlayers = options.players;
+  settings.tickRate = options.tickRate;
+  Game game(settings, &levels, levelIDs, 42);
+  game.start();
+  game.applyInput(CHEAT_CODE_GHOST);
+
+  std::mt19937 gen(42);
+  GameSnapshot snapshot;
+  unsigned long snapshotAllocations = 0;
+  std::size_t totalEntities = 0;
+  std::size_t peakEntities = 0;
+  unsigned ticks = 0;
+
+  Clock::duration snapshotTime = Clock::duration::zero();
+  Clock::duration restoreTime = Clock::duration::zero();
+  for (; ticks != options.ticks && !game.won(); ++ticks) {
+    if (options.randomInputs) {
+      for (unsigned p = 0; p != options.players; ++p) {
+        game.applyInput(randomKey(gen, p));
+      }
+    }
+
+    unsigned long allocationsBefore = allocations.load(std::memory_order_relaxed);
+    Clock::time_point start = Clock::now();
+    game.snapshot(snapshot);
+    snapshotTime += Clock::now() - start;
+    snapshotAllocations += allocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+    game.refresh();
+    start = Clock::now();
+    game.restore(snapshot);
+    restoreTime += Clock::now() - start;
+    game.refresh();
+
+    totalEntities += snapshot.world.entities.size();
+    peakEntities = std::max(peakEntities, snapshot.world.entities.size());
+  }
+
+  double perTick = (ticks) ? 1.0 / (1000 * ticks) : 0;  // ns -> µs/tick
+  double meanEntities = (ticks) ? double(totalEntities) / ticks : 0;
+  printf("%-10s %6u %8.0f %6zu %10.2f %10.2f %10.0f %10.2f %10s\n",
+         scenario, ticks, meanEntities, peakEntities,
+         double(std::chrono::duration_cast<std::chrono::nanoseconds>(snapshotTime).count()) * perTick,
+         double(std::chrono::duration_cast<std::chrono::nanoseconds>(restoreTime).count()) * perTick,
+         meanEntities * sizeof(EntityRecord) + sizeof(GameSnapshot),
+         (ticks) ? double(snapshotAllocations) / ticks : 0,
+         (game.stateHash() == playStraight(levels, levelIDs, options)) ? "yes" : "NO");
+}
+
+int main(int argc, char* argv[]) {
+  Options options;
+  std::string scenario = "all";
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+      scenario = argv[++i];
+    } else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+      options.ticks = unsigned(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--entities") == 0 && i + 1 < argc) {
+      options.entities = unsigned(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--inputs") == 0 && i + 1 < argc) {
+      options.randomInputs = std::strcmp(argv[++i], "idle") != 0;
+    } else if (std::strcmp(argv[i], "--parallel") == 0 && i + 1 < argc) {
+      options.parallelThreshold = std::atol(argv[++i]);
+    } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+      options.batch = unsigned(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+      options.players = std::min(std::max(1u, unsigned(std::atoi(argv[++i]))), MAX_PLAYERS);
+    } else if (std::strcmp(argv[i], "--snapshot") == 0) {
+      options.snapshot = true;
+    } else if (std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+      options.tickRate = unsigned(std::atoi(argv[++i]));
+    } else {
+      fprintf(stderr, "usage: %s [--scenario campaign|boss|synthetic|world|all] [--ticks N] [--entities N] [--inputs random|idle] [--parallel THRESHOLD] [--batch GAMES] [--players N] [--snapshot] [--tick-rate HZ]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  void (*run)(const char*, LevelSource&, const std::vector<int>&, const Options&) = benchmark;
+  if (options.snapshot) {
+    run = benchmarkSnapshot;
+    printf("%-10s %6s %8s %6s %10s %10s %10s %10s %10s\n",
+           "scenario", "ticks", "entities", "peak", "snap_us", "restore_us", "bytes", "allocs/snap", "identical");
+  } else if (options.batch) {
+    run = benchmarkBatch;
+    printf("%-10s %6s %6s %14s %14s %8s %10s\n",
+           "scenario", "games", "ticks", "separate/s", "batched/s", "speedup", "identical");
+  } else {
+    printf("%-10s %6s %10s %9s %8s %8s %8s %8s %8s %8s %10s %8s %12s %6s\n",
+           "scenario", "ticks", "ticks/s", "us/tick", "moves", "offscr", "level", "attacks", "collide", "states", "allocs/tick",
+           "frame_us", "allocs/frame", "peak");
+  }
+
+  try {
+    if (scenario == "campaign" || scenario == "all") {
+      DatabaseManager databaseManager("static/ltype.db");
+      run("campaign", databaseManager, {-1}, options);
+    }
+    if (scenario == "boss" || scenario == "all") {
+      SyntheticLevels levels;
+      addBossLevels(levels);
+      run("boss", levels, {-1}, options);
+    }
+    if (scenario == "synthetic" || scenario == "all") {
+      SyntheticLevels levels;
+      addSyntheticLevel(levels, options.entities);
+      run("synthetic", levels, {-1}, options);
+    }
+    if (scenario == "world" || scenario == "all") {
+      SyntheticLevels levels;
+      addWorldLevel(levels, options.entities);
+      run("world", levels, {-1}, options);
+    }
+  } catch (const std::exception& err) {
+    fprintf(stderr, "%s\n", err.what());
+    return 1;
+  }
+  return 0;
+}
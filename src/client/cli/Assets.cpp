@@ -0,0 +1,67 @@
+#include "client/cli/Assets.hpp"
+
+#include "assetsID.hpp"
+#include "client/cli/assets/Sprite.hpp"
+#include "client/cli/assets/Boss_1.hpp"
+#include "client/cli/assets/Boss_2.hpp"
+#include "client/cli/assets/Boss_3.hpp"
+#include "client/cli/assets/Bullet.hpp"
+#include "client/cli/assets/Enemy_1.hpp"
+#include "client/cli/assets/Enemy_2.hpp"
+#include "client/cli/assets/Enemy_3.hpp"
+#include "client/cli/assets/Henchman_1_left.hpp"
+#include "client/cli/assets/Henchman_1_right.hpp"
+#include "client/cli/assets/Henchman_2_left.hpp"
+#include "client/cli/assets/Henchman_2_right.hpp"
+#include "client/cli/assets/Henchman_3_left.hpp"
+#include "client/cli/assets/Henchman_3_right.hpp"
+#include "client/cli/assets/Obstacle_1.hpp"
+#include "client/cli/assets/Obstacle_2.hpp"
+#include "client/cli/assets/Obstacle_3.hpp"
+#include "client/cli/assets/Player_1.hpp"
+#include "client/cli/assets/Player_2.hpp"
+#include "client/cli/assets/Player_3.hpp"
+#include "client/cli/assets/Player_4.hpp"
+#include "client/cli/assets/Player_5.hpp"
+#include "client/cli/assets/Powerup_1.hpp"
+#include "client/cli/assets/Powerup_2.hpp"
+
+std::map<unsigned, Sprite*> Assets::_assets = {};
+
+void Assets::buildAssets() {
+  destroyAssets();
+  _assets.insert({ASSET_BOSS_1_ID, new Boss_1(ASSET_BOSS_1_HEIGHT, ASSET_BOSS_1_WIDTH)});
+  _assets.insert({ASSET_BOSS_2_ID, new Boss_2(ASSET_BOSS_2_HEIGHT, ASSET_BOSS_2_WIDTH)});
+  _assets.insert({ASSET_BOSS_3_ID, new Boss_3(ASSET_BOSS_3_HEIGHT, ASSET_BOSS_3_WIDTH)});
+  _assets.insert({ASSET_BULLET_ID, new Bullet(ASSET_BULLET_HEIGHT, ASSET_BULLET_WIDTH)});
+  _assets.insert({ASSET_ENEMY_1_ID, new Enemy_1(ASSET_ENEMY_1_HEIGHT, ASSET_ENEMY_1_WIDTH)});
+  _assets.insert({ASSET_ENEMY_2_ID, new Enemy_2(ASSET_ENEMY_2_HEIGHT, ASSET_ENEMY_2_WIDTH)});
+  _assets.insert({ASSET_ENEMY_3_ID, new Enemy_3(ASSET_ENEMY_3_HEIGHT, ASSET_ENEMY_3_WIDTH)});
+  _assets.insert({ASSET_HENCHMAN_1_LEFT_ID, new Henchman_1_left(ASSET_HENCHMAN_1_LEFT_HEIGHT, ASSET_HENCHMAN_1_LEFT_WIDTH)});
+  _assets.insert({ASSET_HENCHMAN_1_RIGHT_ID, new Henchman_1_right(ASSET_HENCHMAN_1_RIGHT_HEIGHT, ASSET_HENCHMAN_1_RIGHT_WIDTH)});
+  _assets.insert({ASSET_HENCHMAN_2_LEFT_ID, new Henchman_2_left(ASSET_HENCHMAN_2_LEFT_HEIGHT, ASSET_HENCHMAN_2_LEFT_WIDTH)});
+  _assets.insert({ASSET_HENCHMAN_2_RIGHT_ID, new Henchman_2_right(ASSET_HENCHMAN_2_RIGHT_HEIGHT, ASSET_HENCHMAN_2_RIGHT_WIDTH)});
+  _assets.insert({ASSET_HENCHMAN_3_LEFT_ID, new Henchman_3_left(ASSET_HENCHMAN_3_LEFT_HEIGHT, ASSET_HENCHMAN_3_LEFT_WIDTH)});
+  _assets.insert({ASSET_HENCHMAN_3_RIGHT_ID, new Henchman_3_right(ASSET_HENCHMAN_3_RIGHT_HEIGHT, ASSET_HENCHMAN_3_RIGHT_WIDTH)});
+  _assets.insert({ASSET_OBSTACLE_1_ID, new Obstacle_1(ASSET_OBSTACLE_1_HEIGHT, ASSET_OBSTACLE_1_WIDTH)});
+  _assets.insert({ASSET_OBSTACLE_2_ID, new Obstacle_2(ASSET_OBSTACLE_2_HEIGHT, ASSET_OBSTACLE_2_WIDTH)});
+  _assets.insert({ASSET_OBSTACLE_3_ID, new Obstacle_3(ASSET_OBSTACLE_3_HEIGHT, ASSET_OBSTACLE_3_WIDTH)});
+  _assets.insert({ASSET_PLAYER_1_ID, new Player_1(ASSET_PLAYER_1_HEIGHT, ASSET_PLAYER_1_WIDTH)});
+  _assets.insert({ASSET_PLAYER_2_ID, new Player_2(ASSET_PLAYER_2_HEIGHT, ASSET_PLAYER_2_WIDTH)});
+  _assets.insert({ASSET_PLAYER_3_ID, new Player_3(ASSET_PLAYER_3_HEIGHT, ASSET_PLAYER_3_WIDTH)});
+  _assets.insert({ASSET_PLAYER_4_ID, new Player_4(ASSET_PLAYER_4_HEIGHT, ASSET_PLAYER_4_WIDTH)});
+  _assets.insert({ASSET_PLAYER_5_ID, new Player_5(ASSET_PLAYER_5_HEIGHT, ASSET_PLAYER_5_WIDTH)});
+  _assets.insert({ASSET_POWERUP_1_ID, new Powerup_1(ASSET_POWERUP_1_HEIGHT, ASSET_POWERUP_1_WIDTH)});
+  _assets.insert({ASSET_POWERUP_2_ID, new Powerup_2(ASSET_POWERUP_2_HEIGHT, ASSET_POWERUP_2_WIDTH)});
+}
+
+void Assets::destroyAssets() {
+  for (const auto& e: _assets) {
+    delete e.second;
+  }
+  _assets.clear();
+}
+
+Sprite* Assets::getSpriteById(unsigned id) {
+  return _assets.at(id);
+}
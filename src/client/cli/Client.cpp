@@ -275,7 +275,7 @@ bool Client::_setGameScreen() {
   bool validGame = false;
   while (!validGame) {
     // Set texts to display
-    std::string gameMode = (settings.secondPlayer) ? Locale::get("Multi") : Locale::get("Solo");
+    std::string gameMode = (settings.nbPlayers > 1) ? Locale::get("Multi") : Locale::get("Solo");
 
     std::string difficulty;
     if (settings.difficulty <= 0.33) {
@@ -329,14 +329,14 @@ bool Client::_setGameScreen() {
 #endif
     // t = last optional (GUI/CLI) option
     else if (c == t + 1) {
-      _controlsScreen(settings.secondPlayer);
+      _controlsScreen(settings.nbPlayers > 1);
     } else if (c == t + 2) {
       std::vector<std::string> options = {Locale::get("Solo"), Locale::get("Multi")};
-      if (_window.drawSelectionMenu(Locale::get("Game Mode"), settings.secondPlayer, options) == 1) {
-        settings.secondPlayer = _loginScreen();
+      if (_window.drawSelectionMenu(Locale::get("Game Mode"), settings.nbPlayers > 1, options) == 1) {
+        settings.nbPlayers = (_loginScreen()) ? 2 : 1;
       } else {
         _communicationAPI.removeSecondPlayer();
-        settings.secondPlayer = false;
+        settings.nbPlayers = 1;
       }
     } else if (c == t + 3) {
       std::vector<std::string> options = {"1", "2", "3", "4", "5", "6", "7"};
@@ -371,19 +371,25 @@ void Client::_gameScreen() {
 
   int gameState = 0;
   do {
+    std::vector<PlayerFrame> players;
     std::vector<EntityFrame> entities;
-    RefreshFrame refreshFrame = _communicationAPI.getGameState(entities);
+    RefreshFrame refreshFrame = _communicationAPI.getGameState(players, entities);
     gameState = refreshFrame.gameState;
 
-    long latency = getTimestamp() - refreshFrame.timestamp;  // µs
+    long latency = getMonotonicTimestamp() - refreshFrame.sent;  // µs
 
+    // Age of the refresh, then latency of the inputs until they are displayed (median and 99th percentile)
+    const Histogram& inputs = _communicationAPI.inputLatency().stage(LATENCY_TOTAL);
     _window.clearLabels();
-    _window.drawLabel(std::to_string(latency / 1000) + "ms     ", 1, 1);
+    _window.drawLabel(std::to_string(latency / 1000) + "ms  input " + std::to_string(inputs.percentile(50) / 1000) + "/" +
+                          std::to_string(inputs.percentile(99) / 1000) + "ms     ",
+                      1, 1);
 
     if (latency >= MAX_LATENCY) continue;
 
     if (gameState == 0) {
-      _window.refreshGame(refreshFrame, entities);
+      _window.refreshGame(refreshFrame, players, entities);
+      _communicationAPI.inputLatency().show(refreshFrame);
 
       try {
         _window.processGameInput<CommunicationAPI>(&CommunicationAPI::sendGameInput, &_communicationAPI);
@@ -22,8 +22,8 @@ Game::CheatCodes Game::_cheatCodes = {
     },
 };
 
-Game::Game(const std::array<std::size_t, MAX_PLAYERS>& mapping) noexcept {
-  for (std::size_t p = 0; p != MAX_PLAYERS; ++p) {
+Game::Game(const std::array<std::size_t, LOCAL_PLAYERS>& mapping) noexcept {
+  for (std::size_t p = 0; p != LOCAL_PLAYERS; ++p) {
     _userMapping[p] = mapping[p];
   }
 
@@ -70,31 +70,22 @@ int Game::getInput() noexcept {
     if (key == mapKey1 || key == mapKey2) {
       int p = mapKey1 != key;
 
-      input = mapping.first;
-
-      input <<= 1;
-      input += int(p);
+      input = gameInput(mapping.first, unsigned(p));
 
       break;
     }
   }
 
-  if (input == INVALID_KEY && _lastInputTimestamp != 0 && (getTimestamp() - _lastInputTimestamp) / 1000000 > CLIENT_TIMEOUT - 5) {
-    _lastInputTimestamp = getTimestamp();
-    input = EMPTY_KEY;
-  } else {
-    _lastInputTimestamp = getTimestamp();
-  }
-
+  // No key pressed keeps the player connected all the same (see `CommunicationAPI::sendGameInput`)
   return input;
 }
 
-void Game::updateGameState(unsigned progress, const unsigned score[2], const double hpPlayers[2]) {
+void Game::updateGameState(unsigned progress, const std::vector<PlayerFrame>& players) {
   _progress = progress;
-  _score[0] = score[0];
-  _score[1] = score[1];
-  _hpPlayers[0] = hpPlayers[0];
-  _hpPlayers[1] = hpPlayers[1];
+  for (std::size_t p = 0; p != LOCAL_PLAYERS; ++p) {
+    _score[p] = (p < players.size()) ? players[p].score : 0;
+    _hpPlayers[p] = (p < players.size()) ? players[p].hp : 0;
+  }
 }
 
 void Game::clearEntities() {
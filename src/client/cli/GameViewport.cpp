@@ -44,14 +44,14 @@ int GameViewport::_maxInnerWidth() const noexcept {
   return innerWidth;
 }
 
-void GameViewport::_drawScores(unsigned int score[MAX_PLAYERS]) const noexcept {
+void GameViewport::_drawScores(unsigned int score[LOCAL_PLAYERS]) const noexcept {
   wattron(_outer, COLOR_PAIR(0));
   mvwprintw(_outer, 1, 2, score[0] != 0 ? std::to_string(score[0]).c_str() : "");
   mvwprintw(_outer, 1, _width - int(log10(score[1])) - 3, score[1] != 0 ? std::to_string(score[1]).c_str() : "");
   wattroff(_outer, COLOR_PAIR(0));
 }
 
-void GameViewport::_drawHP(double hpPlayers[MAX_PLAYERS]) const noexcept {
+void GameViewport::_drawHP(double hpPlayers[LOCAL_PLAYERS]) const noexcept {
   wattron(_outer, COLOR_PAIR(3));
   for (int i = 0; i != ceil(hpPlayers[0]); ++i) {
     mvwprintw(_outer, int(_height / 3) + i, 2, "❤");
@@ -99,7 +99,7 @@ bool GameViewport::checkSize() const noexcept {
   return _maxInnerWidth() > CLI_MAP_WIDTH && _maxInnerHeight() > CLI_MAP_HEIGHT;
 }
 
-void GameViewport::drawGame(unsigned int score[MAX_PLAYERS], double hpPlayer[MAX_PLAYERS], unsigned progress, std::vector<Entity>& entities) {
+void GameViewport::drawGame(unsigned int score[LOCAL_PLAYERS], double hpPlayer[LOCAL_PLAYERS], unsigned progress, std::vector<Entity>& entities) {
   drawWindow();
 
   for (const Entity& entity: entities) {
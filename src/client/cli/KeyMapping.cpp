@@ -74,7 +74,7 @@ int KeyMapping::normalizeInput(int key, int gameKey) noexcept {
   }
 }
 
-int KeyMapping::normalizeGameInput(int key, const std::array<std::size_t, 2>& userMapping) noexcept {
+int KeyMapping::normalizeGameInput(int key, const std::array<std::size_t, LOCAL_PLAYERS>& userMapping) noexcept {
   int input = INVALID_KEY;
 
   for (const KeyMapping::Mapping::value_type& mapping: _keyboardMapping) {
@@ -84,10 +84,7 @@ int KeyMapping::normalizeGameInput(int key, const std::array<std::size_t, 2>& us
     if (key == mapKey1 || key == mapKey2) {
       int p = mapKey1 != key;
 
-      input = mapping.first;
-
-      input <<= 1;
-      input += int(p);
+      input = gameInput(mapping.first, unsigned(p));
 
       break;
     }
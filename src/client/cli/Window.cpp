@@ -139,10 +139,10 @@ void Window::initGame(const Game::Mapping& userMapping) {
   window->drawWindow();
 }
 
-void Window::refreshGame(const RefreshFrame& refreshFrame, const std::vector<EntityFrame>& entities) {
+void Window::refreshGame(const RefreshFrame& refreshFrame, const std::vector<PlayerFrame>& players, const std::vector<EntityFrame>& entities) {
   if (!_currentGame) throw FatalError("There is no active game.");
 
-  _currentGame->updateGameState(refreshFrame.progress, refreshFrame.score, refreshFrame.hpPlayers);
+  _currentGame->updateGameState(refreshFrame.progress, players);
   _currentGame->clearEntities();
   for (const EntityFrame& entity: entities) {
     // add in _entities display vector in game
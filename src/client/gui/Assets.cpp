@@ -0,0 +1,1306 @@
+#include "client/gui/Assets.hpp"
+
+#include <unistd.h>
+
+#include "assetsID.hpp"
+#include "client/gui/guiID.hpp"
+#include "constants.hpp"
+
+std::vector<std::string> Assets::_pack = {
+    "static/packs/StorWors/",
+    "static/packs/Moinecroft/",
+};
+int Assets::_currentPack = 0;
+
+std::string Assets::_blankAudio = "static/packs/blank.ogg";
+
+Assets::AudioMap Assets::_audios = {
+    {
+        PACK_AUDIO_BOSS_ID,
+        {
+            "audios/boss/0.ogg",
+        }
+    },
+    {
+        PACK_AUDIO_GAME_ID,
+        {
+            "audios/game/0.ogg",
+        }
+    },
+    {
+        PACK_AUDIO_HURT_ID,
+        {
+            "audios/hurt/0.ogg",
+            "audios/hurt/1.ogg",
+            "audios/hurt/2.ogg",
+            "audios/hurt/3.ogg",
+            "audios/hurt/4.ogg",
+        }
+    },
+    {
+        PACK_AUDIO_LEVEL_UP_ID,
+        {
+            "audios/level_up/0.ogg",
+            "audios/level_up/1.ogg",
+        }
+    },
+    {
+        PACK_AUDIO_LOOSE_ID,
+        {
+            "audios/loose/0.ogg",
+            "audios/loose/1.ogg",
+            "audios/loose/2.ogg",
+            "audios/loose/3.ogg",
+        }
+    },
+    {
+        PACK_AUDIO_MENU_ID,
+        {
+            "audios/menu/0.ogg",
+        }
+    },
+    {
+        PACK_AUDIO_POWER_UP_DAMAGE_ID,
+        {
+            "audios/power_up_damage/0.ogg",
+        }
+    },
+    {
+        PACK_AUDIO_POWER_UP_FIRE_RATE_ID,
+        {
+            "audios/power_up_fire_rate/0.ogg",
+        }
+    },
+    {
+        PACK_AUDIO_RESPAWN_ID,
+        {
+            "audios/respawn/0.ogg",
+            "audios/respawn/1.ogg",
+        }
+    },
+    {
+        PACK_AUDIO_SHOOT_ID,
+        {
+            "audios/shoot/0.ogg",
+            "audios/shoot/1.ogg",
+            "audios/shoot/2.ogg",
+            "audios/shoot/3.ogg",
+            "audios/shoot/4.ogg",
+            "audios/shoot/5.ogg",
+        }
+    },
+    {
+        PACK_AUDIO_WIN_ID,
+        {
+            "audios/win/0.ogg",
+        }
+    },
+};
+
+Assets::FileMap Assets::_files = {
+    {
+        PACK_BACKGROUND_0_ID,
+        "background/0.png",
+    },
+    {
+        PACK_BACKGROUND_1_ID,
+        "background/1.png",
+    },
+    {
+        PACK_BACKGROUND_2_ID,
+        "background/2.png",
+    },
+    {
+        PACK_BACKGROUND_3_ID,
+        "background/3.png",
+    },
+    {
+        PACK_HUD_HEART_ID,
+        "hud/heart.png",
+    },
+    {
+        PACK_HUD_PROGRESS_BAR_ID,
+        "hud/progress_bar.png",
+    },
+    {
+        PACK_HUD_PROGRESS_FILL_ID,
+        "hud/progress_fill.png",
+    },
+};
+
+std::string Assets::_blankImage = "static/packs/blank.png";
+
+Assets::AssetsMap Assets::_assets = {
+    {
+        ASSET_BOSS_1_ID,
+        {
+            ASSET_BOSS_1_WIDTH,
+            ASSET_BOSS_1_HEIGHT,
+            {
+                {
+                    {"Boss_1/idle/0/0.png"},
+                },
+                {
+                    {"Boss_1/move/0/0.png"},
+                },
+                {
+                    {"Boss_1/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Boss_1/die/0/0.png"},
+                    {"Boss_1/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_BOSS_2_ID,
+        {
+            ASSET_BOSS_2_WIDTH,
+            ASSET_BOSS_2_HEIGHT,
+            {
+                {
+                    {"Boss_2/idle/0/0.png"},
+                },
+                {
+                    {"Boss_2/move/0/0.png"},
+                },
+                {
+                    {"Boss_2/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Boss_2/die/0/0.png"},
+                    {"Boss_2/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_BOSS_3_ID,
+        {
+            ASSET_BOSS_3_WIDTH,
+            ASSET_BOSS_3_HEIGHT,
+            {
+                {
+                    {"Boss_3/idle/0/0.png"},
+                },
+                {
+                    {"Boss_3/move/0/0.png"},
+                },
+                {
+                    {"Boss_3/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Boss_3/die/0/0.png"},
+                    {"Boss_3/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_BULLET_ID,
+        {
+            ASSET_BULLET_WIDTH,
+            ASSET_BULLET_HEIGHT,
+            {
+                {
+                    {"Bullet/idle/0/0.png", "Bullet/idle/0/1.png", "Bullet/idle/0/2.png"},
+                },
+                {
+                    {"Bullet/move/0/0.png", "Bullet/move/0/1.png", "Bullet/move/0/2.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_ENEMY_1_ID,
+        {
+            ASSET_ENEMY_1_WIDTH,
+            ASSET_ENEMY_1_HEIGHT,
+            {
+                {
+                    {"Enemy_1/idle/0/0.png"},
+                },
+                {
+                    {"Enemy_1/move/0/0.png"},
+                    {"Enemy_1/move/1/0.png"},
+                },
+                {
+                    {"Enemy_1/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Enemy_1/die/0/0.png"},
+                    {"Enemy_1/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_ENEMY_2_ID,
+        {
+            ASSET_ENEMY_2_WIDTH,
+            ASSET_ENEMY_2_HEIGHT,
+            {
+                {
+                    {"Enemy_2/idle/0/0.png"},
+                },
+                {
+                    {"Enemy_2/move/0/0.png"},
+                    {"Enemy_2/move/1/0.png"},
+                },
+                {
+                    {"Enemy_2/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Enemy_2/die/0/0.png"},
+                    {"Enemy_2/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_ENEMY_3_ID,
+        {
+            ASSET_ENEMY_3_WIDTH,
+            ASSET_ENEMY_3_HEIGHT,
+            {
+                {
+                    {"Enemy_3/idle/0/0.png"},
+                },
+                {
+                    {"Enemy_3/move/0/0.png"},
+                    {"Enemy_3/move/1/0.png"},
+                },
+                {
+                    {"Enemy_3/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Enemy_3/die/0/0.png"},
+                    {"Enemy_3/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_1_LEFT_ID,
+        {
+            ASSET_HENCHMAN_1_LEFT_WIDTH,
+            ASSET_HENCHMAN_1_LEFT_HEIGHT,
+            {
+                {
+                    {"Henchman_1_left/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_1_left/move/0/0.png"},
+                    {"Henchman_1_left/move/1/0.png"},
+                },
+                {
+                    {"Henchman_1_left/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_1_left/die/0/0.png"},
+                    {"Henchman_1_left/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_1_RIGHT_ID,
+        {
+            ASSET_HENCHMAN_1_RIGHT_WIDTH,
+            ASSET_HENCHMAN_1_RIGHT_HEIGHT,
+            {
+                {
+                    {"Henchman_1_right/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_1_right/move/0/0.png"},
+                    {"Henchman_1_right/move/1/0.png"},
+                },
+                {
+                    {"Henchman_1_right/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_1_right/die/0/0.png"},
+                    {"Henchman_1_right/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_2_LEFT_ID,
+        {
+            ASSET_HENCHMAN_2_LEFT_WIDTH,
+            ASSET_HENCHMAN_2_LEFT_HEIGHT,
+            {
+                {
+                    {"Henchman_2_left/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_2_left/move/0/0.png"},
+                    {"Henchman_2_left/move/1/0.png"},
+                },
+                {
+                    {"Henchman_2_left/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_2_left/die/0/0.png"},
+                    {"Henchman_2_left/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_2_RIGHT_ID,
+        {
+            ASSET_HENCHMAN_2_RIGHT_WIDTH,
+            ASSET_HENCHMAN_2_RIGHT_HEIGHT,
+            {
+                {
+                    {"Henchman_2_right/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_2_right/move/0/0.png"},
+                    {"Henchman_2_right/move/1/0.png"},
+                },
+                {
+                    {"Henchman_2_right/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_2_right/die/0/0.png"},
+                    {"Henchman_2_right/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_3_LEFT_ID,
+        {
+            ASSET_HENCHMAN_3_LEFT_WIDTH,
+            ASSET_HENCHMAN_3_LEFT_HEIGHT,
+            {
+                {
+                    {"Henchman_3_left/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_3_left/move/0/0.png"},
+                    {"Henchman_3_left/move/1/0.png"},
+                },
+                {
+                    {"Henchman_3_left/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_3_left/die/0/0.png"},
+                    {"Henchman_3_left/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_3_RIGHT_ID,
+        {
+            ASSET_HENCHMAN_3_RIGHT_WIDTH,
+            ASSET_HENCHMAN_3_RIGHT_HEIGHT,
+            {
+                {
+                    {"Henchman_3_right/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_3_right/move/0/0.png"},
+                    {"Henchman_3_right/move/1/0.png"},
+                },
+                {
+                    {"Henchman_3_right/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_3_right/die/0/0.png"},
+                    {"Henchman_3_right/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_OBSTACLE_1_ID,
+        {
+            ASSET_OBSTACLE_1_WIDTH,
+            ASSET_OBSTACLE_1_HEIGHT,
+            {
+                {
+                    {"Obstacle_1/idle/0/0.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_OBSTACLE_2_ID,
+        {
+            ASSET_OBSTACLE_2_WIDTH,
+            ASSET_OBSTACLE_2_HEIGHT,
+            {
+                {
+                    {"Obstacle_2/idle/0/0.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_OBSTACLE_3_ID,
+        {
+            ASSET_OBSTACLE_3_WIDTH,
+            ASSET_OBSTACLE_3_HEIGHT,
+            {
+                {
+                    {"Obstacle_3/idle/0/0.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_PLAYER_1_ID,
+        {
+            ASSET_PLAYER_1_WIDTH,
+            ASSET_PLAYER_1_HEIGHT,
+            {
+                {
+                    {"Player_1/idle/0/0.png"},
+                },
+                {
+                    {"Player_1/move/0/0.png"},
+                    {"Player_1/move/1/0.png"},
+                },
+                {
+                    {"Player_1/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Player_1/die/0/0.png"},
+                    {"Player_1/die/1/0.png"},
+                },
+                {
+                    {"Player_1/respawn/0/0.png"},
+                    {"Player_1/respawn/1/0.png"},
+                },
+                {
+                    {"Player_1/power_up/0/0.png"},
+                    {"Player_1/power_up/1/0.png"},
+                },
+            },
+        },
+    },
+    {
+        ASSET_PLAYER_2_ID,
+        {
+            ASSET_PLAYER_2_WIDTH,
+            ASSET_PLAYER_2_HEIGHT,
+            {
+                {
+                    {"Player_2/idle/0/0.png"},
+                },
+                {
+                    {"Player_2/move/0/0.png"},
+                    {"Player_2/move/1/0.png"},
+                },
+                {
+                    {"Player_2/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Player_2/die/0/0.png"},
+                    {"Player_2/die/1/0.png"},
+                },
+                {
+                    {"Player_2/respawn/0/0.png"},
+                    {"Player_2/respawn/1/0.png"},
+                },
+                {
+                    {"Player_2/power_up/0/0.png"},
+                    {"Player_2/power_up/1/0.png"},
+                },
+            },
+        },
+    },
+    {
+        ASSET_POWERUP_1_ID,
+        {
+            ASSET_POWERUP_1_WIDTH,
+            ASSET_POWERUP_1_HEIGHT,
+            {
+                {
+                    {"PowerUp_1/idle/0/0.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_POWERUP_2_ID,
+        {
+            ASSET_POWERUP_2_WIDTH,
+            ASSET_POWERUP_2_HEIGHT,
+            {
+                {
+                    {"PowerUp_2/idle/0/0.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_BOSS_1_ID,
+        {
+            ASSET_BOSS_1_WIDTH,
+            ASSET_BOSS_1_HEIGHT,
+            {
+                {
+                    {"Boss_1/idle/0/0.png"},
+                },
+                {
+                    {"Boss_1/move/0/0.png"},
+                },
+                {
+                    {"Boss_1/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Boss_1/die/0/0.png"},
+                    {"Boss_1/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_BOSS_2_ID,
+        {
+            ASSET_BOSS_2_WIDTH,
+            ASSET_BOSS_2_HEIGHT,
+            {
+                {
+                    {"Boss_2/idle/0/0.png"},
+                },
+                {
+                    {"Boss_2/move/0/0.png"},
+                },
+                {
+                    {"Boss_2/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Boss_2/die/0/0.png"},
+                    {"Boss_2/die/1/1.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_BOSS_3_ID,
+        {
+            ASSET_BOSS_3_WIDTH,
+            ASSET_BOSS_3_HEIGHT,
+            {
+                {
+                    {"Boss_3/idle/0/0.png"},
+                },
+                {
+                    {"Boss_3/move/0/0.png"},
+                },
+                {
+                    {"Boss_3/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Boss_3/die/0/0.png"},
+                    {"Boss_3/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_BULLET_ID,
+        {
+            ASSET_BULLET_WIDTH,
+            ASSET_BULLET_HEIGHT,
+            {
+                {
+                    {"Bullet/idle/0/0.png", "Bullet/idle/0/1.png", "Bullet/idle/0/2.png"},
+                },
+                {
+                    {"Bullet/move/0/0.png", "Bullet/move/0/1.png", "Bullet/move/0/2.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_ENEMY_1_ID,
+        {
+            ASSET_ENEMY_1_WIDTH,
+            ASSET_ENEMY_1_HEIGHT,
+            {
+                {
+                    {"Enemy_1/idle/0/0.png"},
+                },
+                {
+                    {"Enemy_1/move/0/0.png"},
+                    {"Enemy_1/move/1/0.png"},
+                },
+                {
+                    {"Enemy_1/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Enemy_1/die/0/0.png"},
+                    {"Enemy_1/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_ENEMY_2_ID,
+        {
+            ASSET_ENEMY_2_WIDTH,
+            ASSET_ENEMY_2_HEIGHT,
+            {
+                {
+                    {"Enemy_2/idle/0/0.png"},
+                },
+                {
+                    {"Enemy_2/move/0/0.png"},
+                    {"Enemy_2/move/1/0.png"},
+                },
+                {
+                    {"Enemy_2/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Enemy_2/die/0/0.png"},
+                    {"Enemy_2/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_ENEMY_3_ID,
+        {
+            ASSET_ENEMY_3_WIDTH,
+            ASSET_ENEMY_3_HEIGHT,
+            {
+                {
+                    {"Enemy_3/idle/0/0.png"},
+                },
+                {
+                    {"Enemy_3/move/0/0.png"},
+                    {"Enemy_3/move/1/0.png"},
+                },
+                {
+                    {"Enemy_3/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Enemy_3/die/0/0.png"},
+                    {"Enemy_3/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_1_LEFT_ID,
+        {
+            ASSET_HENCHMAN_1_LEFT_WIDTH,
+            ASSET_HENCHMAN_1_LEFT_HEIGHT,
+            {
+                {
+                    {"Henchman_1_left/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_1_left/move/0/0.png"},
+                    {"Henchman_1_left/move/1/0.png"},
+                },
+                {
+                    {"Henchman_1_left/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_1_left/die/0/0.png"},
+                    {"Henchman_1_left/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_1_RIGHT_ID,
+        {
+            ASSET_HENCHMAN_1_RIGHT_WIDTH,
+            ASSET_HENCHMAN_1_RIGHT_HEIGHT,
+            {
+                {
+                    {"Henchman_1_right/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_1_right/move/0/0.png"},
+                    {"Henchman_1_right/move/1/0.png"},
+                },
+                {
+                    {"Henchman_1_right/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_1_right/die/0/0.png"},
+                    {"Henchman_1_right/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_2_LEFT_ID,
+        {
+            ASSET_HENCHMAN_2_LEFT_WIDTH,
+            ASSET_HENCHMAN_2_LEFT_HEIGHT,
+            {
+                {
+                    {"Henchman_2_left/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_2_left/move/0/0.png"},
+                    {"Henchman_2_left/move/1/0.png"},
+                },
+                {
+                    {"Henchman_2_left/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_2_left/die/0/0.png"},
+                    {"Henchman_2_left/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_2_RIGHT_ID,
+        {
+            ASSET_HENCHMAN_2_RIGHT_WIDTH,
+            ASSET_HENCHMAN_2_RIGHT_HEIGHT,
+            {
+                {
+                    {"Henchman_2_right/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_2_right/move/0/0.png"},
+                    {"Henchman_2_right/move/1/0.png"},
+                },
+                {
+                    {"Henchman_2_right/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_2_right/die/0/0.png"},
+                    {"Henchman_2_right/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_3_LEFT_ID,
+        {
+            ASSET_HENCHMAN_3_LEFT_WIDTH,
+            ASSET_HENCHMAN_3_LEFT_HEIGHT,
+            {
+                {
+                    {"Henchman_3_left/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_3_left/move/0/0.png"},
+                    {"Henchman_3_left/move/1/0.png"},
+                },
+                {
+                    {"Henchman_3_left/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_3_left/die/0/0.png"},
+                    {"Henchman_3_left/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_HENCHMAN_3_RIGHT_ID,
+        {
+            ASSET_HENCHMAN_3_RIGHT_WIDTH,
+            ASSET_HENCHMAN_3_RIGHT_HEIGHT,
+            {
+                {
+                    {"Henchman_3_right/idle/0/0.png"},
+                },
+                {
+                    {"Henchman_3_right/move/0/0.png"},
+                    {"Henchman_3_right/move/1/0.png"},
+                },
+                {
+                    {"Henchman_3_right/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Henchman_3_right/die/0/0.png"},
+                    {"Henchman_3_right/die/1/0.png"},
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_OBSTACLE_1_ID,
+        {
+            ASSET_OBSTACLE_1_WIDTH,
+            ASSET_OBSTACLE_1_HEIGHT,
+            {
+                {
+                    {"Obstacle_1/idle/0/0.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_OBSTACLE_2_ID,
+        {
+            ASSET_OBSTACLE_2_WIDTH,
+            ASSET_OBSTACLE_2_HEIGHT,
+            {
+                {
+                    {"Obstacle_2/idle/0/0.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_OBSTACLE_3_ID,
+        {
+            ASSET_OBSTACLE_3_WIDTH,
+            ASSET_OBSTACLE_3_HEIGHT,
+            {
+                {
+                    {"Obstacle_3/idle/0/0.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_PLAYER_1_ID,
+        {
+            ASSET_PLAYER_1_WIDTH,
+            ASSET_PLAYER_1_HEIGHT,
+            {
+                {
+                    {"Player_1/idle/0/0.png"},
+                },
+                {
+                    {"Player_1/move/0/0.png"},
+                    {"Player_1/move/1/0.png"},
+                },
+                {
+                    {"Player_1/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Player_1/die/0/0.png"},
+                    {"Player_1/die/1/0.png"},
+                },
+                {
+                    {"Player_1/respawn/0/0.png"},
+                    {"Player_1/respawn/1/0.png"},
+                },
+                {
+                    {"Player_1/power_up/0/0.png"},
+                    {"Player_1/power_up/1/0.png"},
+                },
+            },
+        },
+    },
+    {
+        ASSET_PLAYER_2_ID,
+        {
+            ASSET_PLAYER_2_WIDTH,
+            ASSET_PLAYER_2_HEIGHT,
+            {
+                {
+                    {"Player_2/idle/0/0.png"},
+                },
+                {
+                    {"Player_2/move/0/0.png"},
+                    {"Player_2/move/1/0.png"},
+                },
+                {
+                    {"Player_2/shoot/0/0.png"},
+                },
+                {
+                },
+                {
+                    {"Player_2/die/0/0.png"},
+                    {"Player_2/die/1/0.png"},
+                },
+                {
+                    {"Player_2/respawn/0/0.png"},
+                    {"Player_2/respawn/1/0.png"},
+                },
+                {
+                    {"Player_2/power_up/0/0.png"},
+                    {"Player_2/power_up/1/0.png"},
+                },
+            },
+        },
+    },
+    {
+        ASSET_POWERUP_1_ID,
+        {
+            ASSET_POWERUP_1_WIDTH,
+            ASSET_POWERUP_1_HEIGHT,
+            {
+                {
+                    {"PowerUp_1/idle/0/0.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+    {
+        ASSET_POWERUP_2_ID,
+        {
+            ASSET_POWERUP_2_WIDTH,
+            ASSET_POWERUP_2_HEIGHT,
+            {
+                {
+                    {"PowerUp_2/idle/0/0.png"},
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+                {
+                },
+            },
+        },
+    },
+};
+
+void Assets::setPack(int pack) {
+  _currentPack = pack < _pack.size() ? pack : 0;
+}
+
+int Assets::getCurrentPack() {
+  return _currentPack;
+}
+
+std::string Assets::getAudio(int id) {
+  std::string path = _pack[_currentPack] + _audios[id][rand() % _audios[id].size()];
+  if (access(path.c_str(), F_OK) == -1) return _blankAudio;
+  return path;
+}
+
+std::string Assets::getFile(int id) {
+  std::string path = _pack[_currentPack] + _files[id];
+  if (access(path.c_str(), F_OK) == -1) return _blankImage;
+  return path;
+}
+
+std::vector<Sprite>& Assets::getEditableEntities(std::vector<Sprite>& dest) {
+  for (const auto& e: _assets) {
+    switch (e.first >> ASSET_LEN_SID) {
+      case ASSET_OBSTACLE_TYPE:
+      case ASSET_ENEMY_TYPE:
+      case ASSET_BOSS_TYPE:
+        dest.push_back({e.first, std::get<0>(e.second), std::get<1>(e.second), _pack[_currentPack] + "assets/" + std::get<2>(e.second)[IDLE_STATE][0][0]});
+        break;
+    }
+  }
+  return dest;
+}
+
+Sprite Assets::getSprite(unsigned id, int state, int stateStep, int variant) {
+  int width = std::get<0>(_assets.at(id));
+  int height = std::get<1>(_assets.at(id));
+
+  std::vector<std::vector<std::vector<std::string>>> spriteStates = std::get<2>(_assets.at(id));
+
+  if (state >= spriteStates.size()) return {id, width, height, _blankImage};
+  std::vector<std::vector<std::string>> spriteSateSteps = spriteStates[state];
+
+  if (spriteSateSteps.size() == 0) {
+      spriteSateSteps = spriteStates[0];
+  }
+  if (stateStep >= spriteSateSteps.size()) stateStep %= spriteSateSteps.size();
+  std::vector<std::string> spriteVariant = spriteSateSteps[stateStep];
+
+  if (variant >> ASSET_LEN_SID == ASSET_POWERUP_TYPE) variant = (variant % ASSET_LEN_SID) + 1;
+  if (variant >= spriteVariant.size()) variant = 0;
+
+  return {id, width, height, _pack[_currentPack] + "assets/" + spriteVariant[variant]};
+}
+
+std::tuple<int, int> Assets::getSpriteSize(unsigned id) {
+  int width = std::get<0>(_assets.at(id));
+  int height = std::get<1>(_assets.at(id));
+  return {width, height};
+}
\ No newline at end of file
@@ -127,12 +127,12 @@ int Game::getInput(int nPlayer) {
   return input;
 }
 
-void Game::updateGameState(unsigned progress, const unsigned score[2], const double hpPlayers[2]) {
+void Game::updateGameState(unsigned progress, const std::vector<PlayerFrame>& players) {
   _progress = progress;
-  _score[0] = score[0];
-  _score[1] = score[1];
-  _hpPlayers[0] = hpPlayers[0];
-  _hpPlayers[1] = hpPlayers[1];
+  for (std::size_t p = 0; p != LOCAL_PLAYERS; ++p) {
+    _score[p] = (p < players.size()) ? players[p].score : 0;
+    _hpPlayers[p] = (p < players.size()) ? players[p].hp : 0;
+  }
 }
 
 void Game::_clearTextures() {
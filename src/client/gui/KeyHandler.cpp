@@ -22,16 +22,14 @@ bool KeyHandler::_isValidKey(int key) {
 }
 
 void KeyHandler::press(int key) noexcept {
-  bool nPlayer = key & 1;
-  if (_isValidKey(key >> 1)) {
-    _keyPressState[key >> 1][key & 1] = true;
+  if (_isValidKey(inputKey(key))) {
+    _keyPressState[inputKey(key)][inputPlayer(key)] = true;
   }
 }
 
 void KeyHandler::unpress(int key) noexcept {
-  bool nPlayer = key & 1;
-  if (_isValidKey(key >> 1)) {
-    _keyPressState[key >> 1][key & 1] = false;
+  if (_isValidKey(inputKey(key))) {
+    _keyPressState[inputKey(key)][inputPlayer(key)] = false;
   }
 }
 
@@ -45,7 +43,7 @@ int KeyHandler::getPressedKeys(bool nPlayer) noexcept {
   _lastInputTime = getTimestamp();
 
   if (sum) {
-    return (sum << 1) + nPlayer;
+    return gameInput(sum, nPlayer);
   } else {
     return INVALID_KEY;
   }
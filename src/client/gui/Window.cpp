@@ -145,11 +145,11 @@ void Window::initGame(const Activity::Mapping& userMapping) {
   Mix_FadeOutChannel(PACK_AUDIO_MENU_ID, AUDIO_TRANSITION);
 }
 
-void Window::refreshGame(const RefreshFrame& refreshFrame, const std::vector<EntityFrame>& entities) {
+void Window::refreshGame(const RefreshFrame& refreshFrame, const std::vector<PlayerFrame>& players, const std::vector<EntityFrame>& entities) {
   Game* game;
   if (!(game = dynamic_cast<Game*>(_currentActivity))) throw FatalError("There is no active game.");
 
-  game->updateGameState(refreshFrame.progress, refreshFrame.score, refreshFrame.hpPlayers);
+  game->updateGameState(refreshFrame.progress, players);
   game->clearEntities();
 
   unsigned levelProgress = 100 * (refreshFrame.progress % (FRAMES_BY_LEVEL + 1)) / FRAMES_BY_LEVEL;
@@ -0,0 +1,84 @@
+#include "server/ChannelManager.hpp"
+
+#include <signal.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "constants.hpp"
+
+constexpr std::chrono::seconds ChannelManager::GC_PERIOD;
+
+ChannelManager::ChannelManager(MessageExchanger& messageExchanger, const ErrorHandler& errorHandler) noexcept
+    : _messageExchanger(messageExchanger), _errorHandler(errorHandler) {}
+
+ChannelManager::~ChannelManager() noexcept {
+  stop();
+}
+
+void ChannelManager::start() {
+  if (_thread.joinable()) return;
+  _stopping = false;
+  _thread = std::thread(&ChannelManager::_run, this);
+}
+
+void ChannelManager::stop() noexcept {
+  if (!_thread.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+  }
+  _wakeUp.notify_one();
+  _thread.join();
+}
+
+void ChannelManager::_run() noexcept {
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (!_wakeUp.wait_for(lock, GC_PERIOD, [this]() { return _stopping; })) {
+    lock.unlock();
+    try {
+      if (std::size_t removed = collect()) {
+        _errorHandler.logMessage(std::to_string(removed) + " channels of gone clients removed");
+      }
+    } catch (std::exception& err) {
+      _errorHandler.handleError(err);
+    }
+    lock.lock();
+  }
+}
+
+pid_t ChannelManager::clientOf(const std::string& channel) noexcept {
+  std::size_t digits = 0;
+  while (digits != channel.size() && channel[digits] >= '0' && channel[digits] <= '9') {
+    ++digits;
+  }
+  if (digits == 0 || digits > 9) return 0;
+  if (digits != channel.size() && channel.compare(digits, std::string::npos, GAME_CHANNEL_SUFFIX) != 0) return 0;
+  return pid_t(std::stol(channel.substr(0, digits)));
+}
+
+std::size_t ChannelManager::collect() {
+  // Channels whose client exited are gone from the directory, but the server may still have them open
+  std::vector<std::string> channels;
+  _messageExchanger.listChannels(channels);
+  _messageExchanger.listOpenChannels(channels);
+  std::sort(channels.begin(), channels.end());
+  channels.erase(std::unique(channels.begin(), channels.end()), channels.end());
+
+  // Only the channels left in the directory were left behind
+  std::size_t removed = 0;
+  for (const std::string& channel: channels) {
+    pid_t client = clientOf(channel);
+    if (client <= 0 || kill(client, 0) == 0 || errno != ESRCH) continue;
+
+    removed += _messageExchanger.removeChannel(channel);
+  }
+  _collected.fetch_add(removed, std::memory_order_relaxed);
+  return removed;
+}
+
+unsigned long ChannelManager::collected() const noexcept {
+  return _collected.load(std::memory_order_relaxed);
+}
@@ -8,18 +8,25 @@
 
 #include "server/CommunicationAPI.hpp"
 
+#include <unistd.h>
+
+#include <cstring>
+
 #include "Error.hpp"
 #include "Message.hpp"
+#include "server/FrameRing.hpp"
 #include "server/MessageExchanger.hpp"
+#include "utils.hpp"
 
 /* Global variable: prevent the user of the `CommunicationAPI` to access the `MessageExchanger`
  *  class from the header.
  */
 MessageExchanger messageExchanger;
 
-CommunicationAPI::CommunicationAPI() noexcept: _channel(std::to_string(getpid())) {
-  messageExchanger.openChannel(_channel);
-
+CommunicationAPI::CommunicationAPI() noexcept
+    : _session(messageExchanger.getChannel(std::to_string(getpid()))),
+      _channel(_session),
+      _gameInput(messageExchanger.getChannel("gameInput")) {
   messageExchanger.openChannel("connectClient");
   messageExchanger.openChannel("connectPlayer");
   messageExchanger.openChannel("disconnectPlayer");
@@ -32,8 +39,8 @@ CommunicationAPI::CommunicationAPI() noexcept: _channel(std::to_string(getpid())
   messageExchanger.openChannel("packKey");
 
   messageExchanger.openChannel("newGame");
-  messageExchanger.openChannel("gameInput");
   messageExchanger.openChannel("stopGame");
+  messageExchanger.openChannel("spectateGame");
 
   messageExchanger.openChannel("levelRequest");
   messageExchanger.openChannel("rateLevel");
@@ -41,10 +48,17 @@ CommunicationAPI::CommunicationAPI() noexcept: _channel(std::to_string(getpid())
   messageExchanger.openChannel("sandboxEdition");
   messageExchanger.openChannel("getLvlProgress");
   messageExchanger.openChannel("stopSandbox");
+
+  messageExchanger.openChannel("serverStats");
 }
 
 CommunicationAPI::~CommunicationAPI() noexcept {
-  messageExchanger.closeChannel(_channel);
+  // The channels of the client are only used by it, the server collects them if it crashes
+  try {
+    messageExchanger.removeChannel(_session->name());
+    messageExchanger.removeChannel(_session->name() + GAME_CHANNEL_SUFFIX);
+  } catch (std::exception&) {
+  }
 
   messageExchanger.closeChannel("connectClient");
   messageExchanger.closeChannel("connectPlayer");
@@ -60,6 +74,7 @@ CommunicationAPI::~CommunicationAPI() noexcept {
   messageExchanger.closeChannel("newGame");
   messageExchanger.closeChannel("gameInput");
   messageExchanger.closeChannel("stopGame");
+  messageExchanger.closeChannel("spectateGame");
 
   messageExchanger.closeChannel("levelRequest");
   messageExchanger.closeChannel("rateLevel");
@@ -67,12 +82,18 @@ CommunicationAPI::~CommunicationAPI() noexcept {
   messageExchanger.closeChannel("sandboxEdition");
   messageExchanger.closeChannel("getLvlProgress");
   messageExchanger.closeChannel("stopSandbox");
+
+  messageExchanger.closeChannel("serverStats");
 }
 
 std::string CommunicationAPI::getUsername() const noexcept {
   return _token.getUsername();
 }
 
+std::string CommunicationAPI::getGameID() const noexcept {
+  return _token.getActivityID();
+}
+
 std::string CommunicationAPI::getGuestUsername() const noexcept {
   return _token.getGuestUsername();
 }
@@ -85,7 +106,7 @@ template<typename Data>
 Data CommunicationAPI::_read(std::size_t nData) const {
   Data* dataPtr = static_cast<Data*>(malloc(sizeof(Data) * nData));
 
-  if (!messageExchanger.readMessage(dataPtr, _channel, nData)) {
+  if (std::size_t(_channel->read(dataPtr, nData)) != sizeof(Data) * nData) {
     free(dataPtr);
     throw FatalError("Could not communicate with the server");
   }
@@ -99,7 +120,7 @@ template<typename Data>
 std::vector<Data>& CommunicationAPI::_read(std::vector<Data>& dest, std::size_t nData) const {
   Data* dataPtr = static_cast<Data*>(malloc(sizeof(Data) * nData));
 
-  if (!messageExchanger.readMessage(dataPtr, _channel, nData)) {
+  if (std::size_t(_channel->read(dataPtr, nData)) != sizeof(Data) * nData) {
     free(dataPtr);
     throw FatalError("Could not communicate with the server");
   }
@@ -118,9 +139,9 @@ ClientInfo CommunicationAPI::_login(const std::string& username, const std::stri
   }
 
   if (_token.isEmpty()) {
-    messageExchanger.writeMessage("connectClient", Handshake(SYN{username, password, _channel, signup}));
+    messageExchanger.writeMessage("connectClient", Handshake(SYN{username, password, _session->name(), signup}));
   } else {
-    messageExchanger.writeMessage("connectPlayer", Message<SYN>(_token, {username, password, _channel, signup}));
+    messageExchanger.writeMessage("connectPlayer", Message<SYN>(_token, {username, password, _session->name(), signup}));
   }
 
   using Response = Message<ClientInfo>;
@@ -134,9 +155,6 @@ ClientInfo CommunicationAPI::_login(const std::string& username, const std::stri
     }
 
     _token = response.getToken();
-    messageExchanger.closeChannel(_channel);
-    _channel = _token.getSignature();
-    messageExchanger.openChannel(_channel);
   }
 
   return response.getData();
@@ -152,7 +170,7 @@ ClientInfo CommunicationAPI::signUp(const std::string& username, const std::stri
 
 void CommunicationAPI::signOut() noexcept {
   _token = Token();
-  _channel = std::to_string(getpid());
+  _channel = _session;
 }
 
 void CommunicationAPI::removeSecondPlayer() {
@@ -168,9 +186,6 @@ void CommunicationAPI::removeSecondPlayer() {
   if (response.getData()) {
     _secondPlayer = true;
     _token = response.getToken();
-    messageExchanger.closeChannel(_channel);
-    _channel = _token.getSignature();
-    messageExchanger.openChannel(_channel);
   }
 }
 
@@ -235,11 +250,12 @@ bool CommunicationAPI::createGame(const GameSettings& settings) {
   using Response = Message<bool>;
   Response response = _read<Response>();
 
+  // Frames are read on their own channel, so that responses never mix with them
   if (response.getData()) {
     _token = response.getToken();
-    messageExchanger.closeChannel(_channel);
-    _channel = _token.getSignature();
-    messageExchanger.openChannel(_channel);
+    _channel = messageExchanger.getChannel(_token.getGameChannel());
+    _inputLatency.reset();
+    _lastInputSent = getMonotonicTimestamp();
   }
 
   return response.getData();
@@ -249,17 +265,27 @@ void CommunicationAPI::sendGameInput(int key) const {
   if (_token.getActivityID().empty()) {
     throw FatalError("Not connected to a game");
   }
+  long now = getMonotonicTimestamp();
+  if (key == INVALID_KEY) {
+    if ((now - _lastInputSent) / 1000000 <= CLIENT_TIMEOUT - 5) return;
+    key = EMPTY_KEY;
+  }
+  _lastInputSent = now;
 
-  messageExchanger.writeMessage("gameInput", Message<int>(_token, key));
+  _gameInput->write(Message<GameInput>(_token, {key, _inputLatency.send()}));
 }
 
-RefreshFrame CommunicationAPI::getGameState(std::vector<EntityFrame>& dest) const {
+RefreshFrame CommunicationAPI::getGameState(std::vector<PlayerFrame>& players, std::vector<EntityFrame>& dest) const {
   if (_token.getActivityID().empty()) {
     throw FatalError("Not connected");
   }
 
   RefreshFrame gameState = _read<RefreshFrame>();
 
+  if (gameState.nbPlayers != 0) {
+    _read<PlayerFrame>(players, gameState.nbPlayers);
+  }
+
   std::size_t nData = gameState.nbEntities;
   if (nData != 0) {
     _read<EntityFrame>(dest, nData);
@@ -273,23 +299,69 @@ void CommunicationAPI::quitGame() {
     throw FatalError("Not connected to a game");
   }
 
-  std::string responseChannel = std::to_string(getpid());
-  messageExchanger.closeChannel(_channel);
-  _channel = responseChannel;
-  messageExchanger.openChannel(responseChannel);
-  messageExchanger.writeMessage("stopGame", Message<Channel>(_token, {responseChannel}));
+  _channel = _session;
+  messageExchanger.writeMessage("stopGame", Message<bool>(_token, true));
 
   using Response = Message<bool>;
   Response response = _read<Response>();
-  messageExchanger.closeChannel(responseChannel);
-
   _token = response.getToken();
-  _channel = _token.getSignature();
-  messageExchanger.openChannel(_channel);
 
   _secondPlayer = false;
 }
 
+InputLatency& CommunicationAPI::inputLatency() noexcept {
+  return _inputLatency;
+}
+
+bool CommunicationAPI::spectateGame(const std::string& gameID) {
+  if (_token.isEmpty()) {
+    throw FatalError("Not connected");
+  }
+
+  messageExchanger.writeMessage("spectateGame", Message<SpectateRequest>(_token, SpectateRequest(gameID)));
+
+  if (!_read<bool>()) {
+    return false;
+  }
+  _spectated = std::make_shared<FrameRing>(gameID, false);
+  return true;
+}
+
+bool CommunicationAPI::getSpectatedState(RefreshFrame& gameState, std::vector<PlayerFrame>& players, std::vector<EntityFrame>& dest) {
+  if (!_spectated) {
+    throw FatalError("Not spectating a game");
+  }
+
+  // The ring is checked for closing before it is read, not to miss the last frame
+  bool closed = false;
+  while (!_spectated->read(_spectatedFrame)) {
+    if (closed) return false;
+    closed = _spectated->closed();
+    if (!closed) {
+      usleep(SPECTATOR_POLL);
+    }
+  }
+
+  // Frames are laid out as they are sent to the players
+  const unsigned char* frame = _spectatedFrame.data();
+  std::memcpy(&gameState, frame, sizeof(RefreshFrame));
+  frame += sizeof(RefreshFrame);
+  players.resize(gameState.nbPlayers);
+  std::memcpy(players.data(), frame, sizeof(PlayerFrame) * gameState.nbPlayers);
+  frame += sizeof(PlayerFrame) * gameState.nbPlayers;
+  dest.resize(gameState.nbEntities);
+  std::memcpy(dest.data(), frame, sizeof(EntityFrame) * gameState.nbEntities);
+  return true;
+}
+
+unsigned long CommunicationAPI::spectatedSkips() const noexcept {
+  return (_spectated) ? _spectated->skipped() : 0;
+}
+
+void CommunicationAPI::stopSpectating() noexcept {
+  _spectated = nullptr;
+}
+
 void CommunicationAPI::rateLevel(int lvlID, unsigned rating) const {
   if (_token.isEmpty()) {
     throw FatalError("Not connected");
@@ -326,9 +398,6 @@ bool CommunicationAPI::createSandbox(const SandboxSettings& settings) {
 
   if (response.getData()) {
     _token = response.getToken();
-    messageExchanger.closeChannel(_channel);
-    _channel = _token.getSignature();
-    messageExchanger.openChannel(_channel);
   }
 
   return response.getData();
@@ -362,19 +431,11 @@ void CommunicationAPI::quitSandbox() {
     throw FatalError("Not connected");
   }
 
-  std::string responseChannel = std::to_string(getpid());
-  messageExchanger.closeChannel(_channel);
-  _channel = responseChannel;
-  messageExchanger.openChannel(responseChannel);
-  messageExchanger.writeMessage("stopSandbox", Message<Channel>(_token, {responseChannel}));
+  messageExchanger.writeMessage("stopSandbox", Message<bool>(_token, true));
 
   using Response = Message<bool>;
   Response response = _read<Response>();
-  messageExchanger.closeChannel(responseChannel);
-
   _token = response.getToken();
-  _channel = _token.getSignature();
-  messageExchanger.openChannel(_channel);
 }
 
 std::vector<Pack>& CommunicationAPI::getPacks(std::vector<Pack>& dest, const std::string& username) {
@@ -436,3 +497,20 @@ void CommunicationAPI::removePackKey(const std::string& key) {
 
   messageExchanger.writeMessage("packKey", Message<PackKeyRequest>(_token, PackKeyRequest(3, key)));
 }
+
+bool CommunicationAPI::getServerStats(ServerStats& stats, std::vector<ChannelStats>& channels) const {
+  if (_token.isEmpty()) {
+    throw FatalError("Not connected");
+  }
+
+  messageExchanger.writeMessage("serverStats", Message<bool>(_token, true));
+
+  if (!_read<bool>()) {
+    return false;
+  }
+  stats = _read<ServerStats>();
+  if (stats.nbChannels != 0) {
+    _read<ChannelStats>(channels, stats.nbChannels);
+  }
+  return true;
+}
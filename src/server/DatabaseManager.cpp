@@ -3,6 +3,7 @@
 #include <sqlite3.h>
 #include <sys/stat.h>
 
+#include <chrono>
 #include <fstream>
 
 #include "Error.hpp"
@@ -10,6 +11,9 @@
 #include "server/utils.hpp"
 #include "utils.hpp"
 
+// Levels of the campaign are the ones created by this user
+const std::string CAMPAIGN_CREATOR = "tijl";
+
 template<typename FirstArg, typename... Args>
 bool bindToStmt(sqlite3_stmt*, unsigned int, const FirstArg&, const Args&...) noexcept;
 
@@ -38,6 +42,7 @@ DatabaseManager::DatabaseManager(const std::string& dbPath) {
   if (sqlite3_open(dbPath.c_str(), &_db) != SQLITE_OK) {
     throw FatalError("Could not open the database");
   }
+  sqlite3_trace_v2(_db, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE, &DatabaseManager::_profileQuery, this);
 
   if (!newDatabase) return;
 }
@@ -46,6 +51,27 @@ DatabaseManager::~DatabaseManager() noexcept {
   sqlite3_close(_db);
 }
 
+int DatabaseManager::_profileQuery(unsigned type, void* databaseManager, void*, void*) {
+  // The duration given by SQLite only has a resolution of a millisecond, queries are timed here instead.
+  // Statements of a thread run one after another, from their first step to their reset
+  thread_local std::chrono::steady_clock::time_point start = {};
+  thread_local bool running = false;
+
+  if (type == SQLITE_TRACE_STMT && !running) {
+    running = true;
+    start = std::chrono::steady_clock::now();
+  } else if (type == SQLITE_TRACE_PROFILE && running) {
+    running = false;
+    static_cast<DatabaseManager*>(databaseManager)->_queryTimes.record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+  return 0;
+}
+
+const Histogram& DatabaseManager::queryTimes() const noexcept {
+  return _queryTimes;
+}
+
 template<typename FirstArg, typename... Args>
 bool DatabaseManager::_bindData(sqlite3_stmt* stmt, const FirstArg& firstData, const Args&... otherData) const noexcept {
   return bindToStmt(stmt, 1, firstData, otherData...);
@@ -712,6 +738,10 @@ LevelInfo DatabaseManager::getLevelInfo(int id) const {
   return LevelInfo(id, creator, name, rate, date);
 }
 
+std::vector<LevelInfo>& DatabaseManager::getCampaign(std::vector<LevelInfo>& dest) {
+  return getLevels(dest, -1, 0, CAMPAIGN_CREATOR);
+}
+
 std::vector<LevelInfo>& DatabaseManager::getLevels(std::vector<LevelInfo>& dest, int nbEntries, int offset, const std::string& username) {
   sqlite3_stmt* stmt;
 
@@ -796,7 +826,7 @@ std::vector<LevelInfo>& DatabaseManager::getLevels(std::vector<LevelInfo>& dest,
   return dest;
 }
 
-std::map<unsigned, std::vector<EntityInfo>>& DatabaseManager::populateLevel(std::map<unsigned, std::vector<EntityInfo>>& level, int levelID) {
+Level& DatabaseManager::populateLevel(Level& level, int levelID) {
   sqlite3_stmt* stmt;
 
   std::string sqlQuery = "SELECT progress, entity, xPos, yPos, xSize, ySize, xVelocity, yVelocity FROM level_entities WHERE level = ? ORDER BY progress";
@@ -832,6 +862,41 @@ std::map<unsigned, std::vector<EntityInfo>>& DatabaseManager::populateLevel(std:
   return level;
 }
 
+LevelPatterns& DatabaseManager::populatePatterns(LevelPatterns& patterns, int levelID) {
+  sqlite3_stmt* stmt;
+
+  // Databases created before the table existed have no level patterns
+  std::string sqlQuery = "SELECT entity, steps FROM level_patterns WHERE level = ?";
+  if (sqlite3_prepare_v2(_db, sqlQuery.c_str(), -1, &stmt, NULL) != SQLITE_OK) {
+    return patterns;
+  }
+
+  if (!_bindData(stmt, levelID)) {
+    sqlite3_finalize(stmt);
+    throw Error(sqlite3_errmsg(_db));
+  }
+
+  int rc;
+  while ((rc = sqlite3_step(stmt)) != SQLITE_DONE) {
+    if (rc != SQLITE_ROW) {
+      sqlite3_finalize(stmt);
+      throw Error(sqlite3_errmsg(_db));
+    }
+
+    unsigned entity = unsigned(sqlite3_column_int(stmt, 0));
+    const unsigned char* steps = sqlite3_column_text(stmt, 1);
+    try {
+      patterns[entity] = parseMoveSteps(steps ? reinterpret_cast<const char*>(steps) : "");
+    } catch (const Error&) {
+      sqlite3_finalize(stmt);
+      throw;
+    }
+  }
+
+  sqlite3_finalize(stmt);
+  return patterns;
+}
+
 std::vector<EntityInfo>& DatabaseManager::populateLevel(std::vector<EntityInfo>& level, int id, unsigned progress) {
   sqlite3_stmt* stmt;
 
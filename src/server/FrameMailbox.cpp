@@ -0,0 +1,55 @@
+#include "server/FrameMailbox.hpp"
+
+#include "constants.hpp"
+#include "utils.hpp"
+
+FrameMailbox::FrameMailbox(ChannelPtr channel, std::shared_ptr<FrameRing> spectators, std::atomic<unsigned long>& droppedFrames)
+    : _channel(channel), _spectators(spectators), _droppedFrames(droppedFrames) {
+  _channel->setNonBlocking();
+}
+
+bool FrameMailbox::_writeRest() {
+  if (!_rest.empty()) {
+    _rest.erase(_rest.begin(), _rest.begin() + long(_channel->tryWriteBytes(_rest.data(), _rest.size())));
+  }
+  return _rest.empty();
+}
+
+void FrameMailbox::_write(const FrameArena& frame) {
+  // The last frame written is at the end of the pipe, the client started reading it once less is left
+  std::size_t written = 0;
+  if (_writeRest() && _channel->unread() < _lastSize) {
+    written = _channel->tryWriteBytes(frame.data(), frame.size());
+  }
+  if (written == 0) {
+    if (!_pending) {
+      _pending = true;
+      _waitingSince = getMonotonicTimestamp();
+    }
+    return;
+  }
+
+  // The client reads frames whole, the end of the frame is written before anything else
+  _rest.assign(frame.data() + written, frame.data() + frame.size());
+  _lastSize = frame.size();
+  _pending = false;
+}
+
+void FrameMailbox::post(const FrameArena& frame) {
+  _spectators->publish(frame.data(), frame.size());
+  if (_pending) {
+    _droppedFrames.fetch_add(1, std::memory_order_relaxed);
+  }
+  _write(frame);
+}
+
+bool FrameMailbox::flush(const FrameArena& frame) {
+  if (_pending) {
+    _write(frame);
+  }
+  return !_pending && _writeRest();
+}
+
+bool FrameMailbox::stalled(long now) const noexcept {
+  return _pending && (now - _waitingSince) / 1000000 >= CLIENT_TIMEOUT;
+}
@@ -0,0 +1,137 @@
+#include "server/FrameRing.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <new>
+
+#include "Error.hpp"
+
+constexpr std::size_t FrameRing::SIZE;
+constexpr unsigned long FrameRing::SLOTS;
+
+FrameRing::FrameRing(const std::string& gameID, bool writer): _name("/l-type-" + gameID), _writer(writer) {
+  if (_writer) return;
+
+  int fd = shm_open(_name.c_str(), O_RDONLY, 0);
+  if (fd == -1) {
+    throw Error("No spectated game " + gameID);
+  }
+  // Spectators can not write in the ring, hence slow down the game
+  void* region = mmap(nullptr, sizeof(Header) + SIZE, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (region == MAP_FAILED) {
+    throw Error("Error while mapping the frames of the game " + gameID);
+  }
+  Header* header = static_cast<Header*>(region);
+  unsigned long published = header->published.load(std::memory_order_acquire);
+  _cursor = (published != 0) ? published - 1 : 0;
+  _header.store(header, std::memory_order_release);
+}
+
+FrameRing::~FrameRing() noexcept {
+  Header* header = _header.load(std::memory_order_acquire);
+  if (!header) return;
+
+  // Spectators keep their mapping, they stop once they read the last frame
+  if (_writer) {
+    header->closed.store(true, std::memory_order_release);
+    shm_unlink(_name.c_str());
+  }
+  munmap(header, sizeof(Header) + SIZE);
+}
+
+unsigned char* FrameRing::_data() const noexcept {
+  return reinterpret_cast<unsigned char*>(_header.load(std::memory_order_relaxed)) + sizeof(Header);
+}
+
+void FrameRing::open() {
+  std::lock_guard<std::mutex> lock(_openMutex);
+  if (!_writer || _header.load(std::memory_order_relaxed)) return;
+
+  int fd = shm_open(_name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+  if (fd == -1) {
+    throw Error("Error while creating the frames of the spectators " + _name);
+  }
+  if (ftruncate(fd, off_t(sizeof(Header) + SIZE)) == -1) {
+    ::close(fd);
+    shm_unlink(_name.c_str());
+    throw Error("Error while creating the frames of the spectators " + _name);
+  }
+  void* region = mmap(nullptr, sizeof(Header) + SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (region == MAP_FAILED) {
+    shm_unlink(_name.c_str());
+    throw Error("Error while mapping the frames of the spectators " + _name);
+  }
+  // The memory is zeroed by ftruncate, which is the empty ring
+  _header.store(new (region) Header, std::memory_order_release);
+}
+
+void FrameRing::publish(const void* frame, std::size_t size) noexcept {
+  Header* header = _header.load(std::memory_order_acquire);
+  if (!header || size > SIZE) return;
+
+  // A frame is never split, it starts over at the beginning of the ring if it does not fit at the end
+  unsigned long position = _reserved;
+  if (position % SIZE + size > SIZE) {
+    position += SIZE - position % SIZE;
+  }
+  _reserved = position + size;
+  header->reserved.store(_reserved, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(_data() + position % SIZE, frame, size);
+
+  Slot& slot = header->slots[++_published % SLOTS];
+  slot.frame.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.position.store(position, std::memory_order_relaxed);
+  slot.size.store(size, std::memory_order_relaxed);
+  slot.frame.store(_published, std::memory_order_release);
+  header->published.store(_published, std::memory_order_release);
+}
+
+bool FrameRing::_copy(unsigned long frame, std::vector<unsigned char>& dest) const {
+  const Header* header = _header.load(std::memory_order_relaxed);
+  const Slot& slot = header->slots[frame % SLOTS];
+  if (slot.frame.load(std::memory_order_acquire) != frame) return false;
+  unsigned long position = slot.position.load(std::memory_order_relaxed);
+  unsigned long size = slot.size.load(std::memory_order_relaxed);
+  // The slot may be rewritten meanwhile, a position and a size of different frames may not fit in the ring
+  if (size > SIZE || position % SIZE + size > SIZE) return false;
+
+  dest.resize(size);
+  std::memcpy(dest.data(), _data() + position % SIZE, size);
+
+  // The copy is only valid if neither the slot nor the bytes were written meanwhile
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.frame.load(std::memory_order_relaxed) == frame
+         && header->reserved.load(std::memory_order_relaxed) - position <= SIZE;
+}
+
+bool FrameRing::read(std::vector<unsigned char>& dest) {
+  const Header* header = _header.load(std::memory_order_relaxed);
+  unsigned long published = header->published.load(std::memory_order_acquire);
+  if (published == _cursor) return false;
+
+  // A frame overwritten while it is copied is retried once on the newest one, then left to the next read
+  unsigned long frame = (published - _cursor > SLOTS / 2) ? published : _cursor + 1;
+  if (!_copy(frame, dest)) {
+    frame = header->published.load(std::memory_order_acquire);
+    if (!_copy(frame, dest)) return false;
+  }
+  _skipped += frame - _cursor - 1;
+  _cursor = frame;
+  return true;
+}
+
+bool FrameRing::closed() const noexcept {
+  const Header* header = _header.load(std::memory_order_relaxed);
+  return header && header->closed.load(std::memory_order_acquire);
+}
+
+unsigned long FrameRing::skipped() const noexcept {
+  return _skipped;
+}
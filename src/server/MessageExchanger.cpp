@@ -1,21 +1,91 @@
 #include "server/MessageExchanger.hpp"
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "Error.hpp"
 #include "GameSettings.hpp"
 
 const std::string MessageExchanger::PIPE_DIR = "/tmp/l-type/";
 
-MessageExchanger::~MessageExchanger() noexcept {
-  ThreadsMap::iterator it = _listeningThreads.begin();
-  while (it != _listeningThreads.end()) {
-    stopListening(it->first);
+ChannelHandle::ChannelHandle(const std::string& name, int fd) noexcept: _name(name), _fd(fd) {}
+
+ChannelHandle::~ChannelHandle() noexcept {
+  close(_fd);
+}
+
+const std::string& ChannelHandle::name() const noexcept {
+  return _name;
+}
+
+void ChannelHandle::writeBytes(const void* data, std::size_t size) {
+  if (::write(_fd, data, size) == -1) {
+    throw Error("Error while writing a message on the pipe " + _name);
+  }
+  _bytesWritten.fetch_add(size, std::memory_order_relaxed);
+}
+
+std::size_t ChannelHandle::tryWriteBytes(const void* data, std::size_t size) {
+  ssize_t n = ::write(_fd, data, size);
+  if (n == -1) {
+    if (errno == EAGAIN) return 0;
+    throw Error("Error while writing a message on the pipe " + _name);
+  }
+  _bytesWritten.fetch_add(std::size_t(n), std::memory_order_relaxed);
+  return std::size_t(n);
+}
+
+void ChannelHandle::setNonBlocking() {
+  int flags = fcntl(_fd, F_GETFL);
+  if (flags == -1 || fcntl(_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+    throw Error("Error while setting the pipe " + _name + " non-blocking");
+  }
+}
+
+std::size_t ChannelHandle::unread() const {
+  int n;
+  if (ioctl(_fd, FIONREAD, &n) == -1) {
+    throw Error("Error while reading the size of the pipe " + _name);
   }
+  return std::size_t(n);
+}
+
+
+std::size_t ChannelHandle::drain() {
+  int flags = fcntl(_fd, F_GETFL);
+  if (flags == -1 || fcntl(_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+    throw Error("Error while draining the pipe " + _name);
+  }
+
+  std::size_t drained = 0;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = ::read(_fd, buffer, sizeof(buffer))) > 0) {
+    drained += std::size_t(n);
+  }
+  fcntl(_fd, F_SETFL, flags);
+  return drained;
+}
+
+unsigned long ChannelHandle::messagesRead() const noexcept {
+  return _messagesRead.load(std::memory_order_relaxed);
+}
+
+unsigned long ChannelHandle::bytesRead() const noexcept {
+  return _bytesRead.load(std::memory_order_relaxed);
+}
 
-  for (const FileDescriptors::value_type& f: _fileDescriptors) {
-    close(f.second);
+unsigned long ChannelHandle::bytesWritten() const noexcept {
+  return _bytesWritten.load(std::memory_order_relaxed);
+}
+
+MessageExchanger::~MessageExchanger() noexcept {
+  while (!_listeningThreads.empty()) {
+    stopListening(_listeningThreads.begin()->first);
   }
 }
 
@@ -28,8 +98,10 @@ void MessageExchanger::init() const {
   }
 }
 
-void MessageExchanger::openChannel(const std::string& channelName) {
-  if (_fileDescriptors.find(channelName) != _fileDescriptors.end()) return;
+ChannelPtr MessageExchanger::getChannel(const std::string& channelName) {
+  std::lock_guard<std::mutex> lock(_channelsMutex);
+  ChannelMap::const_iterator it = _channels.find(channelName);
+  if (it != _channels.end()) return it->second;
 
   if (mkfifo((PIPE_DIR + channelName).c_str(), 0600) == -1) {
     if (errno != EEXIST) {
@@ -42,15 +114,74 @@ void MessageExchanger::openChannel(const std::string& channelName) {
     throw FatalError("Error while opening pipe " + channelName);
   }
 
-  _fileDescriptors.insert({channelName, fd});
+  ChannelPtr channel = std::make_shared<ChannelHandle>(channelName, fd);
+  _channels.insert({channelName, channel});
+  return channel;
+}
+
+void MessageExchanger::openChannel(const std::string& channelName) {
+  getChannel(channelName);
 }
 
 void MessageExchanger::closeChannel(const std::string& channelName) {
-  FileDescriptors::iterator fd = _fileDescriptors.find(channelName);
-  if (fd != _fileDescriptors.end()) {
-    close(fd->second);
-    _fileDescriptors.erase(fd);
+  // The descriptor is closed with the last handle
+  std::lock_guard<std::mutex> lock(_channelsMutex);
+  _channels.erase(channelName);
+}
+
+bool MessageExchanger::removeChannel(const std::string& channelName) {
+  closeChannel(channelName);
+  if (unlink((PIPE_DIR + channelName).c_str()) == -1) {
+    if (errno == ENOENT) return false;
+    throw Error("Error while removing pipe " + channelName);
+  }
+  return true;
+}
+
+std::vector<std::pair<std::string, unsigned long>>& MessageExchanger::getMessageCounts(
+    std::vector<std::pair<std::string, unsigned long>>& dest) const {
+  std::lock_guard<std::mutex> lock(_listenedMutex);
+  for (const ChannelMap::value_type& channel: _listenedChannels) {
+    dest.push_back({channel.first, channel.second->messagesRead()});
+  }
+  return dest;
+}
+
+std::size_t MessageExchanger::countChannels() const noexcept {
+  DIR* dir = opendir(PIPE_DIR.c_str());
+  if (!dir) return 0;
+
+  std::size_t nbChannels = 0;
+  while (struct dirent* entry = readdir(dir)) {
+    nbChannels += (entry->d_name[0] != '.');
   }
+  closedir(dir);
+  return nbChannels;
+}
+
+std::vector<std::string>& MessageExchanger::listChannels(std::vector<std::string>& dest) const {
+  DIR* dir = opendir(PIPE_DIR.c_str());
+  if (!dir) return dest;
+
+  while (struct dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] != '.') {
+      dest.push_back(entry->d_name);
+    }
+  }
+  closedir(dir);
+  return dest;
+}
+
+std::vector<std::string>& MessageExchanger::listOpenChannels(std::vector<std::string>& dest) const {
+  std::lock_guard<std::mutex> lock(_channelsMutex);
+  for (const ChannelMap::value_type& channel: _channels) {
+    dest.push_back(channel.first);
+  }
+  return dest;
+}
+
+void MessageExchanger::writeBytes(const std::string& channelName, const void* data, std::size_t size) {
+  getChannel(channelName)->writeBytes(data, size);
 }
 
 void MessageExchanger::stopListening(const std::string& channelName) {
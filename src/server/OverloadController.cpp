@@ -0,0 +1,167 @@
+#include "server/OverloadController.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#include "utils.hpp"
+
+const char* overloadLevelName(OverloadLevel level) noexcept {
+  switch (level) {
+    case OVERLOAD_NONE:
+      return "none";
+    case OVERLOAD_COALESCE:
+      return "coalesce frames";
+    case OVERLOAD_SEND_RATE:
+      return "lower send rate";
+    case OVERLOAD_SPAWNS:
+      return "cap spawns";
+    case OVERLOAD_REFUSE:
+      return "refuse games";
+  }
+  return "unknown";
+}
+
+OverloadController::OverloadController(const ErrorHandler& errorHandler) noexcept
+    : _errorHandler(errorHandler), _windowStart(getTimestamp()) {}
+
+void OverloadController::disable() noexcept {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _enabled = false;
+  _setLevel(OVERLOAD_NONE, "controller disabled");
+}
+
+void OverloadController::exportMetrics(const std::string& path) noexcept {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _metricsPath = path;
+}
+
+bool OverloadController::isLate(long lateness, long budget) noexcept {
+  return lateness > long(double(budget) * LATE_FRACTION);
+}
+
+void OverloadController::reportTick(long cost, long lateness, long budget) noexcept {
+  bool late = isLate(lateness, budget);
+  _lateness.record(lateness);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  ++_windowTicks;
+  ++_metrics.ticks;
+  if (late) {
+    ++_windowLateTicks;
+    ++_metrics.lateTicks;
+  }
+  _windowLoad += (budget > 0) ? double(cost) / double(budget) : 1;
+
+  long now = getTimestamp();
+  if (now - _windowStart >= WINDOW) {
+    _evaluate(now);
+  }
+}
+
+void OverloadController::update() noexcept {
+  std::lock_guard<std::mutex> lock(_mutex);
+  long now = getTimestamp();
+  if (now - _windowStart >= WINDOW) {
+    _evaluate(now);
+  }
+}
+
+void OverloadController::_evaluate(long now) {
+  double load = (_windowTicks) ? _windowLoad / double(_windowTicks) : 0;
+  double lateRatio = (_windowTicks) ? double(_windowLateTicks) / double(_windowTicks) : 0;
+  // A window without ticks counts as idle for as long as it lasted
+  unsigned windows = (_windowTicks) ? 1 : unsigned((now - _windowStart) / WINDOW);
+
+  OverloadLevel level = OverloadLevel(_level.load());
+  if (_enabled && (load > RAISE_LOAD || lateRatio > RAISE_LATE_RATIO)) {
+    _idleWindows = 0;
+    if (level != OVERLOAD_REFUSE) {
+      char reason[96];
+      std::snprintf(reason, sizeof(reason), "load %.2f, %.1f%% late ticks", load, 100 * lateRatio);
+      _setLevel(OverloadLevel(level + 1), reason);
+    }
+  } else if (load < LOWER_LOAD && lateRatio < LOWER_LATE_RATIO) {
+    _idleWindows += windows;
+    if (level != OVERLOAD_NONE && _idleWindows >= LOWER_WINDOWS) {
+      _idleWindows = 0;
+      _setLevel(OverloadLevel(level - 1), "load back to normal");
+    }
+  } else {
+    _idleWindows = 0;
+  }
+
+  _metrics.load = load;
+  _metrics.lateRatio = lateRatio;
+  _windowStart = now;
+  _windowTicks = 0;
+  _windowLateTicks = 0;
+  _windowLoad = 0;
+
+  if (!_metricsPath.empty()) {
+    _writeMetrics();
+  }
+}
+
+void OverloadController::_setLevel(OverloadLevel level, const char* reason) {
+  OverloadLevel previous = OverloadLevel(_level.exchange(level));
+  if (previous == level) return;
+
+  ++_metrics.transitions;
+  _errorHandler.logMessage(std::string("Overload level ") + std::to_string(previous) + " (" + overloadLevelName(previous) +
+                           ") -> " + std::to_string(level) + " (" + overloadLevelName(level) + "): " + reason);
+}
+
+void OverloadController::_writeMetrics() const noexcept {
+  Metrics metrics = _metrics;
+  metrics.level = OverloadLevel(_level.load());
+  metrics.coalescedFrames = _coalescedFrames.load();
+  metrics.skippedFrames = _skippedFrames.load();
+  metrics.refusedGames = _refusedGames.load();
+
+  // Written aside then renamed, so that readers never see a partial file
+  std::string tmpPath = _metricsPath + ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::trunc);
+    file << "ltype_overload_level " << unsigned(metrics.level) << "\n"
+         << "ltype_overload_transitions_total " << metrics.transitions << "\n"
+         << "ltype_ticks_total " << metrics.ticks << "\n"
+         << "ltype_late_ticks_total " << metrics.lateTicks << "\n"
+         << "ltype_coalesced_frames_total " << metrics.coalescedFrames << "\n"
+         << "ltype_skipped_frames_total " << metrics.skippedFrames << "\n"
+         << "ltype_refused_games_total " << metrics.refusedGames << "\n"
+         << "ltype_tick_load " << metrics.load << "\n"
+         << "ltype_late_tick_ratio " << metrics.lateRatio << "\n";
+    if (!file) return;
+  }
+  std::rename(tmpPath.c_str(), _metricsPath.c_str());
+}
+
+OverloadLevel OverloadController::level() const noexcept {
+  return OverloadLevel(_level.load(std::memory_order_relaxed));
+}
+
+void OverloadController::countCoalescedFrame() noexcept {
+  _coalescedFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void OverloadController::countSkippedFrame() noexcept {
+  _skippedFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void OverloadController::countRefusedGame() noexcept {
+  _refusedGames.fetch_add(1, std::memory_order_relaxed);
+}
+
+OverloadController::Metrics OverloadController::metrics() const noexcept {
+  std::lock_guard<std::mutex> lock(_mutex);
+  Metrics metrics = _metrics;
+  metrics.level = OverloadLevel(_level.load());
+  metrics.coalescedFrames = _coalescedFrames.load();
+  metrics.skippedFrames = _skippedFrames.load();
+  metrics.refusedGames = _refusedGames.load();
+  return metrics;
+}
+
+const Histogram& OverloadController::lateness() const noexcept {
+  return _lateness;
+}
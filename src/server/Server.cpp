@@ -1,8 +1,16 @@
 #include "server/Server.hpp"
 
+#include <pthread.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <utility>
 #include <vector>
 
@@ -21,12 +29,17 @@ bool Server::_isTokenValid(const Token& token) noexcept {
   std::string username = token.getUsername();
   std::string gameID = token.getActivityID();
   std::string secondUsername = token.getGuestUsername();
+  std::string channel = token.getChannel();
   std::string timestamp = token.getTimestamp();
   std::string sig = token.getSignature();
-  return genSignature(username + gameID + secondUsername + timestamp) == sig;
+  if (genSignature(username + gameID + secondUsername + channel + timestamp) != sig) {
+    _tokenFailures.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
 }
 
-Server::Server() noexcept: _errorHandler(LOG_DIR), _databaseManager(DB_PATH) {
+Server::Server() noexcept: _errorHandler(LOG_DIR), _databaseManager(DB_PATH), _startTime(getTimestamp()) {
   try {
     _messageExchanger.init();
   } catch (std::exception& err) {
@@ -35,15 +48,32 @@ Server::Server() noexcept: _errorHandler(LOG_DIR), _databaseManager(DB_PATH) {
 }
 
 Server::~Server() noexcept {
+  _stopping = true;
+  for (GameWorker* worker: _workers) {
+    worker->thread->join();
+    delete worker->thread;
+    delete worker;
+  }
+
+  std::lock_guard<std::mutex> lock(_gamesMutex);
   for (const GameMap::value_type& activity: _activeGames) {
     (activity.second.ptr)->stop();
-    (activity.second.thread)->join();
+    if (activity.second.thread) {
+      (activity.second.thread)->join();
+    }
     delete (activity.second.ptr);
   }
 }
 
 void Server::start() noexcept {
   try {
+    // Profiling signals are waited for by this thread only, the threads started below inherit the mask
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    sigaddset(&signals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
     _messageExchanger.startListening("connectClient", &Server::_connectClient, this);
     _messageExchanger.startListening("connectPlayer", &Server::_connectPlayer, this);
     _messageExchanger.startListening("disconnectPlayer", &Server::_disconnectPlayer, this);
@@ -58,6 +88,7 @@ void Server::start() noexcept {
     _messageExchanger.startListening("newGame", &Server::_addNewGame, this);
     _messageExchanger.startListening("gameInput", &Server::_applyInput, this);
     _messageExchanger.startListening("stopGame", &Server::_quitGame, this);
+    _messageExchanger.startListening("spectateGame", &Server::_spectateGame, this);
 
     _messageExchanger.startListening("levelRequest", &Server::_levelRequest, this);
     _messageExchanger.startListening("rateLevel", &Server::_rateLevel, this);
@@ -66,9 +97,20 @@ void Server::start() noexcept {
     _messageExchanger.startListening("getLvlProgress", &Server::_getLvlProgress, this);
     _messageExchanger.startListening("stopSandbox", &Server::_quitSandbox, this);
 
+    _messageExchanger.startListening("serverStats", &Server::_serverStats, this);
+
+    _channelManager.start();
+
     printf("[Server running]\n");
 
-    pause();
+    int signal;
+    while (sigwait(&signals, &signal) == 0) {
+      if (signal == SIGUSR1) {
+        _dumpProfile();
+      } else if (signal == SIGUSR2) {
+        _toggleProfiling();
+      }
+    }
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
   }
@@ -90,6 +132,7 @@ void Server::stop() noexcept {
     _messageExchanger.stopListening("newGame");
     _messageExchanger.stopListening("gameInput");
     _messageExchanger.stopListening("stopGame");
+    _messageExchanger.stopListening("spectateGame");
 
     _messageExchanger.stopListening("levelRequest");
     _messageExchanger.stopListening("rateLevel");
@@ -97,16 +140,138 @@ void Server::stop() noexcept {
     _messageExchanger.stopListening("sandboxEdition");
     _messageExchanger.stopListening("getLvlProgress");
     _messageExchanger.stopListening("stopSandbox");
+
+    _messageExchanger.stopListening("serverStats");
+
+    _channelManager.stop();
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
   }
 }
 
-inline Token Server::_initCommunicationToClient(const std::string& username, const std::string& gameID, const std::string& secondUsername) noexcept {
+void Server::recordReplays(const std::string& directory) noexcept {
+  if (directory.empty()) {
+    _replayDirectory.clear();
+    return;
+  }
+  if (mkdir(directory.c_str(), 0700) == -1 && errno != EEXIST) {
+    _errorHandler.handleError(Error("Error while creating the replay directory"));
+    return;
+  }
+  _replayDirectory = (directory.back() == '/') ? directory : directory + "/";
+}
+
+void Server::batchGames(std::size_t gamesPerThread) noexcept {
+  _batchSize = gamesPerThread;
+}
+
+void Server::setRates(unsigned tickRate, unsigned sendRate) noexcept {
+  _tickRate = tickRate;
+  _sendRate = sendRate;
+}
+
+void Server::parallelTicks(std::size_t threshold) noexcept {
+  _parallelThreshold = threshold;
+}
+
+void Server::exportOverloadMetrics(const std::string& path) noexcept {
+  _overloadController.exportMetrics(path);
+}
+
+void Server::disableOverloadControl() noexcept {
+  _overloadController.disable();
+}
+
+void Server::profileTicks(const std::string& path) noexcept {
+  _profilePath = path;
+  _profiling = true;
+}
+
+std::shared_ptr<TickProfiler> Server::_newGameProfiler(const std::string& gameID) {
+  std::shared_ptr<TickProfiler> profiler = std::make_shared<TickProfiler>(&_profiler);
+  std::lock_guard<std::mutex> lock(_profilersMutex);
+  _gameProfilers[gameID] = profiler;
+  return profiler;
+}
+
+void Server::_toggleProfiling() {
+  if (!_profiling) {
+    std::lock_guard<std::mutex> lock(_profilersMutex);
+    _profiler.reset();
+    for (const std::pair<const std::string, std::shared_ptr<TickProfiler>>& profiler: _gameProfilers) {
+      profiler.second->reset();
+    }
+  }
+  _profiling = !_profiling;
+  _errorHandler.logMessage(std::string("Tick profiling ") + (_profiling ? "on" : "off"));
+}
+
+void Server::_dumpProfile() {
+  std::string path = (_profilePath.empty()) ? LOG_DIR + "profile.txt" : _profilePath;
+
+  // Written aside then renamed, so that readers never see a partial file
+  std::string tmpPath = path + ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::trunc);
+    std::lock_guard<std::mutex> lock(_profilersMutex);
+    _profiler.dump(file, std::string("server (profiling ") + (_profiling ? "on" : "off") + ")");
+    for (const std::pair<const std::string, std::shared_ptr<TickProfiler>>& profiler: _gameProfilers) {
+      profiler.second->dump(file, "game " + profiler.first);
+    }
+    if (!file) {
+      _errorHandler.handleError(Error("Error while writing the tick profile to " + path));
+      return;
+    }
+  }
+  std::rename(tmpPath.c_str(), path.c_str());
+}
+
+/* Whether the tick `tick` is one of the `rate` ticks per second spread evenly
+ *  over the `tickRate` ticks of a second.
+ */
+static bool isRateTick(unsigned long tick, unsigned rate, unsigned tickRate) noexcept {
+  return tick * rate / tickRate != (tick + 1) * rate / tickRate;
+}
+
+bool Server::_isSendTick(unsigned long tick, const Game& game) noexcept {
+  bool sendTick = isRateTick(tick, game.sendRate(), game.tickRate());
+  if (_overloadController.level() < OVERLOAD_SEND_RATE) {
+    return sendTick;
+  }
+
+  unsigned sendRate = std::max(1u, game.sendRate() / 2);
+  if (isRateTick(tick, sendRate, game.tickRate())) {
+    return true;
+  }
+  if (sendTick) {
+    _overloadController.countSkippedFrame();
+  }
+  return false;
+}
+
+bool Server::_coalesceFrames(long lateness, long tickDuration, unsigned& coalescedFrames) noexcept {
+  // Frames are not coalesced for ever, so that clients still see a late game move
+  if (_overloadController.level() >= OVERLOAD_COALESCE && OverloadController::isLate(lateness, tickDuration) &&
+      coalescedFrames < OverloadController::MAX_COALESCED_FRAMES) {
+    ++coalescedFrames;
+    return true;
+  }
+  coalescedFrames = 0;
+  return false;
+}
+
+void Server::_capDrops(Game& game) {
+  bool capped = _overloadController.level() >= OVERLOAD_SPAWNS;
+  if (game.dropsCapped() != capped) {
+    game.capDrops(capped);
+  }
+}
+
+inline Token Server::_initCommunicationToClient(
+    const std::string& username, const std::string& gameID, const std::string& channel, const std::string& secondUsername) noexcept {
   std::string timestamp = getStrTimestamp();
-  std::string sig = genSignature(username + gameID + secondUsername + timestamp);
-  _messageExchanger.openChannel(sig);
-  return Token(username, gameID, timestamp, sig, secondUsername);
+  std::string sig = genSignature(username + gameID + secondUsername + channel + timestamp);
+  return Token(username, gameID, channel, timestamp, sig, secondUsername);
 }
 
 void Server::_connectClient(const Handshake& msg) {
@@ -133,17 +298,15 @@ void Server::_connectClient(const Handshake& msg) {
       }
     }
     bool isAdmin = _databaseManager.isAdmin(username);
-    responsePtr = new Message<ClientInfo>(_initCommunicationToClient(username, ""), ClientInfo(true, isAdmin));
+    responsePtr = new Message<ClientInfo>(_initCommunicationToClient(username, "", msg.getChannel()), ClientInfo(true, isAdmin));
   } catch (std::exception& err) {
     responsePtr = new Message<ClientInfo>(Token(), ClientInfo(false));
     _errorHandler.handleError(err);
   }
 
-  // Send the response to the client
+  // Send the response to the client, on the channel it keeps for its session
   try {
-    _messageExchanger.openChannel(msg.getChannel());
     _messageExchanger.writeMessage(msg.getChannel(), *responsePtr);
-    _messageExchanger.closeChannel(msg.getChannel());
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
   }
@@ -154,7 +317,7 @@ void Server::_connectClient(const Handshake& msg) {
 void Server::_connectPlayer(const Message<SYN>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"connectPlayer", token.getUsername(), token.getActivityID()});
     return;
   }
 
@@ -187,7 +350,7 @@ void Server::_connectPlayer(const Message<SYN>& msg) {
       }
     }
     bool isAdmin = _databaseManager.isAdmin(username);
-    responsePtr = new Message<ClientInfo>(_initCommunicationToClient(token.getUsername(), "", username), ClientInfo(true, isAdmin));
+    responsePtr = new Message<ClientInfo>(_initCommunicationToClient(token.getUsername(), "", token.getChannel(), username), ClientInfo(true, isAdmin));
   } catch (std::exception& err) {
     responsePtr = new Message<ClientInfo>(token, ClientInfo(false));
     _errorHandler.handleError(err);
@@ -195,10 +358,7 @@ void Server::_connectPlayer(const Message<SYN>& msg) {
 
   // Send the response to the client
   try {
-    _messageExchanger.writeMessage(token.getSignature(), *responsePtr);
-    if (responsePtr->getData().connected) {
-      _messageExchanger.closeChannel(token.getSignature());
-    }
+    _messageExchanger.writeMessage(token.getChannel(), *responsePtr);
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
   }
@@ -209,16 +369,15 @@ void Server::_connectPlayer(const Message<SYN>& msg) {
 void Server::_disconnectPlayer(const Message<bool>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"disconnectPlayer", token.getUsername(), token.getActivityID()});
     return;
   }
 
-  Message<bool> response(_initCommunicationToClient(token.getUsername()), true);
+  Message<bool> response(_initCommunicationToClient(token.getUsername(), "", token.getChannel()), true);
 
   // Send the response to the client
   try {
-    _messageExchanger.writeMessage(token.getSignature(), response);
-    _messageExchanger.closeChannel(token.getSignature());
+    _messageExchanger.writeMessage(token.getChannel(), response);
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
   }
@@ -227,7 +386,7 @@ void Server::_disconnectPlayer(const Message<bool>& msg) {
 void Server::_leaderboardRequest(const Message<LeaderboardRequest>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"leaderboardRequest", token.getUsername(), token.getActivityID()});
     return;
   }
 
@@ -242,11 +401,11 @@ void Server::_leaderboardRequest(const Message<LeaderboardRequest>& msg) {
     }
 
     // Send the number of results
-    _messageExchanger.writeMessage(msg.getTokenSignature(), unsigned(leaderboard.size()));
+    _messageExchanger.writeMessage(msg.getTokenChannel(), unsigned(leaderboard.size()));
 
     // Send the results
     if (!leaderboard.empty()) {
-      _messageExchanger.writeMessage(msg.getTokenSignature(), leaderboard);
+      _messageExchanger.writeMessage(msg.getTokenChannel(), leaderboard);
     }
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
@@ -256,7 +415,7 @@ void Server::_leaderboardRequest(const Message<LeaderboardRequest>& msg) {
 void Server::_playerRequest(const Message<PlayerInfoRequest>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"playerInfoRequest", token.getUsername(), token.getActivityID()});
     return;
   }
 
@@ -270,7 +429,7 @@ void Server::_playerRequest(const Message<PlayerInfoRequest>& msg) {
 
   // Send the response to the client
   try {
-    _messageExchanger.writeMessage(token.getSignature(), *responsePtr);
+    _messageExchanger.writeMessage(token.getChannel(), *responsePtr);
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
   }
@@ -281,7 +440,7 @@ void Server::_playerRequest(const Message<PlayerInfoRequest>& msg) {
 void Server::_manageFollow(const Message<FollowRequest>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"followRequest", token.getUsername(), token.getActivityID()});
     return;
   }
 
@@ -299,13 +458,14 @@ void Server::_manageFollow(const Message<FollowRequest>& msg) {
 
   // Send the response to the client
   try {
-    _messageExchanger.writeMessage(msg.getTokenSignature(), success);
+    _messageExchanger.writeMessage(msg.getTokenChannel(), success);
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
   }
 }
 
 bool Server::_gameExists(const std::string& activityID) const noexcept {
+  std::lock_guard<std::mutex> lock(_gamesMutex);
   return _activeGames.find(activityID) != _activeGames.end();
 }
 
@@ -320,7 +480,7 @@ std::string Server::_generateGameID() const noexcept {
 void Server::_addNewGame(const Message<GameSettings>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"newGame", token.getUsername(), token.getActivityID()});
   }
 
   Message<bool>* responsePtr;
@@ -332,16 +492,55 @@ void Server::_addNewGame(const Message<GameSettings>& msg) {
     if (token.getUsername() == token.getGuestUsername()) {
       throw Error("Usernames are the same");
     }
+    _overloadController.update();
+    if (_overloadController.level() >= OVERLOAD_REFUSE) {
+      _overloadController.countRefusedGame();
+      throw Error("The server is overloaded, try again later");
+    }
 
     // Create a new game
     std::string username = token.getUsername();
     std::string gameID = _generateGameID();
-    Game* gamePtr = new Game(msg.getData(), &_databaseManager, {msg.getData().levelID});
-    Token newToken = _initCommunicationToClient(username, gameID);
+    GameSettings settings = msg.getData();
+    if (_tickRate) {
+      settings.tickRate = _tickRate;
+    }
+    if (_sendRate) {
+      settings.sendRate = _sendRate;
+    }
+    Game* gamePtr = new Game(settings, &_databaseManager, {settings.levelID}, genRandomSeed());
+    gamePtr->setParallelThreshold(_parallelThreshold);
+    if (!_replayDirectory.empty()) {
+      try {
+        gamePtr->record(_replayDirectory + gameID + ".replay");
+      } catch (std::exception& err) {
+        _errorHandler.handleError(err);
+      }
+    }
+    Token newToken = _initCommunicationToClient(username, gameID, token.getChannel());
+
+    // Frames of a previous game may be left unread
+    ChannelPtr frameChannel = _messageExchanger.getChannel(newToken.getGameChannel());
+    frameChannel->drain();
 
-    _activeGames.insert({gameID, {gamePtr, newToken.getSignature(), {username, token.getGuestUsername()}}});
-    std::thread* newThread = new std::thread(&Server::_playGame, this, gameID);
-    (_activeGames.find(gameID)->second).thread = newThread;
+    std::vector<std::string> usernames = {username};
+    if (!token.getGuestUsername().empty()) {
+      usernames.push_back(token.getGuestUsername());
+    }
+    // Frames are only shared once a spectator comes
+    std::shared_ptr<FrameRing> spectators = std::make_shared<FrameRing>(gameID, true);
+    std::shared_ptr<TickProfiler> profiler = _newGameProfiler(gameID);
+    GameStatus gameStatus = {gamePtr, newToken.getChannel(), usernames, spectators};
+    if (_batchSize) {
+      gamePtr->start();
+      gameStatus.worker = _addToWorker(gamePtr, frameChannel, spectators, profiler);
+    } else {
+      gameStatus.thread = new std::thread(&Server::_playGame, this, gamePtr, frameChannel, spectators, profiler);
+    }
+    {
+      std::lock_guard<std::mutex> lock(_gamesMutex);
+      _activeGames.insert({gameID, gameStatus});
+    }
 
     responsePtr = new Message<bool>(newToken, true);
   } catch (std::exception& err) {
@@ -351,10 +550,7 @@ void Server::_addNewGame(const Message<GameSettings>& msg) {
 
   // Send the response to the client
   try {
-    _messageExchanger.writeMessage(token.getSignature(), *responsePtr);
-    if (responsePtr->getData()) {
-      _messageExchanger.closeChannel(token.getSignature());
-    }
+    _messageExchanger.writeMessage(token.getChannel(), *responsePtr);
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
   }
@@ -362,30 +558,71 @@ void Server::_addNewGame(const Message<GameSettings>& msg) {
   delete responsePtr;
 }
 
-void Server::_playGame(const std::string& gameID) {
-  Game* game;
-  GameMap::iterator gameIt = _activeGames.find(gameID);
-  if (gameIt == _activeGames.end() || !(game = dynamic_cast<Game*>((gameIt->second).ptr))) {
-    throw Error("Error while starting a game");
+void Server::_sendRefresh(FrameMailbox& mailbox, Game& game, TickProfiler* profiler) {
+  long frameTime = 0;
+  long writeTime = 0;
+  const FrameArena* frame = nullptr;
+  timePhase(profiler ? &frameTime : nullptr, [&]() { frame = &game.buildFrame(); });
+  timePhase(profiler ? &writeTime : nullptr, [&]() { mailbox.post(*frame); });
+
+  if (profiler) {
+    profiler->record(PHASE_FRAME, frameTime);
+    profiler->record(PHASE_WRITE, writeTime);
   }
+  _flushRefresh(mailbox, game);
+}
+
+void Server::_flushRefresh(FrameMailbox& mailbox, Game& game) {
+  if (mailbox.flush(game.frame()) || !mailbox.stalled(getMonotonicTimestamp()) || game.stopped()) return;
 
+  _stalledClients.fetch_add(1, std::memory_order_relaxed);
+  game.stop();
+  _errorHandler.handleError(Error("Client stalled, game stopped"));
+}
+
+void Server::_playGame(Game* game, ChannelPtr channel, std::shared_ptr<FrameRing> spectators, std::shared_ptr<TickProfiler> profiler) {
   try {
-    std::string tokenSignature = (gameIt->second).tokenSignature;
+    long int tickDuration = 1000000 / long(game->tickRate());  // µs
+    unsigned long tick = 0;
+    unsigned coalescedFrames = 0;
+    bool owedFrame = false;  // A frame was coalesced and is sent on the next tick on time
+    FrameMailbox mailbox(channel, spectators, _droppedFrames);
 
     game->start();
+    std::chrono::time_point<std::chrono::system_clock> due = std::chrono::system_clock::now();
     do {
       std::chrono::time_point<std::chrono::system_clock> timer_start = std::chrono::system_clock::now();
-
-      game->refresh();
-
-      _messageExchanger.writeMessage(tokenSignature, game->getRefreshFrame());
-      std::vector<EntityFrame> entityFrames;
-      game->getEntityFrames(entityFrames);
-      _messageExchanger.writeMessage(tokenSignature, entityFrames);
+      long int lateness = std::max(0L, long(std::chrono::duration_cast<std::chrono::microseconds>(timer_start - due).count()));  // µs
+      due = timer_start + std::chrono::microseconds(tickDuration);
+
+      bool profiling = _profiling.load(std::memory_order_relaxed);
+      TickPhases phases;
+      _capDrops(*game);
+      game->refresh(profiling ? &phases : nullptr);
+
+      bool sendTick = _isSendTick(tick++, *game);
+      if (sendTick || owedFrame) {
+        if (_coalesceFrames(lateness, tickDuration, coalescedFrames)) {
+          if (sendTick) {
+            _overloadController.countCoalescedFrame();
+          }
+          owedFrame = true;
+        } else {
+          _sendRefresh(mailbox, *game, profiling ? profiler.get() : nullptr);
+          owedFrame = false;
+        }
+      } else {
+        _flushRefresh(mailbox, *game);
+      }
 
       std::chrono::time_point<std::chrono::system_clock> timer_stop = std::chrono::system_clock::now();
       long int delta = std::chrono::duration_cast<std::chrono::microseconds>(timer_stop - timer_start).count();  // µs
-      long int wait = TICK - delta;
+      long int wait = tickDuration - delta;
+      _overloadController.reportTick(delta, lateness, tickDuration);
+      if (profiling) {
+        profiler->record(phases);
+        profiler->record(PHASE_TICK, std::chrono::duration_cast<std::chrono::nanoseconds>(timer_stop - timer_start).count());
+      }
 
       if (wait > 0) {
         usleep(unsigned(wait));
@@ -393,78 +630,255 @@ void Server::_playGame(const std::string& gameID) {
 
     } while (!game->hasEnded());
 
-    _messageExchanger.writeMessage(tokenSignature, game->getRefreshFrame());
-    std::vector<EntityFrame> entityFrames;
-    game->getEntityFrames(entityFrames);
-    _messageExchanger.writeMessage(tokenSignature, entityFrames);
+    // The last frame is delivered, unless the client stalled or quit the game
+    _sendRefresh(mailbox, *game);
+    while (!game->stopped() && !_stopping && !mailbox.flush(game->frame()) && !mailbox.stalled(getMonotonicTimestamp())) {
+      usleep(unsigned(tickDuration));
+    }
 
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
   }
 }
 
-void Server::_applyInput(const Message<int>& msg) {
+Server::GameWorker* Server::_addToWorker(Game* game, ChannelPtr channel, std::shared_ptr<FrameRing> spectators, std::shared_ptr<TickProfiler> profiler) {
+  for (GameWorker* worker: _workers) {
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    if (worker->tickRate == game->tickRate() && worker->batch.size() < _batchSize) {
+      worker->batch.add(game);
+      worker->mailboxes.insert({game, std::make_unique<FrameMailbox>(channel, spectators, _droppedFrames)});
+      worker->profilers.insert({game, profiler});
+      return worker;
+    }
+  }
+
+  GameWorker* worker = new GameWorker();
+  worker->tickRate = game->tickRate();
+  worker->batch.add(game);
+  worker->mailboxes.insert({game, std::make_unique<FrameMailbox>(channel, spectators, _droppedFrames)});
+  worker->profilers.insert({game, profiler});
+  worker->thread = new std::thread(&Server::_playGames, this, worker);
+  _workers.push_back(worker);
+  return worker;
+}
+
+void Server::_playGames(GameWorker* worker) {
+  long int tickDuration = 1000000 / long(worker->tickRate);  // µs
+  std::vector<Game*> ended;
+  std::chrono::time_point<std::chrono::system_clock> due = std::chrono::system_clock::now();
+  while (!_stopping) {
+    std::chrono::time_point<std::chrono::system_clock> timer_start = std::chrono::system_clock::now();
+    long int lateness = std::max(0L, long(std::chrono::duration_cast<std::chrono::microseconds>(timer_start - due).count()));  // µs
+    due = timer_start + std::chrono::microseconds(tickDuration);
+
+    // The phases of a batch cover all of its games, they are only recorded for the server
+    bool profiling = _profiling.load(std::memory_order_relaxed);
+    TickPhases phases;
+    {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+      try {
+        for (Game* game: worker->batch.games()) {
+          _capDrops(*game);
+        }
+        worker->batch.refresh(profiling ? &phases : nullptr);
+      } catch (std::exception& err) {
+        _errorHandler.handleError(err);
+      }
+
+      bool coalesce = _coalesceFrames(lateness, tickDuration, worker->coalescedFrames);
+      for (Game* game: worker->batch.games()) {
+        try {
+          TickProfiler* profiler = (profiling) ? worker->profilers.at(game).get() : nullptr;
+          FrameMailbox& mailbox = *worker->mailboxes.at(game);
+          // The last frame of a game is always sent
+          bool sendTick = !game->hasEnded() && _isSendTick(worker->ticks, *game);
+          if (game->hasEnded()) {
+            _sendRefresh(mailbox, *game, profiler);
+          } else if (sendTick || worker->owedFrames.count(game)) {
+            if (coalesce) {
+              if (sendTick) {
+                _overloadController.countCoalescedFrame();
+              }
+              worker->owedFrames.insert(game);
+            } else {
+              _sendRefresh(mailbox, *game, profiler);
+              worker->owedFrames.erase(game);
+            }
+          } else {
+            _flushRefresh(mailbox, *game);
+          }
+
+          if (game->hasEnded()) {
+            ended.push_back(game);
+          }
+        } catch (std::exception& err) {
+          ended.push_back(game);
+          _errorHandler.handleError(err);
+        }
+      }
+
+      for (Game* game: ended) {
+        worker->batch.remove(game);
+        worker->profilers.erase(game);
+        worker->owedFrames.erase(game);
+        worker->leaving.push_back(game);
+      }
+      ended.clear();
+
+      // Ended games keep their mailbox until their last frame is delivered, or their client stalled
+      std::vector<const Game*>::iterator leavingIt = worker->leaving.begin();
+      while (leavingIt != worker->leaving.end()) {
+        FrameMailbox& mailbox = *worker->mailboxes.at(*leavingIt);
+        bool left = true;
+        try {
+          left = mailbox.flush((*leavingIt)->frame()) || mailbox.stalled(getMonotonicTimestamp());
+        } catch (std::exception& err) {
+          _errorHandler.handleError(err);
+        }
+        if (left) {
+          worker->mailboxes.erase(*leavingIt);
+          leavingIt = worker->leaving.erase(leavingIt);
+        } else {
+          ++leavingIt;
+        }
+      }
+      ++worker->ticks;
+    }
+
+    std::chrono::time_point<std::chrono::system_clock> timer_stop = std::chrono::system_clock::now();
+    long int delta = std::chrono::duration_cast<std::chrono::microseconds>(timer_stop - timer_start).count();  // µs
+    long int wait = tickDuration - delta;
+    _overloadController.reportTick(delta, lateness, tickDuration);
+    if (profiling) {
+      _profiler.record(phases);
+      _profiler.record(PHASE_TICK, std::chrono::duration_cast<std::chrono::nanoseconds>(timer_stop - timer_start).count());
+    }
+
+    if (wait > 0) {
+      usleep(unsigned(wait));
+    }
+  }
+}
+
+void Server::_applyInput(const Message<GameInput>& msg) {
+  long received = getMonotonicTimestamp();
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"gameInput", token.getUsername(), token.getActivityID()});
     return;
   }
 
+  // The game is not deleted while its input is queued
+  std::lock_guard<std::mutex> lock(_gamesMutex);
   Game* game;
   GameMap::iterator gameIt = _activeGames.find(token.getActivityID());
   if (gameIt == _activeGames.end() || !(game = dynamic_cast<Game*>((gameIt->second).ptr))) {
-    _errorHandler.handleError(Error("This game does not exist"));
+    _errorHandler.handleError(Error("This game does not exist"), {"gameInput", token.getUsername(), token.getActivityID()});
     return;
   }
 
   try {
-    game->applyInput(msg.getData());
+    // Server codes are only applied by the server
+    GameInput input = msg.getData();
+    if (input.key == SERVER_CODE_CAP_DROPS || input.key == SERVER_CODE_UNCAP_DROPS) {
+      throw Error("Invalid input");
+    }
+    if (!game->queueInput({input.key, input.sequence, received})) {
+      throw Error("Too many inputs, input dropped");
+    }
   } catch (std::exception& err) {
-    _errorHandler.handleError(err);
+    _errorHandler.handleError(err, {"gameInput", token.getUsername(), token.getActivityID()});
   }
 }
 
-void Server::_quitGame(const Message<Channel>& msg) {
+void Server::_quitGame(const Message<bool>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"stopGame", token.getUsername(), token.getActivityID()});
     return;
   }
 
-  Activity* activityPtr;
-  GameMap::iterator activityIt = _activeGames.find(token.getActivityID());
-  if (activityIt == _activeGames.end() || !(activityPtr = (activityIt->second).ptr)) {
-    _errorHandler.handleError(Error("This game does not exist"));
-    return;
+  // The game leaves the active ones first, no other thread reaches it then
+  GameStatus gameStatus;
+  {
+    std::lock_guard<std::mutex> lock(_gamesMutex);
+    GameMap::iterator activityIt = _activeGames.find(token.getActivityID());
+    if (activityIt == _activeGames.end() || !(activityIt->second).ptr) {
+      _errorHandler.handleError(Error("This game does not exist"));
+      return;
+    }
+    gameStatus = activityIt->second;
+    _activeGames.erase(activityIt);
   }
+  Activity* activityPtr = gameStatus.ptr;
 
   try {
-    GameStatus& gameStatus = activityIt->second;
-
     // Update scores in database if this is a game
     Game* gamePtr = dynamic_cast<Game*>(activityPtr);
     if (!activityPtr->stopped() && gamePtr) {
-      RefreshFrame refreshFrame = gamePtr->getRefreshFrame();
-      _databaseManager.newScore(gameStatus.usernames[0], int(refreshFrame.score[0]));
-      if (!gameStatus.usernames[1].empty()) {
-        _databaseManager.newScore(gameStatus.usernames[1], int(refreshFrame.score[1]));
+      std::vector<PlayerFrame> playerFrames;
+      gamePtr->getPlayerFrames(playerFrames);
+      for (std::size_t p = 0; p != gameStatus.usernames.size() && p != playerFrames.size(); ++p) {
+        _databaseManager.newScore(gameStatus.usernames[p], int(playerFrames[p].score));
       }
     }
 
-    // Send the new token to the client
-    std::string responseChannel = msg.getData().channelName;
-    _messageExchanger.closeChannel(gameStatus.tokenSignature);
-    Token newToken = _initCommunicationToClient(gameStatus.usernames[0], "");
-    _messageExchanger.openChannel(responseChannel);
-    _messageExchanger.writeMessage(responseChannel, Message<bool>(newToken, true));
-    _messageExchanger.closeChannel(responseChannel);
-
+    // No frame is sent once the game is stopped, the ones left unread are drained by the next game
     std::thread* activityThread = gameStatus.thread;
     activityPtr->stop();
-    activityThread->join();
-    delete activityThread;
+    if (GameWorker* worker = gameStatus.worker) {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+      worker->batch.remove(gamePtr);
+      worker->mailboxes.erase(gamePtr);
+      worker->leaving.erase(std::remove(worker->leaving.begin(), worker->leaving.end(), gamePtr), worker->leaving.end());
+      worker->profilers.erase(gamePtr);
+      worker->owedFrames.erase(gamePtr);
+    } else {
+      activityThread->join();
+      delete activityThread;
+    }
+
+    // Send the new token to the client
+    std::string channel = gameStatus.channel;
+    _messageExchanger.writeMessage(channel, Message<bool>(_initCommunicationToClient(gameStatus.usernames[0], "", channel), true));
+
     delete activityPtr;
-    _activeGames.erase(activityIt);
+    {
+      std::lock_guard<std::mutex> lock(_profilersMutex);
+      _gameProfilers.erase(token.getActivityID());
+    }
+  } catch (std::exception& err) {
+    _errorHandler.handleError(err);
+  }
+}
+
+void Server::_spectateGame(const Message<SpectateRequest>& msg) {
+  Token token = msg.getToken();
+  if (!_isTokenValid(token)) {
+    _errorHandler.handleError(Error("Invalid token"), {"spectateGame", token.getUsername(), token.getActivityID()});
+    return;
+  }
+
+  bool spectating = false;
+  try {
+    std::shared_ptr<FrameRing> spectators = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(_gamesMutex);
+      GameMap::iterator gameIt = _activeGames.find(msg.getData().gameID);
+      if (gameIt != _activeGames.end() && dynamic_cast<Game*>((gameIt->second).ptr) && !(gameIt->second).ptr->stopped()) {
+        spectators = (gameIt->second).spectators;
+      }
+    }
+    if (spectators) {
+      spectators->open();
+      spectating = true;
+    }
+  } catch (std::exception& err) {
+    _errorHandler.handleError(err);
+  }
+
+  try {
+    _messageExchanger.writeMessage(token.getChannel(), spectating);
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
   }
@@ -486,7 +900,7 @@ std::string Server::_generateSandboxID() const noexcept {
 void Server::_levelRequest(const Message<LevelRequest>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"levelRequest", token.getUsername(), token.getActivityID()});
   }
 
   LevelRequest request = msg.getData();
@@ -497,11 +911,11 @@ void Server::_levelRequest(const Message<LevelRequest>& msg) {
     _databaseManager.getLevels(levels, request.nbEntries, request.offset, user);
 
     // Send number of results
-    _messageExchanger.writeMessage(token.getSignature(), unsigned(levels.size()));
+    _messageExchanger.writeMessage(token.getChannel(), unsigned(levels.size()));
     // Send results
-    _messageExchanger.writeMessage(token.getSignature(), levels);
+    _messageExchanger.writeMessage(token.getChannel(), levels);
   } catch (std::exception& err) {
-    _messageExchanger.writeMessage(token.getSignature(), 0);
+    _messageExchanger.writeMessage(token.getChannel(), 0);
     _errorHandler.handleError(err);
   }
 }
@@ -509,7 +923,7 @@ void Server::_levelRequest(const Message<LevelRequest>& msg) {
 void Server::_rateLevel(const Message<LevelRate>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"rateLevel", token.getUsername(), token.getActivityID()});
   }
 
   LevelRate lvlRate = msg.getData();
@@ -525,7 +939,7 @@ void Server::_rateLevel(const Message<LevelRate>& msg) {
 void Server::_addNewSandbox(const Message<SandboxSettings>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"newSandbox", token.getUsername(), token.getActivityID()});
   }
 
   Message<bool>* responsePtr;
@@ -552,10 +966,10 @@ void Server::_addNewSandbox(const Message<SandboxSettings>& msg) {
 
     if (sandboxPtr) {
       std::string sandboxID = _generateSandboxID();
-      _activeSandboxes.insert({sandboxID, {sandboxPtr, token.getSignature(), token.getUsername()}});
+      _activeSandboxes.insert({sandboxID, {sandboxPtr, token.getChannel(), token.getUsername()}});
 
       // Send response to the client
-      Token newToken = _initCommunicationToClient(token.getUsername(), sandboxID);
+      Token newToken = _initCommunicationToClient(token.getUsername(), sandboxID, token.getChannel());
       responsePtr = new Message<bool>(newToken, true);
     } else {
       throw Error("A user tried to modify another player's level");
@@ -568,10 +982,7 @@ void Server::_addNewSandbox(const Message<SandboxSettings>& msg) {
 
   // Send the response to the client
   try {
-    _messageExchanger.writeMessage(token.getSignature(), *responsePtr);
-    if (responsePtr->getData()) {
-      _messageExchanger.closeChannel(token.getSignature());
-    }
+    _messageExchanger.writeMessage(token.getChannel(), *responsePtr);
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
   }
@@ -582,7 +993,7 @@ void Server::_addNewSandbox(const Message<SandboxSettings>& msg) {
 void Server::_editSandbox(const Message<SandboxEdition>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"sandboxEdition", token.getUsername(), token.getActivityID()});
     return;
   }
 
@@ -608,10 +1019,10 @@ void Server::_editSandbox(const Message<SandboxEdition>& msg) {
   }
 }
 
-void Server::_quitSandbox(const Message<Channel>& msg) {
+void Server::_quitSandbox(const Message<bool>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"stopSandbox", token.getUsername(), token.getActivityID()});
     return;
   }
 
@@ -626,12 +1037,8 @@ void Server::_quitSandbox(const Message<Channel>& msg) {
     SandboxStatus sandboxStatus = sandboxId->second;
 
     // Send the new token to the client
-    std::string responseChannel = msg.getData().channelName;
-    _messageExchanger.closeChannel(sandboxStatus.tokenSignature);
-    Token newToken = _initCommunicationToClient(sandboxStatus.username, "");
-    _messageExchanger.openChannel(responseChannel);
-    _messageExchanger.writeMessage(responseChannel, Message<bool>(newToken, true));
-    _messageExchanger.closeChannel(responseChannel);
+    Token newToken = _initCommunicationToClient(sandboxStatus.username, "", sandboxStatus.channel);
+    _messageExchanger.writeMessage(sandboxStatus.channel, Message<bool>(newToken, true));
 
     activityPtr->stop();
     delete activityPtr;
@@ -644,7 +1051,7 @@ void Server::_quitSandbox(const Message<Channel>& msg) {
 void Server::_getLvlProgress(const Message<unsigned>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"getLvlProgress", token.getUsername(), token.getActivityID()});
     return;
   }
 
@@ -659,10 +1066,10 @@ void Server::_getLvlProgress(const Message<unsigned>& msg) {
     Sandbox* sbPtr = dynamic_cast<Sandbox*>(activityPtr);
     std::vector<EntityInfo> entities;
     _databaseManager.populateLevel(entities, sbPtr->getId(), msg.getData());
-    _messageExchanger.writeMessage(token.getSignature(), unsigned(entities.size()));
-    _messageExchanger.writeMessage(token.getSignature(), entities);
+    _messageExchanger.writeMessage(token.getChannel(), unsigned(entities.size()));
+    _messageExchanger.writeMessage(token.getChannel(), entities);
   } catch (std::exception& err) {
-    _messageExchanger.writeMessage(token.getSignature(), 0);
+    _messageExchanger.writeMessage(token.getChannel(), 0);
     _errorHandler.handleError(err);
   }
 }
@@ -670,7 +1077,7 @@ void Server::_getLvlProgress(const Message<unsigned>& msg) {
 void Server::_packs(const Message<PlayerInfoRequest>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"packs", token.getUsername(), token.getActivityID()});
     return;
   }
 
@@ -679,11 +1086,11 @@ void Server::_packs(const Message<PlayerInfoRequest>& msg) {
     _databaseManager.populatePacks(packs, msg.getData().username);
 
     // Send the number of results
-    _messageExchanger.writeMessage(msg.getTokenSignature(), unsigned(packs.size()));
+    _messageExchanger.writeMessage(msg.getTokenChannel(), unsigned(packs.size()));
 
     // Send the results
     if (!packs.empty()) {
-      _messageExchanger.writeMessage(msg.getTokenSignature(), packs);
+      _messageExchanger.writeMessage(msg.getTokenChannel(), packs);
     }
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
@@ -693,7 +1100,7 @@ void Server::_packs(const Message<PlayerInfoRequest>& msg) {
 void Server::_packKey(const Message<PackKeyRequest>& msg) {
   Token token = msg.getToken();
   if (!_isTokenValid(token)) {
-    _errorHandler.handleError(Error("Invalid token"));
+    _errorHandler.handleError(Error("Invalid token"), {"packKey", token.getUsername(), token.getActivityID()});
     return;
   }
 
@@ -701,7 +1108,7 @@ void Server::_packKey(const Message<PackKeyRequest>& msg) {
     // Use
     case 0: {
       bool activated = _databaseManager.usePackKey(msg.getData().key, msg.getData().username);
-      _messageExchanger.writeMessage(msg.getTokenSignature(), activated);
+      _messageExchanger.writeMessage(msg.getTokenChannel(), activated);
     } break;
 
     // List
@@ -715,7 +1122,7 @@ void Server::_packKey(const Message<PackKeyRequest>& msg) {
     case 2:
       if (_databaseManager.isAdmin(token.getUsername())) {
         PackKey sk = _databaseManager.addPackKey(msg.getData().pack, msg.getData().key, msg.getData().uses);
-        _messageExchanger.writeMessage(msg.getTokenSignature(), sk);
+        _messageExchanger.writeMessage(msg.getTokenChannel(), sk);
       }
       break;
 
@@ -734,11 +1141,98 @@ void Server::_getPackKeys(const Message<PackKeyRequest>& msg) {
     _databaseManager.populatePackKey(packKeys);
 
     // Send the number of results
-    _messageExchanger.writeMessage(msg.getTokenSignature(), unsigned(packKeys.size()));
+    _messageExchanger.writeMessage(msg.getTokenChannel(), unsigned(packKeys.size()));
 
     // Send the results
     if (!packKeys.empty()) {
-      _messageExchanger.writeMessage(msg.getTokenSignature(), packKeys);
+      _messageExchanger.writeMessage(msg.getTokenChannel(), packKeys);
+    }
+  } catch (std::exception& err) {
+    _errorHandler.handleError(err);
+  }
+}
+
+/* Resident set size of the process, in bytes (0 if unknown).
+ */
+static unsigned long residentSetSize() noexcept {
+  std::ifstream statm("/proc/self/statm");
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  if (!(statm >> size >> resident)) {
+    return 0;
+  }
+  return resident * static_cast<unsigned long>(sysconf(_SC_PAGESIZE));
+}
+
+void Server::_serverStats(const Message<bool>& msg) {
+  Token token = msg.getToken();
+  if (!_isTokenValid(token)) {
+    _errorHandler.handleError(Error("Invalid token"), {"serverStats", token.getUsername(), token.getActivityID()});
+    return;
+  }
+
+  try {
+    if (!_databaseManager.isAdmin(token.getUsername())) {
+      _messageExchanger.writeMessage(msg.getTokenChannel(), false);
+      return;
+    }
+
+    long now = getTimestamp();
+    ServerStats stats = {};
+    stats.timestamp = now;
+    stats.uptime = now - _startTime;
+    {
+      std::lock_guard<std::mutex> lock(_gamesMutex);
+      stats.activeGames = unsigned(_activeGames.size());
+    }
+    stats.activeSandboxes = unsigned(_activeSandboxes.size());
+    stats.tokenFailures = _tokenFailures.load(std::memory_order_relaxed);
+
+    const Histogram& queryTimes = _databaseManager.queryTimes();
+    stats.dbQueries = queryTimes.count();
+    stats.dbMean = queryTimes.mean() / 1000;
+    stats.dbP50 = double(queryTimes.percentile(50)) / 1000;
+    stats.dbP99 = double(queryTimes.percentile(99)) / 1000;
+    stats.dbMax = double(queryTimes.max()) / 1000;
+
+    OverloadController::Metrics metrics = _overloadController.metrics();
+    const Histogram& lateness = _overloadController.lateness();
+    stats.ticks = metrics.ticks;
+    stats.lateTicks = metrics.lateTicks;
+    stats.latenessP50 = double(lateness.percentile(50));
+    stats.latenessP99 = double(lateness.percentile(99));
+    stats.latenessMax = double(lateness.max());
+    stats.overloadLevel = unsigned(metrics.level);
+    stats.droppedFrames = _droppedFrames.load(std::memory_order_relaxed);
+    stats.stalledClients = _stalledClients.load(std::memory_order_relaxed);
+
+    stats.fifos = unsigned(_messageExchanger.countChannels());
+    stats.collectedFifos = _channelManager.collected();
+    stats.rss = residentSetSize();
+
+    std::vector<std::pair<std::string, unsigned long>> counts;
+    _messageExchanger.getMessageCounts(counts);
+    std::vector<ChannelStats> channels;
+    {
+      // Rates are taken over the time elapsed since the previous request, or since the start
+      std::lock_guard<std::mutex> lock(_statsMutex);
+      double elapsed = double(now - ((_lastStatsTime) ? _lastStatsTime : _startTime)) / 1000000;
+      for (const std::pair<std::string, unsigned long>& count: counts) {
+        ChannelStats channel = {};
+        std::strncpy(channel.name, count.first.c_str(), sizeof(channel.name) - 1);
+        channel.messages = count.second;
+        channel.rate = (elapsed > 0) ? double(count.second - _lastMessageCounts[count.first]) / elapsed : 0;
+        _lastMessageCounts[count.first] = count.second;
+        channels.push_back(channel);
+      }
+      _lastStatsTime = now;
+    }
+    stats.nbChannels = unsigned(channels.size());
+
+    _messageExchanger.writeMessage(msg.getTokenChannel(), true);
+    _messageExchanger.writeMessage(msg.getTokenChannel(), stats);
+    if (!channels.empty()) {
+      _messageExchanger.writeMessage(msg.getTokenChannel(), channels);
     }
   } catch (std::exception& err) {
     _errorHandler.handleError(err);
@@ -0,0 +1,76 @@
+#include "server/TickProfiler.hpp"
+
+#include <cstdio>
+
+const char* profiledPhaseName(ProfiledPhase phase) noexcept {
+  switch (phase) {
+    case PHASE_MOVES:
+      return "moves";
+    case PHASE_OFF_SCREEN:
+      return "offscreen";
+    case PHASE_LOAD_LEVEL:
+      return "level";
+    case PHASE_ATTACKS:
+      return "attacks";
+    case PHASE_COLLISIONS:
+      return "collisions";
+    case PHASE_STATES:
+      return "states";
+    case PHASE_FRAME:
+      return "frame";
+    case PHASE_WRITE:
+      return "write";
+    case PHASE_TICK:
+      return "tick";
+    case NB_PHASES:
+      break;
+  }
+  return "unknown";
+}
+
+TickProfiler::TickProfiler(TickProfiler* parent) noexcept: _parent(parent) {}
+
+void TickProfiler::record(ProfiledPhase phase, long ns) noexcept {
+  _phases[phase].record(ns);
+  if (_parent) {
+    _parent->record(phase, ns);
+  }
+}
+
+void TickProfiler::record(const TickPhases& phases) noexcept {
+  record(PHASE_MOVES, phases.moves);
+  record(PHASE_OFF_SCREEN, phases.offScreen);
+  record(PHASE_LOAD_LEVEL, phases.loadLevel);
+  record(PHASE_ATTACKS, phases.attacks);
+  record(PHASE_COLLISIONS, phases.collisions);
+  record(PHASE_STATES, phases.states);
+}
+
+void TickProfiler::reset() noexcept {
+  for (Histogram& histogram: _phases) {
+    histogram.reset();
+  }
+}
+
+const Histogram& TickProfiler::phase(ProfiledPhase phase) const noexcept {
+  return _phases[phase];
+}
+
+void TickProfiler::dump(std::ostream& out, const std::string& title) const {
+  char line[160];
+  out << title << "\n";
+  std::snprintf(line, sizeof(line), "  %-11s %10s %9s %9s %9s %9s %9s %9s\n",
+                "phase", "count", "mean_us", "p50_us", "p90_us", "p99_us", "p99.9_us", "max_us");
+  out << line;
+
+  for (unsigned p = 0; p != NB_PHASES; ++p) {
+    const Histogram& histogram = _phases[p];
+    if (histogram.count() == 0) continue;
+    std::snprintf(line, sizeof(line), "  %-11s %10lu %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                  profiledPhaseName(ProfiledPhase(p)), histogram.count(), histogram.mean() / 1000,
+                  double(histogram.percentile(50)) / 1000, double(histogram.percentile(90)) / 1000,
+                  double(histogram.percentile(99)) / 1000, double(histogram.percentile(99.9)) / 1000,
+                  double(histogram.max()) / 1000);
+    out << line;
+  }
+}
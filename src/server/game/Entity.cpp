@@ -1,39 +1,62 @@
 #include "server/game/Entity.hpp"
 
-#include <array>
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 #include "random"
 #include "utils.hpp"
 
+/**********************************************************************
+ *                                BODY                                *
+ **********************************************************************/
+
+Body::Body(Real _xPos, Real _yPos, int _xSize, int _ySize, Real _xVelocity, Real _yVelocity) noexcept
+    : xPos(_xPos), yPos(_yPos), xSize(_xSize), ySize(_ySize), xVelocity(_xVelocity), yVelocity(_yVelocity) {}
+
+Body::Body(const PhysicsBox& box) noexcept
+    : xPos(Real(box.xPos)),
+      yPos(Real(box.yPos)),
+      xSize(box.xSize),
+      ySize(box.ySize),
+      xVelocity(Real(box.xVelocity)),
+      yVelocity(Real(box.yVelocity)) {}
+
 /**********************************************************************
  *                               ENTITY                               *
  **********************************************************************/
 
-Entity::Entity(unsigned ID, const PhysicsBox& physicsBox, Map* map, Group* group) noexcept
+Entity::Entity(unsigned ID, const Body& physicsBox, Map* map, Group* group) noexcept
     : _ID(ID), _physicsBox(physicsBox), _map(map), _group(group) {}
 
 Entity::~Entity() noexcept {
   removeFromGroup();
 }
 
-inline double Entity::xPos() const noexcept { return _physicsBox.xPos; }
-inline double Entity::yPos() const noexcept { return _physicsBox.yPos; }
+inline Real Entity::xPos() const noexcept { return _physicsBox.xPos; }
+inline Real Entity::yPos() const noexcept { return _physicsBox.yPos; }
 inline int Entity::xSize() const noexcept { return _physicsBox.xSize; }
 inline int Entity::ySize() const noexcept { return _physicsBox.ySize; }
 unsigned Entity::ID() const noexcept { return _ID; }
 
-void Entity::setxPos(double xPos) noexcept { _physicsBox.xPos = xPos; }
-void Entity::setyPos(double yPos) noexcept { _physicsBox.yPos = yPos; }
+void Entity::setxPos(Real xPos) noexcept {
+  _physicsBox.xPos = xPos;
+  _xMove = 0;
+}
 
-double Entity::xVelocity() const noexcept { return _physicsBox.xVelocity; }
-double Entity::yVelocity() const noexcept { return _physicsBox.yVelocity; }
+void Entity::setyPos(Real yPos) noexcept {
+  _physicsBox.yPos = yPos;
+  _yMove = 0;
+}
+
+Real Entity::xVelocity() const noexcept { return _physicsBox.xVelocity; }
+Real Entity::yVelocity() const noexcept { return _physicsBox.yVelocity; }
 
-void Entity::setVelocityX(double velocity) {
+void Entity::setVelocityX(Real velocity) {
   _physicsBox.xVelocity = velocity;
 }
 
-void Entity::setVelocityY(double velocity) {
+void Entity::setVelocityY(Real velocity) {
   _physicsBox.yVelocity = velocity;
 }
 
@@ -43,7 +66,7 @@ void Entity::resetVelocity() {
 }
 
 void Entity::refreshState() noexcept {
-  ++_stateStep %= STATE_DURATION;
+  ++_stateStep %= _map->timing().stateDuration;
   if (_stateStep == 0) {
     _state = MOVE_STATE;
   }
@@ -61,10 +84,12 @@ Group* Entity::group() noexcept { return _group; }
 
 void Entity::_moveX() noexcept {
   _physicsBox.xPos += _physicsBox.xVelocity;
+  _xMove = _physicsBox.xVelocity;
 }
 
 void Entity::_moveY() noexcept {
   _physicsBox.yPos += _physicsBox.yVelocity;
+  _yMove = _physicsBox.yVelocity;
 }
 
 void Entity::move() {
@@ -74,12 +99,57 @@ void Entity::move() {
 
 bool Entity::isTouching(const Entity* other) const noexcept {
   if (_state == DIE_STATE || other->state() == DIE_STATE) return false;
+  if (_isFast() || other->_isFast()) return _isSweptTouching(other);
   return (xPos() < other->xPos() + other->xSize() &&
           xPos() + xSize() > other->xPos() &&
           yPos() < other->yPos() + other->ySize() &&
           yPos() + ySize() > other->yPos());
 }
 
+bool Entity::_isFast() const noexcept {
+  return _xMove > Real(xSize()) || -_xMove > Real(xSize()) || _yMove > Real(ySize()) || -_yMove > Real(ySize());
+}
+
+/* Narrow the open interval ]enter, exit[ of move fractions t during which a box
+ *  of size `size` starting at `start` and moving by `move` overlaps, on one
+ *  axis, a fixed box of size `otherSize` at `otherPos`.
+ */
+static void sweepAxis(double start, double size, double move, double otherPos, double otherSize, double& enter, double& exit) noexcept {
+  double lower = otherPos - size - start;  // start + t * move must lie in ]lower, upper[
+  double upper = otherPos + otherSize - start;
+  if (move == 0) {
+    if (!(lower < 0 && 0 < upper)) {
+      exit = -std::numeric_limits<double>::infinity();
+    }
+    return;
+  }
+
+  double t1 = lower / move;
+  double t2 = upper / move;
+  if (move < 0) {
+    std::swap(t1, t2);
+  }
+  enter = std::max(enter, t1);
+  exit = std::min(exit, t2);
+}
+
+/* Computed in double whatever the number type of the simulation: conversions
+ *  of `Real` are exact, and the result stays the same on any host.
+ */
+bool Entity::_isSweptTouching(const Entity* other) const noexcept {
+  // Move of this entity relative to the other one, both ending at their current position
+  double xMove = toDouble(_xMove) - toDouble(other->_xMove);
+  double yMove = toDouble(_yMove) - toDouble(other->_yMove);
+
+  double enter = -std::numeric_limits<double>::infinity();
+  double exit = std::numeric_limits<double>::infinity();
+  sweepAxis(toDouble(xPos()) - xMove, xSize(), xMove, toDouble(other->xPos()), other->xSize(), enter, exit);
+  sweepAxis(toDouble(yPos()) - yMove, ySize(), yMove, toDouble(other->yPos()), other->ySize(), enter, exit);
+
+  // The boxes overlap for some t of [0, 1]
+  return enter < exit && enter < 1 && exit > 0;
+}
+
 void Entity::removeFromGroup() {
   if (_group) {
     _group->removeEntity(this);
@@ -87,37 +157,77 @@ void Entity::removeFromGroup() {
   }
 }
 
+std::int32_t Entity::_snapshotIndexOf(const Entity* entity) noexcept {
+  return (entity) ? entity->_snapshotIndex : NO_ENTITY;
+}
+
+void Entity::save(EntityRecord& record) const noexcept {
+  record.ID = _ID;
+  record.xPos = rawValue(_physicsBox.xPos);
+  record.yPos = rawValue(_physicsBox.yPos);
+  record.xSize = _physicsBox.xSize;
+  record.ySize = _physicsBox.ySize;
+  record.xVelocity = rawValue(_physicsBox.xVelocity);
+  record.yVelocity = rawValue(_physicsBox.yVelocity);
+  record.state = _state;
+  record.stateStep = _stateStep;
+  record.collisionEpoch = _collisionEpoch;
+}
+
+void Entity::load(const EntityRecord& record, Entity* const*) noexcept {
+  _physicsBox.xPos = fromRaw(record.xPos);
+  _physicsBox.yPos = fromRaw(record.yPos);
+  _physicsBox.xVelocity = fromRaw(record.xVelocity);
+  _physicsBox.yVelocity = fromRaw(record.yVelocity);
+  _state = record.state;
+  _stateStep = record.stateStep;
+  _collisionEpoch = record.collisionEpoch;
+}
+
 /**********************************************************************
  *                              POWERUP                               *
  **********************************************************************/
 
-PowerUp::PowerUp(unsigned ID, const PhysicsBox& physicsBox, Map* map, double fireDamageFactor, double fireRateFactor) noexcept
+PowerUp::PowerUp(unsigned ID, const Body& physicsBox, Map* map, Real fireDamageFactor, Real fireRateFactor) noexcept
     : Entity(ID, physicsBox, map, &map->group(POWERUP)),
       _fireDamageFactor(fireDamageFactor),
       _fireRateFactor(fireRateFactor) {}
 
-double PowerUp::fireDamageFactor() const noexcept {
+Real PowerUp::fireDamageFactor() const noexcept {
   return _fireDamageFactor;
 }
 
-double PowerUp::fireRateFactor() const noexcept {
+Real PowerUp::fireRateFactor() const noexcept {
   return _fireRateFactor;
 }
 
+void PowerUp::save(EntityRecord& record) const noexcept {
+  Entity::save(record);
+  record.kind = KIND_POWERUP;
+  record.fireDamageFactor = rawValue(_fireDamageFactor);
+  record.fireRateFactor = rawValue(_fireRateFactor);
+}
+
+void PowerUp::load(const EntityRecord& record, Entity* const* entities) noexcept {
+  Entity::load(record, entities);
+  _fireDamageFactor = fromRaw(record.fireDamageFactor);
+  _fireRateFactor = fromRaw(record.fireRateFactor);
+}
+
 /**********************************************************************
  *                           PHYSICALENTITY                           *
  **********************************************************************/
 
-PhysicalEntity::PhysicalEntity(unsigned ID, const PhysicsBox& physicsBox, Map* map, Group* group, double hp, double damage) noexcept
+PhysicalEntity::PhysicalEntity(unsigned ID, const Body& physicsBox, Map* map, Group* group, Real hp, Real damage) noexcept
     : Entity(ID, physicsBox, map, group), _hp(hp), _damage(damage) {}
 
 PhysicalEntity::~PhysicalEntity() noexcept {}
 
-double PhysicalEntity::getDamage() const noexcept {
+Real PhysicalEntity::getDamage() const noexcept {
   return _damage;
 }
 
-double PhysicalEntity::hp() const noexcept {
+Real PhysicalEntity::hp() const noexcept {
   return _hp;
 }
 
@@ -125,12 +235,12 @@ bool PhysicalEntity::checkDeath() noexcept {
   return _hp <= 0;
 }
 
-void PhysicalEntity::hurt(double damage) noexcept {
+void PhysicalEntity::hurt(Real damage) noexcept {
   if (_hp == 0) return;
 
-  double floatPart = _hp - floor(_hp);
+  Real floatPart = _hp - floor(_hp);
   if (floatPart == 0) {
-    floatPart = 1.0;
+    floatPart = 1;
   }
   _hp -= (damage < floatPart) ? damage : floatPart;
 
@@ -149,34 +259,62 @@ void PhysicalEntity::kill() noexcept {
   removeFromGroup();
 }
 
+void PhysicalEntity::save(EntityRecord& record) const noexcept {
+  Entity::save(record);
+  record.hp = rawValue(_hp);
+  record.damage = rawValue(_damage);
+}
+
+void PhysicalEntity::load(const EntityRecord& record, Entity* const* entities) noexcept {
+  Entity::load(record, entities);
+  _hp = fromRaw(record.hp);
+  _damage = fromRaw(record.damage);
+}
+
 /**********************************************************************
  *                              OBSTACLE                              *
  **********************************************************************/
 
-Obstacle::Obstacle(unsigned ID, const PhysicsBox& physicsBox, Map* map) noexcept
-    : PhysicalEntity(ID, physicsBox, map, &map->group(OBSTACLE), OBSTACLE_HP, OBSTACLE_DAMAGE) {
-  setVelocityY(OBSTACLE_VELOCITY);
+Obstacle::Obstacle(unsigned ID, const Body& physicsBox, Map* map) noexcept
+    : PhysicalEntity(ID, physicsBox, map, &map->group(OBSTACLE), Real(OBSTACLE_HP), Real(OBSTACLE_DAMAGE)) {
+  setVelocityY(map->timing().obstacleVelocity);
+}
+
+void Obstacle::save(EntityRecord& record) const noexcept {
+  PhysicalEntity::save(record);
+  record.kind = KIND_OBSTACLE;
 }
 
 /**********************************************************************
  *                               BULLET                               *
  **********************************************************************/
 
-Bullet::Bullet(unsigned ID, const PhysicsBox& physicsBox, Map* map, double fireDamage, Player* shooter) noexcept
-    : PhysicalEntity(ID, physicsBox, map, &map->group(BULLET), BULLET_HP, fireDamage), _shooter(shooter) {}
+Bullet::Bullet(unsigned ID, const Body& physicsBox, Map* map, Real fireDamage, Player* shooter) noexcept
+    : PhysicalEntity(ID, physicsBox, map, &map->group(BULLET), Real(BULLET_HP), fireDamage), _shooter(shooter) {}
 
 Player* Bullet::getShooter() const noexcept {
   return _shooter;
 }
 
+void Bullet::save(EntityRecord& record) const noexcept {
+  PhysicalEntity::save(record);
+  record.kind = KIND_BULLET;
+  record.reference = _snapshotIndexOf(_shooter);
+}
+
+void Bullet::load(const EntityRecord& record, Entity* const* entities) noexcept {
+  PhysicalEntity::load(record, entities);
+  _shooter = (record.reference == NO_ENTITY) ? nullptr : static_cast<Player*>(entities[record.reference]);
+}
+
 /**********************************************************************
  *                             CHARACTER                              *
  **********************************************************************/
 
-Character::Character(unsigned ID, const PhysicsBox& physicsBox, Map* map, Group* group, double hp, double damage, double fireDamage, unsigned fireDelay) noexcept
+Character::Character(unsigned ID, const Body& physicsBox, Map* map, Group* group, Real hp, Real damage, Real fireDamage, unsigned fireDelay) noexcept
     : PhysicalEntity(ID, physicsBox, map, group, hp, damage), _fireDamage(fireDamage), _fireDelay(fireDelay) {}
 
-double Character::fireDamage() const noexcept {
+Real Character::fireDamage() const noexcept {
   return _fireDamage;
 }
 
@@ -203,27 +341,41 @@ bool Character::checkDeath() noexcept {
   if (_state != DIE_STATE) {
     _state = DIE_STATE;
     _stateStep = 0;
-  } else if (_stateStep == STATE_DURATION - 1) {
+  } else if (_stateStep == _map->timing().stateDuration - 1) {
     died = true;
   }
   return died;
 }
 
+void Character::save(EntityRecord& record) const noexcept {
+  PhysicalEntity::save(record);
+  record.fireDamage = rawValue(_fireDamage);
+  record.fireDelay = _fireDelay;
+  record.remainingDelay = _remainingDelay;
+}
+
+void Character::load(const EntityRecord& record, Entity* const* entities) noexcept {
+  PhysicalEntity::load(record, entities);
+  _fireDamage = fromRaw(record.fireDamage);
+  _fireDelay = record.fireDelay;
+  _remainingDelay = record.remainingDelay;
+}
+
 /**********************************************************************
  *                               ENNEMY                               *
  **********************************************************************/
 
-Enemy::Enemy(unsigned ID, const PhysicsBox& physicsBox, Map* map, double hp, unsigned fireDelay, double fireDamage, double bonusProbability, double difficulty) noexcept
-    : Character(ID, physicsBox, map, &map->group(ENEMY), hp, ENEMY_DAMAGE, fireDamage * difficulty, fireDelay),
+Enemy::Enemy(unsigned ID, const Body& physicsBox, Map* map, Real hp, unsigned fireDelay, Real fireDamage, Real bonusProbability, Real difficulty) noexcept
+    : Character(ID, physicsBox, map, &map->group(ENEMY), hp, Real(ENEMY_DAMAGE), fireDamage * difficulty, fireDelay),
       _bonusProbability(bonusProbability),
       _difficulty(difficulty) {}
 
-Bullet* Enemy::_createBullet(double xOffset, double xVelocity) noexcept {
-  PhysicsBox physicsBox(
+Bullet* Enemy::_createBullet(Real xOffset, Real xVelocity) noexcept {
+  Body physicsBox(
       // Spawn the bullet ahead of the character
       xPos() + xOffset + ASSET_BULLET_WIDTH / 2, yPos() + ySize() + ASSET_BULLET_HEIGHT / 2,
       ASSET_BULLET_WIDTH, ASSET_BULLET_HEIGHT,
-      xVelocity, BULLET_VELOCITY);
+      xVelocity, _map->timing().bulletVelocity);
   return new Bullet(ASSET_BULLET_ID, physicsBox, _map, fireDamage());
 }
 
@@ -245,27 +397,34 @@ void Enemy::touch(Entity* other) noexcept {
 }
 
 void Enemy::move() {
-  const std::vector<std::array<int, 2>> moves = getMoves();
+  const MovePattern* pattern = &currentPattern();
+  RealRaw xVelocity, yVelocity;
+  evaluatePatterns(&pattern, &_counter, 1, _map->timing(), &xVelocity, &yVelocity);
 
-  setVelocityX(moves[_counter][0] * ENEMY_VELOCITY_X);
-  setVelocityY(moves[_counter][1] * ENEMY_VELOCITY_Y);
+  setVelocityX(fromRaw(xVelocity));
+  setVelocityY(fromRaw(yVelocity));
   Entity::move();
+}
+
+void Enemy::setLevelPattern(const MovePattern* pattern) noexcept {
+  _levelPattern = pattern;
+}
 
-  ++_counter;
-  _counter %= moves.size();
+const MovePattern& Enemy::currentPattern() const noexcept {
+  return (_levelPattern) ? *_levelPattern : pattern();
 }
 
 PowerUp* Enemy::_dropPowerUp() const noexcept {
-  PhysicsBox physicsBox(
+  Body physicsBox(
       xPos() + (xSize() - ASSET_POWERUP_1_WIDTH) / 2, yPos() + (ySize() + ASSET_POWERUP_1_HEIGHT) / 2,
       ASSET_POWERUP_1_WIDTH, ASSET_POWERUP_1_HEIGHT,
       0, 0);
 
   PowerUp* powerUp;
-  if (genRandomDouble(0, 2) <= 1) {
-    powerUp = new PowerUp(ASSET_POWERUP_1_ID, physicsBox, _map, POWERUP_DAMAGE_RATE, 1);
+  if (_map->genRandomDouble(0, 2) <= 1) {
+    powerUp = new PowerUp(ASSET_POWERUP_1_ID, physicsBox, _map, Real(POWERUP_DAMAGE_RATE), 1);
   } else {
-    powerUp = new PowerUp(ASSET_POWERUP_2_ID, physicsBox, _map, 1, POWERUP_FIRE_RATE);
+    powerUp = new PowerUp(ASSET_POWERUP_2_ID, physicsBox, _map, 1, Real(POWERUP_FIRE_RATE));
   }
 
   return powerUp;
@@ -274,16 +433,31 @@ PowerUp* Enemy::_dropPowerUp() const noexcept {
 void Enemy::kill() noexcept {
   PhysicalEntity::kill();
 
-  if (genRandomDouble(0, 1) <= _bonusProbability) {
-    _map->add(_dropPowerUp());
+  if (Real(_map->genRandomDouble(0, 1)) <= _bonusProbability) {
+    if (_map->dropsCapped()) {
+      _map->genRandomDouble(0, 2);  // Kind of the power-up, drawn all the same (see `Map::dropsCapped`)
+    } else {
+      _map->add(_dropPowerUp());
+    }
   }
 }
 
+void Enemy::save(EntityRecord& record) const noexcept {
+  Character::save(record);
+  record.counter = _counter;
+  record.levelPattern = _levelPattern != nullptr;
+}
+
+void Enemy::load(const EntityRecord& record, Entity* const* entities) noexcept {
+  Character::load(record, entities);
+  _counter = std::size_t(record.counter);
+}
+
 /**********************************************************************
  *                               ENEMY VARIANTS                       *
  **********************************************************************/
 
-const std::vector<std::array<int, 2>> Enemy_1::_moves = {
+constexpr MoveStep ENEMY_1_MOVES[] = {
     {1, 1},
     {1, 1},
     {1, 1},
@@ -308,26 +482,38 @@ const std::vector<std::array<int, 2>> Enemy_1::_moves = {
     {1, 1},
     {1, 1},
 };
+const MovePattern Enemy_1::_pattern(ENEMY_1_MOVES);
 
-Enemy_1::Enemy_1(unsigned ID, const PhysicsBox& physicsBox, Map* map, double bonusProbability, double difficulty) noexcept
-    : Enemy(ID, physicsBox, map, ENEMY_HP, ENEMY_FIRE_DELAY, ENEMY_MAX_FIRE_DAMAGE, bonusProbability, difficulty) {}
+Enemy_1::Enemy_1(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept
+    : Enemy(ID, physicsBox, map, Real(ENEMY_HP), map->timing().enemyFireDelay, Real(ENEMY_MAX_FIRE_DAMAGE), bonusProbability, difficulty) {}
 
-const std::vector<std::array<int, 2>>& Enemy_1::getMoves() const {
-  return Enemy_1::_moves;
+const MovePattern& Enemy_1::pattern() const noexcept {
+  return _pattern;
 }
 
-const std::vector<std::array<int, 2>> Enemy_2::_moves = {
+void Enemy_1::save(EntityRecord& record) const noexcept {
+  Enemy::save(record);
+  record.kind = KIND_ENEMY_1;
+}
+
+constexpr MoveStep ENEMY_2_MOVES[] = {
     {0, 1},
 };
+const MovePattern Enemy_2::_pattern(ENEMY_2_MOVES);
+
+Enemy_2::Enemy_2(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept
+    : Enemy(ID, physicsBox, map, Real(ENEMY_HP), map->timing().enemyFireDelay, Real(ENEMY_MAX_FIRE_DAMAGE), bonusProbability, difficulty) {}
 
-Enemy_2::Enemy_2(unsigned ID, const PhysicsBox& physicsBox, Map* map, double bonusProbability, double difficulty) noexcept
-    : Enemy(ID, physicsBox, map, ENEMY_HP, ENEMY_FIRE_DELAY, ENEMY_MAX_FIRE_DAMAGE, bonusProbability, difficulty) {}
+const MovePattern& Enemy_2::pattern() const noexcept {
+  return _pattern;
+}
 
-const std::vector<std::array<int, 2>>& Enemy_2::getMoves() const {
-  return Enemy_2::_moves;
+void Enemy_2::save(EntityRecord& record) const noexcept {
+  Enemy::save(record);
+  record.kind = KIND_ENEMY_2;
 }
 
-const std::vector<std::array<int, 2>> Enemy_3::_moves = {
+constexpr MoveStep ENEMY_3_MOVES[] = {
     {0, 1},
     {0, 1},
     {1, 0},
@@ -345,36 +531,46 @@ const std::vector<std::array<int, 2>> Enemy_3::_moves = {
     {-1, 0},
     {-1, 0},
 };
+const MovePattern Enemy_3::_pattern(ENEMY_3_MOVES);
 
-Enemy_3::Enemy_3(unsigned ID, const PhysicsBox& physicsBox, Map* map, double bonusProbability, double difficulty) noexcept
-    : Enemy(ID, physicsBox, map, ENEMY_HP, ENEMY_FIRE_DELAY, ENEMY_MAX_FIRE_DAMAGE, bonusProbability, difficulty) {}
+Enemy_3::Enemy_3(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept
+    : Enemy(ID, physicsBox, map, Real(ENEMY_HP), map->timing().enemyFireDelay, Real(ENEMY_MAX_FIRE_DAMAGE), bonusProbability, difficulty) {}
+
+const MovePattern& Enemy_3::pattern() const noexcept {
+  return _pattern;
+}
 
-const std::vector<std::array<int, 2>>& Enemy_3::getMoves() const {
-  return Enemy_3::_moves;
+void Enemy_3::save(EntityRecord& record) const noexcept {
+  Enemy::save(record);
+  record.kind = KIND_ENEMY_3;
 }
 
 /**********************************************************************
  *                               PLAYER                               *
  **********************************************************************/
 
-Player::Player(unsigned ID, const PhysicsBox& physicsBox, Map* map, bool friendlyFire, unsigned initialLives) noexcept
-    : Character(ID, physicsBox, map, &map->group(PLAYER), initialLives, PLAYER_DAMAGE, PLAYER_FIRE_DAMAGE, PLAYER_FIRE_DELAY),
+Player::Player(unsigned ID, const Body& physicsBox, Map* map, bool friendlyFire, unsigned initialLives) noexcept
+    : Character(ID, physicsBox, map, &map->group(PLAYER), initialLives, Real(PLAYER_DAMAGE), Real(PLAYER_FIRE_DAMAGE), map->timing().playerFireDelay),
       _spawnX(physicsBox.xPos),
       _spawnY(physicsBox.yPos),
       _friendlyFire(friendlyFire),
       _initialLives(initialLives) {}
 
-Bullet* Player::_createBullet(double xOffset, double xVelocity) noexcept {
-  PhysicsBox physicsBox(
+Player::~Player() noexcept {
+  delete _powerUp;
+}
+
+Bullet* Player::_createBullet(Real xOffset, Real xVelocity) noexcept {
+  Body physicsBox(
       // Spawn the bullet ahead of the character
       xPos() + xOffset + ASSET_BULLET_WIDTH / 2, yPos(),
       ASSET_BULLET_WIDTH, ASSET_BULLET_HEIGHT,
-      xVelocity, -BULLET_VELOCITY);
+      xVelocity, -_map->timing().bulletVelocity);
   return new Bullet(ASSET_BULLET_ID, physicsBox, _map, fireDamage(), this);
 }
 
-double Player::fireDamage() const noexcept {
-  double fireDamage = _fireDamage;
+Real Player::fireDamage() const noexcept {
+  Real fireDamage = _fireDamage;
   if (_powerUp) {
     fireDamage *= unsigned(_powerUp->fireDamageFactor());
   }
@@ -384,7 +580,7 @@ double Player::fireDamage() const noexcept {
 unsigned Player::fireDelay() const noexcept {
   unsigned fireDelay = _fireDelay;
   if (_powerUp) {
-    fireDelay *= _powerUp->fireRateFactor();
+    fireDelay = unsigned(fireDelay * _powerUp->fireRateFactor());
   }
   return fireDelay;
 }
@@ -425,7 +621,7 @@ void Player::resetState() noexcept {
   if (_hp != ceil(_hp)) {
     _hp = ceil(_hp);
   } else if (_hp != _initialLives) {
-    ++_hp;
+    _hp += 1;
   }
 
   respawn();
@@ -440,7 +636,7 @@ void Player::pick(PowerUp* powerUp) noexcept {
   _stateStep = 0;
 }
 
-void Player::hurt(double damage) noexcept {
+void Player::hurt(Real damage) noexcept {
   if (!_ghost && !_hulk) {
     PhysicalEntity::hurt(damage);
     if (_hp == floor(_hp) && !checkDeath()) {
@@ -458,7 +654,8 @@ void Player::touch(Entity* other) noexcept {
 
     if (bullet) {
       // If the bullet comes from an ennemy or friendly fire is enabled
-      if (!bullet->getShooter() || _friendlyFire) {
+      // A bullet spawns inside its shooter, so it never hurts it
+      if (!bullet->getShooter() || (_friendlyFire && bullet->getShooter() != this)) {
         PhysicalEntity::touch(other);
       }
     } else if (player2) {
@@ -477,9 +674,10 @@ void Player::respawn() noexcept {
   _powerUp = nullptr;
 
   _group = &_map->group(PLAYER);
-  _invincibilityTime = RESPAWN_DURATION;
-  setxPos(_spawnX);
-  setyPos(_spawnY);
+  _invincibilityTime = _map->timing().respawnDuration;
+  // The spawn point is in the view of the camera
+  setxPos(_spawnX + _map->xCamera());
+  setyPos(_spawnY + _map->yCamera());
 }
 
 void Player::addLife() noexcept {
@@ -494,12 +692,35 @@ void Player::toggleHulk() noexcept {
   _hulk = !_hulk;
 }
 
+void Player::save(EntityRecord& record) const noexcept {
+  Character::save(record);
+  record.kind = KIND_PLAYER;
+  record.spawnX = rawValue(_spawnX);
+  record.spawnY = rawValue(_spawnY);
+  record.score = _score;
+  record.invincibilityTime = _invincibilityTime;
+  record.ghost = _ghost;
+  record.hulk = _hulk;
+  record.reference = _snapshotIndexOf(_powerUp);
+}
+
+void Player::load(const EntityRecord& record, Entity* const* entities) noexcept {
+  Character::load(record, entities);
+  _spawnX = fromRaw(record.spawnX);
+  _spawnY = fromRaw(record.spawnY);
+  _score = record.score;
+  _invincibilityTime = record.invincibilityTime;
+  _ghost = record.ghost;
+  _hulk = record.hulk;
+  _powerUp = (record.reference == NO_ENTITY) ? nullptr : static_cast<PowerUp*>(entities[record.reference]);
+}
+
 /**********************************************************************
  *                               BOSS                                 *
  **********************************************************************/
 
-const std::vector<std::array<int, 2>> Boss::_movesBefore = {{0, 0}};
-const std::vector<std::array<int, 2>> Boss::_movesAfter = {
+constexpr MoveStep BOSS_MOVES_BEFORE[] = {{0, 0}};
+constexpr MoveStep BOSS_MOVES_AFTER[] = {
     {1, 0},
     {1, 0},
     {1, 0},
@@ -549,20 +770,22 @@ const std::vector<std::array<int, 2>> Boss::_movesAfter = {
     {1, 0},
     {1, 0},
 };
+const MovePattern Boss::_patternBefore(BOSS_MOVES_BEFORE);
+const MovePattern Boss::_patternAfter(BOSS_MOVES_AFTER);
 
-Boss::Boss(unsigned ID, const PhysicsBox& physicsBox, Map* map, double hp, unsigned fireDelay, double bonusProbability, double difficulty) noexcept
-    : Enemy(ID, physicsBox, map, hp, fireDelay, ENEMY_MAX_FIRE_DAMAGE, bonusProbability, difficulty),
+Boss::Boss(unsigned ID, const Body& physicsBox, Map* map, Real hp, unsigned fireDelay, Real bonusProbability, Real difficulty) noexcept
+    : Enemy(ID, physicsBox, map, hp, fireDelay, Real(ENEMY_MAX_FIRE_DAMAGE), bonusProbability, difficulty),
       _remainingDelay2(fireDelay / 3) {}
 
-const std::vector<std::array<int, 2>>& Boss::getMoves() const {
+const MovePattern& Boss::pattern() const noexcept {
   if (_map->nbEntities(ENEMY) != 1) {
-    return _movesBefore;
+    return _patternBefore;
   } else {
-    return _movesAfter;
+    return _patternAfter;
   }
 }
 
-void Boss::hurt(double damage) noexcept {
+void Boss::hurt(Real damage) noexcept {
   if (_map->nbEntities(ENEMY) == 1) {
     _gatlingMode = true;
     PhysicalEntity::hurt(damage);
@@ -590,6 +813,18 @@ void Boss::shoot() noexcept {
   }
 }
 
+void Boss::save(EntityRecord& record) const noexcept {
+  Enemy::save(record);
+  record.gatlingMode = _gatlingMode;
+  record.remainingDelay2 = _remainingDelay2;
+}
+
+void Boss::load(const EntityRecord& record, Entity* const* entities) noexcept {
+  Enemy::load(record, entities);
+  _gatlingMode = record.gatlingMode;
+  _remainingDelay2 = record.remainingDelay2;
+}
+
 void Boss::spawnHenchmen(int henchmanWidth, int henchmanHeight, unsigned nHenchman) noexcept {
   int i = 0;
   int mid = int(nHenchman) / 2;
@@ -611,34 +846,48 @@ void Boss::spawnHenchmen(int henchmanWidth, int henchmanHeight, unsigned nHenchm
   }
 }
 
-Boss_1::Boss_1(unsigned ID, const PhysicsBox& physicsBox, Map* map, double bonusProbability, double difficulty) noexcept
-    : Boss(ID, physicsBox, map, BOSS_HP, BOSS_FIRE_DELAY, bonusProbability, difficulty) {
+Boss_1::Boss_1(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept
+    : Boss(ID, physicsBox, map, Real(BOSS_HP), map->timing().bossFireDelay, bonusProbability, difficulty) {}
+
+void Boss_1::spawnEscort() noexcept {
   spawnHenchmen(ASSET_HENCHMAN_1_LEFT_WIDTH, ASSET_HENCHMAN_1_LEFT_HEIGHT, 4);
 }
 
+void Boss_1::save(EntityRecord& record) const noexcept {
+  Boss::save(record);
+  record.kind = KIND_BOSS_1;
+}
+
 Henchman* Boss_1::_createHenchman_1(int xPos, int henchmanWidth, int henchmanHeight) noexcept {
-  PhysicsBox physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
-  return new Henchman_1(ASSET_HENCHMAN_1_LEFT_ID, physicsBox, _map, this, _bonusProbability, _difficulty);
+  Body physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
+  return new Henchman_1(ASSET_HENCHMAN_1_LEFT_ID, physicsBox, _map, _bonusProbability, _difficulty);
 }
 
 Henchman* Boss_1::_createHenchman_2(int xPos, int henchmanWidth, int henchmanHeight) noexcept {
-  PhysicsBox physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
-  return new Henchman_1(ASSET_HENCHMAN_1_RIGHT_ID, physicsBox, _map, this, _bonusProbability, _difficulty);
+  Body physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
+  return new Henchman_1(ASSET_HENCHMAN_1_RIGHT_ID, physicsBox, _map, _bonusProbability, _difficulty);
 }
 
-Boss_2::Boss_2(unsigned ID, const PhysicsBox& physicsBox, Map* map, double bonusProbability, double difficulty) noexcept
-    : Boss(ID, physicsBox, map, BOSS_HP, BOSS_FIRE_DELAY, bonusProbability, difficulty) {
+Boss_2::Boss_2(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept
+    : Boss(ID, physicsBox, map, Real(BOSS_HP), map->timing().bossFireDelay, bonusProbability, difficulty) {}
+
+void Boss_2::spawnEscort() noexcept {
   spawnHenchmen(ASSET_HENCHMAN_2_LEFT_WIDTH, ASSET_HENCHMAN_2_LEFT_HEIGHT, 4);
 }
 
+void Boss_2::save(EntityRecord& record) const noexcept {
+  Boss::save(record);
+  record.kind = KIND_BOSS_2;
+}
+
 Henchman* Boss_2::_createHenchman_1(int xPos, int henchmanWidth, int henchmanHeight) noexcept {
-  PhysicsBox physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
-  return new Henchman_2(ASSET_HENCHMAN_2_LEFT_ID, physicsBox, _map, this, _bonusProbability, _difficulty);
+  Body physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
+  return new Henchman_2(ASSET_HENCHMAN_2_LEFT_ID, physicsBox, _map, _bonusProbability, _difficulty);
 }
 
 Henchman* Boss_2::_createHenchman_2(int xPos, int henchmanWidth, int henchmanHeight) noexcept {
-  PhysicsBox physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
-  return new Henchman_1(ASSET_HENCHMAN_2_RIGHT_ID, physicsBox, _map, this, _bonusProbability, _difficulty);
+  Body physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
+  return new Henchman_1(ASSET_HENCHMAN_2_RIGHT_ID, physicsBox, _map, _bonusProbability, _difficulty);
 }
 
 void Boss_2::spawnHenchmen(int henchmanWidth, int henchmanHeight, unsigned nHenchman) noexcept {
@@ -658,19 +907,26 @@ void Boss_2::spawnHenchmen(int henchmanWidth, int henchmanHeight, unsigned nHenc
   }
 }
 
-Boss_3::Boss_3(unsigned ID, const PhysicsBox& physicsBox, Map* map, double bonusProbability, double difficulty) noexcept
-    : Boss(ID, physicsBox, map, BOSS_HP, BOSS_FIRE_DELAY, bonusProbability, difficulty) {
+Boss_3::Boss_3(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept
+    : Boss(ID, physicsBox, map, Real(BOSS_HP), map->timing().bossFireDelay, bonusProbability, difficulty) {}
+
+void Boss_3::spawnEscort() noexcept {
   spawnHenchmen(ASSET_HENCHMAN_3_LEFT_WIDTH, ASSET_HENCHMAN_3_LEFT_HEIGHT, 4);
 }
 
+void Boss_3::save(EntityRecord& record) const noexcept {
+  Boss::save(record);
+  record.kind = KIND_BOSS_3;
+}
+
 Henchman* Boss_3::_createHenchman_1(int xPos, int henchmanWidth, int henchmanHeight) noexcept {
-  PhysicsBox physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
-  return new Henchman_2(ASSET_HENCHMAN_3_LEFT_ID, physicsBox, _map, this, _bonusProbability, _difficulty);
+  Body physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
+  return new Henchman_2(ASSET_HENCHMAN_3_LEFT_ID, physicsBox, _map, _bonusProbability, _difficulty);
 }
 
 Henchman* Boss_3::_createHenchman_2(int xPos, int henchmanWidth, int henchmanHeight) noexcept {
-  PhysicsBox physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
-  return new Henchman_1(ASSET_HENCHMAN_3_RIGHT_ID, physicsBox, _map, this, _bonusProbability, _difficulty);
+  Body physicsBox(xPos, 0, henchmanWidth, henchmanHeight, 0, 0);
+  return new Henchman_1(ASSET_HENCHMAN_3_RIGHT_ID, physicsBox, _map, _bonusProbability, _difficulty);
 }
 
 void Boss_3::spawnHenchmen(int henchmanWidth, int henchmanHeight, unsigned nHenchman) noexcept {
@@ -694,7 +950,7 @@ void Boss_3::spawnHenchmen(int henchmanWidth, int henchmanHeight, unsigned nHenc
 *                               Henchman                             *
 **********************************************************************/
 
-const std::vector<std::array<int, 2>> Henchman::_moves = {
+constexpr MoveStep HENCHMAN_MOVES[] = {
     {1, 0},
     {1, 0},
     {1, 0},
@@ -708,28 +964,44 @@ const std::vector<std::array<int, 2>> Henchman::_moves = {
     {1, 0},
     {1, 0},
 };
+const MovePattern Henchman::_pattern(HENCHMAN_MOVES);
 
-Henchman::Henchman(unsigned ID, const PhysicsBox& physicsBox, Map* map, Boss* creator, double hp, unsigned fireDelay, double bonusProbability, double difficulty) noexcept
-    : Enemy(ID, physicsBox, map, hp, fireDelay, ENEMY_MAX_FIRE_DAMAGE, bonusProbability, difficulty), _creator(creator) {}
+Henchman::Henchman(unsigned ID, const Body& physicsBox, Map* map, Real hp, unsigned fireDelay, Real bonusProbability, Real difficulty) noexcept
+    : Enemy(ID, physicsBox, map, hp, fireDelay, Real(ENEMY_MAX_FIRE_DAMAGE), bonusProbability, difficulty) {}
 
-const std::vector<std::array<int, 2>>& Henchman::getMoves() const {
-  return _moves;
+const MovePattern& Henchman::pattern() const noexcept {
+  return _pattern;
 }
 
 void Henchman::shoot() noexcept {
   if (_remainingDelay == 0) {
-    _map->add(_createBullet(xSize() / 2, xVelocity() * 0.5));
+    _map->add(_createBullet(xSize() / 2, xVelocity() / 2));
     _remainingDelay = _fireDelay;
   } else {
     --_remainingDelay;
   }
 }
 
-Henchman_1::Henchman_1(unsigned ID, const PhysicsBox& physicsBox, Map* map, Boss* creator, double bonusProbability, double difficulty) noexcept
-    : Henchman(ID, physicsBox, map, creator, HENCHMAN_HP, HENCHMAN_FIRE_DELAY, bonusProbability, difficulty) {}
+Henchman_1::Henchman_1(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept
+    : Henchman(ID, physicsBox, map, Real(HENCHMAN_HP), map->timing().henchmanFireDelay, bonusProbability, difficulty) {}
+
+void Henchman_1::save(EntityRecord& record) const noexcept {
+  Enemy::save(record);
+  record.kind = KIND_HENCHMAN_1;
+}
+
+Henchman_2::Henchman_2(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept
+    : Henchman(ID, physicsBox, map, Real(HENCHMAN_HP), map->timing().henchmanFireDelay, bonusProbability, difficulty) {}
 
-Henchman_2::Henchman_2(unsigned ID, const PhysicsBox& physicsBox, Map* map, Boss* creator, double bonusProbability, double difficulty) noexcept
-    : Henchman(ID, physicsBox, map, creator, HENCHMAN_HP, HENCHMAN_FIRE_DELAY, bonusProbability, difficulty) {}
+void Henchman_2::save(EntityRecord& record) const noexcept {
+  Enemy::save(record);
+  record.kind = KIND_HENCHMAN_2;
+}
 
-Henchman_3::Henchman_3(unsigned ID, const PhysicsBox& physicsBox, Map* map, Boss* creator, double bonusProbability, double difficulty) noexcept
-    : Henchman(ID, physicsBox, map, creator, HENCHMAN_HP, HENCHMAN_FIRE_DELAY, bonusProbability, difficulty) {}
+Henchman_3::Henchman_3(unsigned ID, const Body& physicsBox, Map* map, Real bonusProbability, Real difficulty) noexcept
+    : Henchman(ID, physicsBox, map, Real(HENCHMAN_HP), map->timing().henchmanFireDelay, bonusProbability, difficulty) {}
+
+void Henchman_3::save(EntityRecord& record) const noexcept {
+  Enemy::save(record);
+  record.kind = KIND_HENCHMAN_3;
+}
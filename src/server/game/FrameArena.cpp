@@ -0,0 +1,57 @@
+#include "server/game/FrameArena.hpp"
+
+#include <cstring>
+
+unsigned char* FrameArena::_back() noexcept {
+  return _buffers[1 - _front].data();
+}
+
+std::size_t FrameArena::_entitiesOffset() const noexcept {
+  return sizeof(RefreshFrame) + _nbPlayers * sizeof(PlayerFrame);
+}
+
+void FrameArena::begin(std::size_t nbPlayers, std::size_t maxEntities) {
+  _nbPlayers = nbPlayers;
+  _nbEntities = 0;
+
+  std::vector<unsigned char>& buffer = _buffers[1 - _front];
+  std::size_t capacity = _entitiesOffset() + maxEntities * sizeof(EntityFrame);
+  if (buffer.size() < capacity) {
+    // Grown with some slack, so that a few more entities next tick do not reallocate
+    buffer.resize(capacity + capacity / 2);
+  }
+}
+
+void FrameArena::setPlayer(std::size_t nPlayer, const PlayerFrame& player) noexcept {
+  std::memcpy(_back() + sizeof(RefreshFrame) + nPlayer * sizeof(PlayerFrame), &player, sizeof(PlayerFrame));
+}
+
+void FrameArena::addEntity(const EntityFrame& entity) noexcept {
+  std::memcpy(_back() + _entitiesOffset() + _nbEntities * sizeof(EntityFrame), &entity, sizeof(EntityFrame));
+  ++_nbEntities;
+}
+
+void FrameArena::commit(RefreshFrame refresh) noexcept {
+  refresh.nbPlayers = unsigned(_nbPlayers);
+  refresh.nbEntities = _nbEntities;
+  std::memcpy(_back(), &refresh, sizeof(RefreshFrame));
+
+  _front = 1 - _front;
+  _sizes[_front] = _entitiesOffset() + _nbEntities * sizeof(EntityFrame);
+}
+
+const unsigned char* FrameArena::data() const noexcept {
+  return _buffers[_front].data();
+}
+
+std::size_t FrameArena::size() const noexcept {
+  return _sizes[_front];
+}
+
+RefreshFrame FrameArena::refreshFrame() const noexcept {
+  RefreshFrame refresh = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+  if (_sizes[_front] != 0) {
+    std::memcpy(&refresh, data(), sizeof(RefreshFrame));
+  }
+  return refresh;
+}
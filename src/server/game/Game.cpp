@@ -1,6 +1,8 @@
 #include "server/game/Game.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #include "Error.hpp"
 #include "assetsID.hpp"
@@ -9,106 +11,240 @@
 #include "server/game/players.hpp"
 #include "utils.hpp"
 
-Game::Game(const GameSettings& settings, DatabaseManager* databaseManager, const std::vector<int> levelIDs) noexcept
+Game::Game(const GameSettings& settings, LevelSource* levelSource, const std::vector<int> levelIDs, std::uint64_t seed) noexcept
     : Activity(),
-      _physicsEngine(settings.friendlyFire, settings.initialLives, settings.bonusProbability, settings.difficulty),
-      _levelManager(_physicsEngine, databaseManager, levelIDs),
-      _lastInteraction(getTimestamp()) {
-  for (unsigned p = 0; p != unsigned(settings.secondPlayer) + 1; ++p) {
-    unsigned nSkin = unsigned(settings.skins[p]);
-    _physicsEngine.newPlayer(p, {
-                                    std::get<PLAYER_INFO_ID>(playerInfo[nSkin]),
-                                    {
-                                        double((int(p) + 1) * MAP_WIDTH) / 3,
-                                        MAP_HEIGHT / 5 * 4,
-                                        std::get<PLAYER_INFO_WIDTH>(playerInfo[nSkin]),
-                                        std::get<PLAYER_INFO_HEIGHT>(playerInfo[nSkin]),
-                                        0,
-                                        0,
-                                    },
-                                });
+      _physicsEngine(settings.friendlyFire, settings.initialLives, settings.bonusProbability, settings.difficulty, settings.tickRate),
+      _levelManager(_physicsEngine, levelSource, levelIDs),
+      _lastInteraction(getTimestamp()),
+      _sendRate(std::min(std::max(settings.sendRate, 1u), _physicsEngine.timing().tickRate)),
+      _replayInfo{settings, levelIDs, seed, REAL_IS_FIXED} {
+  _physicsEngine.seedRandom(seed);
+  // Players are spread over the width of the map, a lone player spawns where the first of two would
+  unsigned nbPlayers = std::min(std::max(settings.nbPlayers, 1u), MAX_PLAYERS);
+  unsigned nbSlots = std::max(nbPlayers, 2u) + 1;
+  for (unsigned p = 0; p != nbPlayers; ++p) {
+    unsigned nSkin = unsigned(settings.skins[p]) % unsigned(playerInfo.size());
+    _physicsEngine.newPlayer({
+        std::get<PLAYER_INFO_ID>(playerInfo[nSkin]),
+        {
+            double((int(p) + 1) * MAP_WIDTH) / nbSlots,
+            MAP_HEIGHT / 5 * 4,
+            std::get<PLAYER_INFO_WIDTH>(playerInfo[nSkin]),
+            std::get<PLAYER_INFO_HEIGHT>(playerInfo[nSkin]),
+            0,
+            0,
+        },
+    });
   }
 }
 
+unsigned Game::tickRate() const noexcept {
+  return _physicsEngine.timing().tickRate;
+}
+
+unsigned Game::sendRate() const noexcept {
+  return _sendRate;
+}
+
 bool Game::won() const noexcept {
   return _levelManager.isEnded();
 }
 
 bool Game::lost() const noexcept {
+  return _lost(getTimestamp());
+}
+
+bool Game::_lost(long now) const noexcept {
   if (_stopped) {
     return true;
   }
 
   // If Client Disconnected
-  if (_lastInteraction != 0 && (getTimestamp() - _lastInteraction) / 1000000 >= CLIENT_TIMEOUT) {
+  if (_lastInteraction != 0 && (now - _lastInteraction) / 1000000 >= CLIENT_TIMEOUT) {
     return true;
   }
 
-  const Player* player1;
-  const Player* player2;
-  _physicsEngine.getPlayers(player1, player2);
-  return player1->hp() == 0 && ((player2) ? player2->hp() == 0 : true);
+  for (const Player* player: _physicsEngine.players()) {
+    if (player->hp() != 0) {
+      return false;
+    }
+  }
+  return true;
 }
 
 bool Game::hasEnded() const noexcept {
   return won() || lost();
 }
 
+int Game::_gameState(long now) const noexcept {
+  return (won()) ? 1 : (_lost(now)) ? -1
+                                    : 0;
+}
+
 RefreshFrame Game::getRefreshFrame() const noexcept {
-  const Player* player1;
-  const Player* player2;
-  _physicsEngine.getPlayers(player1, player2);
+  long now = getTimestamp();
   return {
-      (won()) ? 1 : (lost()) ? -1
-                             : 0,
-      getTimestamp(),
-      {player1->score(), (player2) ? player2->score() : 0},
-      {player1->hp(), (player2) ? player2->hp() : 0},
-      _levelManager.levelProgress() + _levelManager.currentLevel() * FRAMES_BY_LEVEL,
-      _physicsEngine.getEntityNumber()};
+      _gameState(now),
+      now,
+      _physicsEngine.timing().toFrames(_levelManager.progress()),
+      unsigned(_physicsEngine.players().size()),
+      _physicsEngine.getVisibleNumber(),
+      _appliedInput.sequence,
+      _appliedInput.received,
+      _appliedInput.applied,
+      getMonotonicTimestamp()};
+}
+
+std::vector<PlayerFrame>& Game::getPlayerFrames(std::vector<PlayerFrame>& dest) const noexcept {
+  for (const Player* player: _physicsEngine.players()) {
+    dest.push_back({player->score(), toDouble(player->hp())});
+  }
+  return dest;
 }
 
 std::vector<EntityFrame>& Game::getEntityFrames(std::vector<EntityFrame>& dest) const noexcept {
-  std::vector<Entity*> entities;
-  for (Entity* entity: _physicsEngine.getAllEntities(entities)) {
-    double hp = 0;
-    if (PhysicalEntity* pentity = dynamic_cast<PhysicalEntity*>(entity)) {
-      hp = pentity->hp();
-    }
+  double xCamera = toDouble(_physicsEngine.xCamera());
+  double yCamera = toDouble(_physicsEngine.yCamera());
+  _physicsEngine.forEachVisibleEntity([&](const Entity* entity) {
+    dest.push_back(_entityFrame(entity, xCamera, yCamera));
+  });
+  return dest;
+}
+
+EntityFrame Game::_entityFrame(const Entity* entity, double xCamera, double yCamera) const noexcept {
+  double hp = 0;
+  if (const PhysicalEntity* pentity = dynamic_cast<const PhysicalEntity*>(entity)) {
+    hp = toDouble(pentity->hp());
+  }
 
-    unsigned powerUpID = 0;
-    if (Player* player = dynamic_cast<Player*>(entity)) {
-      powerUpID = player->powerUpID();
-    } else if (Bullet* bullet = dynamic_cast<Bullet*>(entity)) {
-      if (bullet->getShooter()) {
-        powerUpID = (bullet->getShooter())->powerUpID();
-      }
+  unsigned powerUpID = 0;
+  if (const Player* player = dynamic_cast<const Player*>(entity)) {
+    powerUpID = player->powerUpID();
+  } else if (const Bullet* bullet = dynamic_cast<const Bullet*>(entity)) {
+    if (bullet->getShooter()) {
+      powerUpID = (bullet->getShooter())->powerUpID();
     }
+  }
 
-    dest.push_back({
-        entity->ID(),
-        entity->xPos(),
-        entity->yPos(),
-        hp,
-        entity->state(),
-        entity->stateStep(),
-        powerUpID,
-    });
+  // Positions are sent in the view of the camera
+  return {
+      entity->ID(),
+      toDouble(entity->xPos()) - xCamera,
+      toDouble(entity->yPos()) - yCamera,
+      hp,
+      entity->state(),
+      _physicsEngine.timing().toFrames(entity->stateStep()),
+      powerUpID,
+  };
+}
+
+const FrameArena& Game::buildFrame() {
+  const std::vector<Player*>& players = _physicsEngine.players();
+  _frames.begin(players.size(), _physicsEngine.getEntityNumber());
+
+  for (std::size_t p = 0; p != players.size(); ++p) {
+    _frames.setPlayer(p, {players[p]->score(), toDouble(players[p]->hp())});
   }
-  return dest;
+
+  double xCamera = toDouble(_physicsEngine.xCamera());
+  double yCamera = toDouble(_physicsEngine.yCamera());
+  _physicsEngine.forEachVisibleEntity([&](const Entity* entity) {
+    _frames.addEntity(_entityFrame(entity, xCamera, yCamera));
+  });
+
+  // Counts are filled in by the arena, the frame is sent once built
+  long now = getTimestamp();
+  _frames.commit({_gameState(now), now, _physicsEngine.timing().toFrames(_levelManager.progress()), 0, 0,
+                  _appliedInput.sequence, _appliedInput.received, _appliedInput.applied, getMonotonicTimestamp()});
+  return _frames;
+}
+
+const FrameArena& Game::frame() const noexcept {
+  return _frames;
+}
+
+void Game::setParallelThreshold(std::size_t threshold) noexcept {
+  _physicsEngine.setParallelThreshold(threshold);
+}
+
+void Game::record(const std::string& path) {
+  _recorder.reset(new ReplayRecorder(path, _replayInfo));
+}
+
+/* FNV-1a over the bytes of a value.
+ */
+template<typename T>
+static void hashValue(std::uint64_t& hash, const T& value) noexcept {
+  unsigned char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  for (unsigned char byte: bytes) {
+    hash = (hash ^ byte) * 0x100000001b3;
+  }
+}
+
+std::uint64_t Game::stateHash() const noexcept {
+  std::uint64_t hash = 0xcbf29ce484222325;
+  hashValue(hash, _levelManager.currentLevel());
+  hashValue(hash, _levelManager.levelProgress());
+
+  // A lone player is hashed as the first of two players
+  const std::vector<Player*>& players = _physicsEngine.players();
+  for (std::size_t p = 0; p != std::max<std::size_t>(players.size(), 2); ++p) {
+    hashValue(hash, (p < players.size()) ? players[p]->score() : 0u);
+  }
+
+  std::vector<Entity*> entities;
+  for (const Entity* entity: _physicsEngine.getAllEntities(entities)) {
+    hashValue(hash, entity->ID());
+    hashValue(hash, rawValue(entity->xPos()));
+    hashValue(hash, rawValue(entity->yPos()));
+    hashValue(hash, rawValue(entity->xVelocity()));
+    hashValue(hash, rawValue(entity->yVelocity()));
+    hashValue(hash, entity->state());
+    if (const PhysicalEntity* pentity = dynamic_cast<const PhysicalEntity*>(entity)) {
+      hashValue(hash, rawValue(pentity->hp()));
+    }
+  }
+  return hash;
+}
+
+void Game::snapshot(GameSnapshot& dest) const {
+  _levelManager.snapshot(dest);
+  _physicsEngine.snapshot(dest.world);
+}
+
+void Game::restore(const GameSnapshot& snapshot) {
+  // The level holds the patterns referenced by restored enemies
+  _levelManager.restore(snapshot);
+  _physicsEngine.restore(snapshot.world);
 }
 
 void Game::start() {
   _levelManager.loadLevel();
 }
 
-void Game::refresh() {
-  _physicsEngine.makeMoves();
-  _physicsEngine.cleanOffScreen();
-  _loadLevel();
-  _physicsEngine.makeAttacks();
-  _physicsEngine.checkCollisions();
-  _physicsEngine.refreshStates();
+void Game::refresh(TickPhases* phases) {
+  _applyQueuedInputs();
+  timePhase(phases ? &phases->moves : nullptr, [this]() { _physicsEngine.makeMoves(); });
+  timePhase(phases ? &phases->offScreen : nullptr, [this]() { _physicsEngine.cleanOffScreen(); });
+  _refreshEntities(phases);
+}
+
+void Game::_refreshEntities(TickPhases* phases) {
+  timePhase(phases ? &phases->loadLevel : nullptr, [this]() {
+    _loadLevel();
+    _physicsEngine.updateDormancy();
+  });
+  timePhase(phases ? &phases->attacks : nullptr, [this]() { _physicsEngine.makeAttacks(); });
+  timePhase(phases ? &phases->collisions : nullptr, [this]() { _physicsEngine.checkCollisions(); });
+  timePhase(phases ? &phases->states : nullptr, [this]() {
+    _physicsEngine.refreshStates();
+    _physicsEngine.followPlayers();
+  });
+
+  if (_recorder) {
+    _recorder->endTick(stateHash());
+  }
 }
 
 void Game::_loadLevel() {
@@ -121,8 +257,44 @@ void Game::_loadLevel() {
   _levelManager.loadLevel();
 }
 
+void Game::capDrops(bool capped) {
+  if (_recorder) {
+    _recorder->input(capped ? SERVER_CODE_CAP_DROPS : SERVER_CODE_UNCAP_DROPS);
+  }
+  _physicsEngine.capDrops(capped);
+}
+
+bool Game::dropsCapped() const noexcept {
+  return _physicsEngine.dropsCapped();
+}
+
+bool Game::queueInput(const QueuedInput& input) noexcept {
+  return _inputs.push(input);
+}
+
+void Game::_applyQueuedInputs() {
+  QueuedInput input;
+  bool applied = false;
+  while (_inputs.pop(input)) {
+    try {
+      applyInput(input.key);
+    } catch (std::exception&) {
+      // The escape key stops the game
+    }
+    _appliedInput.sequence = input.sequence;
+    _appliedInput.received = input.received;
+    applied = true;
+  }
+  if (applied) {
+    _appliedInput.applied = getMonotonicTimestamp();
+  }
+}
+
 void Game::applyInput(int key) {
   _lastInteraction = getTimestamp();
+  if (_recorder) {
+    _recorder->input(key);
+  }
 
   switch (key) {
     case GAME_KEY_ESC:
@@ -141,75 +313,82 @@ void Game::applyInput(int key) {
     case CHEAT_CODE_SKIP_LEVEL:
       _levelManager.skipLevel();
       break;
+    case SERVER_CODE_CAP_DROPS:
+      _physicsEngine.capDrops(true);
+      break;
+    case SERVER_CODE_UNCAP_DROPS:
+      _physicsEngine.capDrops(false);
+      break;
   }
 
-  switch (key >> 1) {
+  unsigned nPlayer = inputPlayer(key);
+  switch (inputKey(key)) {
     case GAME_KEY_UP:
-      _physicsEngine.setPlayerVelocityY(key & 1, -1);
+      _physicsEngine.setPlayerVelocityY(nPlayer, -1);
       break;
     case GAME_KEY_DOWN:
-      _physicsEngine.setPlayerVelocityY(key & 1, 1);
+      _physicsEngine.setPlayerVelocityY(nPlayer, 1);
       break;
     case GAME_KEY_RIGHT:
-      _physicsEngine.setPlayerVelocityX(key & 1, 1);
+      _physicsEngine.setPlayerVelocityX(nPlayer, 1);
       break;
     case GAME_KEY_LEFT:
-      _physicsEngine.setPlayerVelocityX(key & 1, -1);
+      _physicsEngine.setPlayerVelocityX(nPlayer, -1);
       break;
     case GAME_KEY_UP_RIGHT:
-      _physicsEngine.setPlayerVelocityX(key & 1, 1);
-      _physicsEngine.setPlayerVelocityY(key & 1, -1);
+      _physicsEngine.setPlayerVelocityX(nPlayer, 1);
+      _physicsEngine.setPlayerVelocityY(nPlayer, -1);
       break;
     case GAME_KEY_UP_LEFT:
-      _physicsEngine.setPlayerVelocityX(key & 1, -1);
-      _physicsEngine.setPlayerVelocityY(key & 1, -1);
+      _physicsEngine.setPlayerVelocityX(nPlayer, -1);
+      _physicsEngine.setPlayerVelocityY(nPlayer, -1);
       break;
     case GAME_KEY_DOWN_RIGHT:
-      _physicsEngine.setPlayerVelocityX(key & 1, 1);
-      _physicsEngine.setPlayerVelocityY(key & 1, 1);
+      _physicsEngine.setPlayerVelocityX(nPlayer, 1);
+      _physicsEngine.setPlayerVelocityY(nPlayer, 1);
       break;
     case GAME_KEY_DOWN_LEFT:
-      _physicsEngine.setPlayerVelocityX(key & 1, -1);
-      _physicsEngine.setPlayerVelocityY(key & 1, 1);
+      _physicsEngine.setPlayerVelocityX(nPlayer, -1);
+      _physicsEngine.setPlayerVelocityY(nPlayer, 1);
       break;
     case GAME_KEY_SHOOT:
-      _physicsEngine.playerShoot(key & 1);
+      _physicsEngine.playerShoot(nPlayer);
       break;
     case GAME_KEY_SHOOT_UP:
-      _physicsEngine.playerShoot(key & 1);
-      _physicsEngine.setPlayerVelocityY(key & 1, -1);
+      _physicsEngine.playerShoot(nPlayer);
+      _physicsEngine.setPlayerVelocityY(nPlayer, -1);
       break;
     case GAME_KEY_SHOOT_DOWN:
-      _physicsEngine.playerShoot(key & 1);
-      _physicsEngine.setPlayerVelocityY(key & 1, 1);
+      _physicsEngine.playerShoot(nPlayer);
+      _physicsEngine.setPlayerVelocityY(nPlayer, 1);
       break;
     case GAME_KEY_SHOOT_RIGHT:
-      _physicsEngine.playerShoot(key & 1);
-      _physicsEngine.setPlayerVelocityX(key & 1, 1);
+      _physicsEngine.playerShoot(nPlayer);
+      _physicsEngine.setPlayerVelocityX(nPlayer, 1);
       break;
     case GAME_KEY_SHOOT_LEFT:
-      _physicsEngine.playerShoot(key & 1);
-      _physicsEngine.setPlayerVelocityX(key & 1, -1);
+      _physicsEngine.playerShoot(nPlayer);
+      _physicsEngine.setPlayerVelocityX(nPlayer, -1);
       break;
     case GAME_KEY_SHOOT_UP_RIGHT:
-      _physicsEngine.playerShoot(key & 1);
-      _physicsEngine.setPlayerVelocityX(key & 1, 1);
-      _physicsEngine.setPlayerVelocityY(key & 1, -1);
+      _physicsEngine.playerShoot(nPlayer);
+      _physicsEngine.setPlayerVelocityX(nPlayer, 1);
+      _physicsEngine.setPlayerVelocityY(nPlayer, -1);
       break;
     case GAME_KEY_SHOOT_UP_LEFT:
-      _physicsEngine.playerShoot(key & 1);
-      _physicsEngine.setPlayerVelocityX(key & 1, -1);
-      _physicsEngine.setPlayerVelocityY(key & 1, -1);
+      _physicsEngine.playerShoot(nPlayer);
+      _physicsEngine.setPlayerVelocityX(nPlayer, -1);
+      _physicsEngine.setPlayerVelocityY(nPlayer, -1);
       break;
     case GAME_KEY_SHOOT_DOWN_RIGHT:
-      _physicsEngine.playerShoot(key & 1);
-      _physicsEngine.setPlayerVelocityX(key & 1, 1);
-      _physicsEngine.setPlayerVelocityY(key & 1, 1);
+      _physicsEngine.playerShoot(nPlayer);
+      _physicsEngine.setPlayerVelocityX(nPlayer, 1);
+      _physicsEngine.setPlayerVelocityY(nPlayer, 1);
       break;
     case GAME_KEY_SHOOT_DOWN_LEFT:
-      _physicsEngine.playerShoot(key & 1);
-      _physicsEngine.setPlayerVelocityX(key & 1, -1);
-      _physicsEngine.setPlayerVelocityY(key & 1, 1);
+      _physicsEngine.playerShoot(nPlayer);
+      _physicsEngine.setPlayerVelocityX(nPlayer, -1);
+      _physicsEngine.setPlayerVelocityY(nPlayer, 1);
       break;
   }
 }
@@ -0,0 +1,96 @@
+#include "server/game/GameBatch.hpp"
+
+#include <algorithm>
+
+#include "constants.hpp"
+#include "server/game/Group.hpp"
+#include "server/game/kernels.hpp"
+
+// Enemies come first so that their patterns are contiguous in the store
+static constexpr std::size_t STORE_ORDER[] = {ENEMY, PLAYER, BULLET, OBSTACLE, POWERUP};
+static constexpr std::size_t NB_GROUPS = sizeof(STORE_ORDER) / sizeof(STORE_ORDER[0]);
+
+void GameBatch::add(Game* game) {
+  _games.push_back(game);
+}
+
+void GameBatch::remove(const Game* game) noexcept {
+  _games.erase(std::remove(_games.begin(), _games.end(), game), _games.end());
+}
+
+std::size_t GameBatch::size() const noexcept {
+  return _games.size();
+}
+
+const std::vector<Game*>& GameBatch::games() const noexcept {
+  return _games;
+}
+
+void GameBatch::refresh(TickPhases* phases) {
+  _offsets.resize(_games.size() * NB_GROUPS);
+  for (Game* game: _games) {
+    game->_applyQueuedInputs();
+  }
+
+  timePhase(phases ? &phases->moves : nullptr, [this]() {
+    _store.clear();
+    for (std::size_t nGroup: STORE_ORDER) {
+      for (std::size_t g = 0; g != _games.size(); ++g) {
+        _offsets[g * NB_GROUPS + nGroup] = _store.size();
+        _games[g]->_physicsEngine.storeGroup(_store, nGroup);
+      }
+    }
+
+    // Enemies of consecutive games running at the same tick rate are evaluated in one pass
+    std::size_t from = 0;
+    for (std::size_t g = 0; g != _games.size(); ++g) {
+      bool last = g + 1 == _games.size();
+      if (last || _games[g + 1]->tickRate() != _games[g]->tickRate()) {
+        std::size_t to = (last) ? _store.patterns.size() : _offsets[(g + 1) * NB_GROUPS + ENEMY];
+        evaluatePatterns(&_store.patterns[from], &_store.cursors[from], to - from, _games[g]->_physicsEngine.timing(),
+                         &_store.xVelocity[from], &_store.yVelocity[from]);
+        from = to;
+      }
+    }
+    integratePositions(_store.xPos.data(), _store.yPos.data(), _store.xVelocity.data(), _store.yVelocity.data(), _store.size());
+
+    for (std::size_t g = 0; g != _games.size(); ++g) {
+      for (std::size_t nGroup: STORE_ORDER) {
+        _games[g]->_physicsEngine.loadMoves(_store, nGroup, _offsets[g * NB_GROUPS + nGroup]);
+      }
+    }
+  });
+
+  timePhase(phases ? &phases->offScreen : nullptr, [this]() {
+    // Entities of consecutive games sharing the same world are bounded in one pass by group
+    for (std::size_t first = 0; first != _games.size();) {
+      const Area& world = _games[first]->_physicsEngine.world();
+      std::size_t last = first + 1;
+      while (last != _games.size() && _games[last]->_physicsEngine.world() == world) {
+        ++last;
+      }
+
+      for (std::size_t o = 0; o != NB_GROUPS; ++o) {
+        std::size_t from = _offsets[first * NB_GROUPS + STORE_ORDER[o]];
+        std::size_t to = (last != _games.size()) ? _offsets[last * NB_GROUPS + STORE_ORDER[o]]
+                         : (o + 1 != NB_GROUPS) ? _offsets[STORE_ORDER[o + 1]]
+                                                : _store.size();
+        offBoundsMask(_store.xPos.data() + from, _store.yPos.data() + from, _store.xSize.data() + from, _store.ySize.data() + from, to - from,
+                      rawValue(Real(world.xMin)), rawValue(Real(world.yMin)), rawValue(Real(world.xMax)), rawValue(Real(world.yMax)),
+                      _store.mask.data() + from);
+      }
+      first = last;
+    }
+
+    // Groups are cleaned in the same order as `PhysicsEngine::cleanOffScreen`
+    for (std::size_t g = 0; g != _games.size(); ++g) {
+      for (std::size_t nGroup = 0; nGroup != NB_GROUPS; ++nGroup) {
+        _games[g]->_physicsEngine.cleanOffScreen(_store, nGroup, _offsets[g * NB_GROUPS + nGroup]);
+      }
+    }
+  });
+
+  for (Game* game: _games) {
+    game->_refreshEntities(phases);
+  }
+}
@@ -0,0 +1,19 @@
+#include "server/game/InputQueue.hpp"
+
+bool InputQueue::push(const QueuedInput& input) noexcept {
+  std::size_t tail = _tail.load(std::memory_order_relaxed);
+  if (tail - _head.load(std::memory_order_acquire) == CAPACITY) return false;
+
+  _inputs[tail % CAPACITY] = input;
+  _tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+bool InputQueue::pop(QueuedInput& input) noexcept {
+  std::size_t head = _head.load(std::memory_order_relaxed);
+  if (head == _tail.load(std::memory_order_acquire)) return false;
+
+  input = _inputs[head % CAPACITY];
+  _head.store(head + 1, std::memory_order_release);
+  return true;
+}
@@ -1,20 +1,25 @@
 #include "server/game/LevelManager.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 #include "constants.hpp"
 
-LevelManager::LevelManager(PhysicsEngine& physEngine, DatabaseManager* dbManager, const std::vector<int> levelIDs) noexcept
-    : _physicsEngine(&physEngine), _dbManager(dbManager) {
+LevelManager::LevelManager(PhysicsEngine& physEngine, LevelSource* levelSource, const std::vector<int> levelIDs) noexcept
+    : _physicsEngine(&physEngine),
+      _tickRate(physEngine.timing().tickRate),
+      _ticksByLevel(physEngine.timing().ticksByLevel),
+      _levelSource(levelSource) {
   if (levelIDs.size() == 0 || levelIDs[0] == -1) {
-    _dbManager->getLevels(_levels, -1, 0, "tijl");
+    _levelSource->getCampaign(_levels);
   } else {
     for (int lvlID: levelIDs) {
-      _levels.push_back(_dbManager->getLevelInfo(lvlID));
+      _levels.push_back(_levelSource->getLevelInfo(lvlID));
     }
   }
 
   // Load first level
-  _currentLevel = new Level();
-  _dbManager->populateLevel(*_currentLevel, _levels[0].id);
+  _readLevel(0);
 }
 
 LevelManager::~LevelManager() {
@@ -35,25 +40,47 @@ bool LevelManager::isEnded() const {
 
 void LevelManager::nextLevel() {
   _physicsEngine->clearMap();
+  // Players respawn in the view of the camera, which starts at the origin of the new world
+  _readLevel(currentLevel());
   _physicsEngine->resetStates();
+}
 
+void LevelManager::_readLevel(unsigned nLevel) {
   delete _currentLevel;
   _currentLevel = new Level();
-  _dbManager->populateLevel(*_currentLevel, _levels[currentLevel()].id);
+  _levelSource->populateLevel(*_currentLevel, _levels[nLevel].id);
+  _loadedLevel = nLevel;
+
+  // The world holds the screen and every entity spawned by the level
+  Area world;
+  for (const Level::value_type& spawn: *_currentLevel) {
+    for (const EntityInfo& entity: spawn.second) {
+      PhysicsBox box = entity.physicsBox();
+      world.xMin = std::min(world.xMin, int(std::floor(box.xPos)));
+      world.yMin = std::min(world.yMin, int(std::floor(box.yPos)));
+      world.xMax = std::max(world.xMax, int(std::ceil(box.xPos)) + box.xSize);
+      world.yMax = std::max(world.yMax, int(std::ceil(box.yPos)) + box.ySize);
+    }
+  }
+  _physicsEngine->setWorld(world);
+
+  LevelPatterns patterns;
+  _levelSource->populatePatterns(patterns, _levels[nLevel].id);
+  _physicsEngine->setLevelPatterns(patterns);
 }
 
 void LevelManager::loadLevel() {
   unsigned progress = levelProgress();
-  if (progress % FPS == 0) {
-    if (_currentLevel->count(progress / FPS)) {
-      for (const EntityInfo& entity: _currentLevel->at(progress / FPS)) {
+  if (progress % _tickRate == 0) {
+    if (_currentLevel->count(progress / _tickRate)) {
+      for (const EntityInfo& entity: _currentLevel->at(progress / _tickRate)) {
         _physicsEngine->newEntity(entity);
       }
     }
   }
 
   if (!_lockedProgress) {
-    if (levelProgress() >= FRAMES_BY_LEVEL * 0.9) {
+    if (levelProgress() >= _ticksByLevel * 0.9) {
       _lockProgress();
     }
 
@@ -67,6 +94,20 @@ void LevelManager::loadLevel() {
 
 void LevelManager::skipLevel() noexcept {
   if (currentLevel() < int(_levels.size())) {
-    _progress = (currentLevel() + 1) * FRAMES_BY_LEVEL;
+    _progress = (currentLevel() + 1) * _ticksByLevel;
+  }
+}
+
+void LevelManager::snapshot(GameSnapshot& dest) const noexcept {
+  dest.progress = _progress;
+  dest.lockedProgress = _lockedProgress;
+  dest.loadedLevel = _loadedLevel;
+}
+
+void LevelManager::restore(const GameSnapshot& snapshot) {
+  if (snapshot.loadedLevel != _loadedLevel) {
+    _readLevel(snapshot.loadedLevel);
   }
+  _progress = snapshot.progress;
+  _lockedProgress = snapshot.lockedProgress;
 }
@@ -1,6 +1,8 @@
 #include "server/game/Map.hpp"
 
-Map::Map() noexcept {
+#include <algorithm>
+
+Map::Map(unsigned tickRate) noexcept: _random(std::random_device()()), _timing(tickRate) {
   for (size_t g = 0; g < NB_GROUPS; ++g) {
     _groups[g] = new Group();
   }
@@ -48,8 +50,68 @@ std::size_t Map::nbEntities(std::size_t nGroup) const noexcept {
 }
 
 bool Map::isOffMap(const Entity* entity) const noexcept {
-  return !(0 < entity->xPos() + entity->xSize() &&
-           MAP_WIDTH > entity->xPos() &&
-           0 < entity->yPos() + entity->ySize() &&
-           MAP_HEIGHT > entity->yPos());
+  return !(_world.xMin < entity->xPos() + entity->xSize() &&
+           _world.xMax > entity->xPos() &&
+           _world.yMin < entity->yPos() + entity->ySize() &&
+           _world.yMax > entity->yPos());
+}
+
+const Area& Map::world() const noexcept {
+  return _world;
+}
+
+void Map::setWorld(const Area& world) noexcept {
+  _world = world;
+  moveCamera(0, 0);
+}
+
+Real Map::xCamera() const noexcept {
+  return _xCamera;
+}
+
+Real Map::yCamera() const noexcept {
+  return _yCamera;
+}
+
+void Map::moveCamera(Real xPos, Real yPos) noexcept {
+  _xCamera = std::min(std::max(xPos, Real(_world.xMin)), Real(_world.xMax - MAP_WIDTH));
+  _yCamera = std::min(std::max(yPos, Real(_world.yMin)), Real(_world.yMax - MAP_HEIGHT));
+}
+
+bool Map::activeRegion(Real& xMin, Real& yMin, Real& xMax, Real& yMax) const noexcept {
+  xMin = _xCamera - ACTIVE_MARGIN;
+  yMin = _yCamera - ACTIVE_MARGIN;
+  xMax = _xCamera + (MAP_WIDTH + ACTIVE_MARGIN);
+  yMax = _yCamera + (MAP_HEIGHT + ACTIVE_MARGIN);
+  return xMin <= Real(_world.xMin) && yMin <= Real(_world.yMin) && xMax >= Real(_world.xMax) && yMax >= Real(_world.yMax);
+}
+
+const Timing& Map::timing() const noexcept {
+  return _timing;
+}
+
+bool Map::dropsCapped() const noexcept {
+  return _dropsCapped;
+}
+
+void Map::capDrops(bool capped) noexcept {
+  _dropsCapped = capped;
+}
+
+void Map::seedRandom(std::uint64_t seed) noexcept {
+  _random.seed(seed);
+}
+
+double Map::genRandomDouble(double min, double max) noexcept {
+  // Unlike std::uniform_real_distribution, this gives the same numbers with any standard library
+  double unit = double(_random() >> 11) * 0x1p-53;
+  return min + (max - min) * unit;
+}
+
+const std::mt19937_64& Map::randomState() const noexcept {
+  return _random;
+}
+
+void Map::setRandomState(const std::mt19937_64& random) noexcept {
+  _random = random;
 }
@@ -0,0 +1,40 @@
+#include "server/game/MovePattern.hpp"
+
+#include <sstream>
+
+#include "Error.hpp"
+#include "constants.hpp"
+
+std::vector<MoveStep> parseMoveSteps(const std::string& text) {
+  std::vector<MoveStep> steps;
+  std::istringstream stream(text);
+  std::string token;
+
+  while (stream >> token) {
+    int x, y;
+    char separator;
+    std::istringstream tokenStream(token);
+    if (!(tokenStream >> x >> separator >> y) || separator != ':' || !tokenStream.eof() ||
+        x < INT8_MIN || x > INT8_MAX || y < INT8_MIN || y > INT8_MAX) {
+      throw Error("Invalid step in movement pattern: " + token);
+    }
+    steps.push_back({std::int8_t(x), std::int8_t(y)});
+  }
+
+  if (steps.empty()) {
+    throw Error("Empty movement pattern");
+  }
+  return steps;
+}
+
+void evaluatePatterns(
+    const MovePattern* const* patterns, std::size_t* cursors, std::size_t n, const Timing& timing,
+    RealRaw* xVelocity, RealRaw* yVelocity) noexcept {
+  for (std::size_t i = 0; i != n; ++i) {
+    const MovePattern& pattern = *patterns[i];
+    const MoveStep& step = pattern.step(cursors[i] / timing.tickRate);
+    xVelocity[i] = rawValue(Real(step.x) * timing.enemyVelocityX);
+    yVelocity[i] = rawValue(Real(step.y) * timing.enemyVelocityY);
+    cursors[i] = (cursors[i] + FPS) % (pattern.length() * timing.tickRate);
+  }
+}
@@ -1,17 +1,24 @@
 #include "server/game/PhysicsEngine.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <utility>
 
+#include "Error.hpp"
 #include "assetsID.hpp"
+#include "server/game/kernels.hpp"
 
-PhysicsEngine::PhysicsEngine(bool friendlyFire, unsigned initialLives, double bonusProbability, double difficulty) noexcept
-    : _map(new Map()),
+PhysicsEngine::PhysicsEngine(bool friendlyFire, unsigned initialLives, double bonusProbability, double difficulty, unsigned tickRate) noexcept
+    : _map(new Map(tickRate)),
       _friendlyFire(friendlyFire),
       _initialLives(initialLives),
-      _bonusProbability(bonusProbability),
-      _difficulty(difficulty) {}
+      _bonusProbability(Real(bonusProbability)),
+      _difficulty(Real(difficulty)) {
+  setWorld(Area());
+}
 
 PhysicsEngine::~PhysicsEngine() noexcept {
+  _deleteDormant();
   delete _map;
 }
 
@@ -52,19 +59,42 @@ void PhysicsEngine::newEntity(const EntityInfo& entityInfo) {
   }
 
   if (entity) {
+    if (Boss* boss = dynamic_cast<Boss*>(entity)) {
+      boss->spawnEscort();
+    }
+    if (Enemy* enemy = dynamic_cast<Enemy*>(entity)) {
+      std::map<unsigned, MovePattern>::const_iterator pattern = _levelPatterns.find(entityInfo.fullType());
+      if (pattern != _levelPatterns.end()) {
+        enemy->setLevelPattern(&pattern->second);
+      }
+    }
     _map->add(entity);
   }
 }
 
-void PhysicsEngine::newPlayer(std::size_t nPlayer, const EntityInfo& entityInfo) noexcept {
-  _players[nPlayer] = new Player(entityInfo.fullType(), entityInfo.physicsBox(), _map, _friendlyFire, _initialLives);
-  _map->add(_players[nPlayer]);
+void PhysicsEngine::setLevelPatterns(const LevelPatterns& patterns) {
+  _levelSteps = patterns;
+  _levelPatterns.clear();
+  for (const LevelPatterns::value_type& pattern: _levelSteps) {
+    _levelPatterns.insert({pattern.first, MovePattern(pattern.second.data(), pattern.second.size())});
+  }
+}
+
+void PhysicsEngine::newPlayer(const EntityInfo& entityInfo) {
+  _players.push_back(new Player(entityInfo.fullType(), entityInfo.physicsBox(), _map, _friendlyFire, _initialLives));
+  _map->add(_players.back());
 }
 
 void PhysicsEngine::refreshStates() {
+  _updateParallelMode();
+
+  // States only depend on the entity itself
   for (Group* group: _map->groups()) {
-    for (Entity* entity: group->entities()) {
-      entity->refreshState();
+    Group::Entities& entities = group->entities();
+    long nEntities = long(entities.size());
+#pragma omp parallel for if (_parallel) schedule(static)
+    for (long e = 0; e < nEntities; ++e) {
+      entities[std::size_t(e)]->refreshState();
     }
   }
 }
@@ -79,59 +109,367 @@ void PhysicsEngine::makeAttacks() {
 
 void PhysicsEngine::resetStates() {
   for (Player* player: _players) {
-    if (player) {
-      if (player->checkDeath()) {
-        player->respawn();
-        _map->add(player);
+    if (player->checkDeath()) {
+      player->respawn();
+      _map->add(player);
+    }
+
+    player->resetState();
+  }
+}
+
+void PhysicsEngine::setParallelThreshold(std::size_t threshold) noexcept {
+  _parallelThreshold = threshold;
+}
+
+bool PhysicsEngine::isParallel() const noexcept {
+  return _parallel;
+}
+
+const Timing& PhysicsEngine::timing() const noexcept {
+  return _map->timing();
+}
+
+void PhysicsEngine::capDrops(bool capped) noexcept {
+  _map->capDrops(capped);
+}
+
+bool PhysicsEngine::dropsCapped() const noexcept {
+  return _map->dropsCapped();
+}
+
+void PhysicsEngine::seedRandom(std::uint64_t seed) noexcept {
+  _map->seedRandom(seed);
+}
+
+void PhysicsEngine::setWorld(const Area& world) {
+  std::vector<Dormant> dormant;
+  for (std::vector<Dormant>& cell: _dormantCells) {
+    dormant.insert(dormant.end(), cell.begin(), cell.end());
+  }
+
+  _map->setWorld(world);
+  _cellsByRow = std::size_t((world.xMax - world.xMin + DORMANT_CELL_SIZE - 1) / DORMANT_CELL_SIZE);
+  std::size_t nRows = std::size_t((world.yMax - world.yMin + DORMANT_CELL_SIZE - 1) / DORMANT_CELL_SIZE);
+  _dormantCells.assign(_cellsByRow * nRows, {});
+
+  _nbDormant = 0;
+  for (const Dormant& entry: dormant) {
+    _sleep(entry.entity, entry.group);
+  }
+}
+
+const Area& PhysicsEngine::world() const noexcept {
+  return _map->world();
+}
+
+std::size_t PhysicsEngine::_cellOf(const Entity* entity) const noexcept {
+  const Area& world = _map->world();
+  long nRows = long(_dormantCells.size() / _cellsByRow);
+  long column = std::min(std::max(long(std::floor(toDouble(entity->xPos()) - world.xMin)) / DORMANT_CELL_SIZE, 0L), long(_cellsByRow) - 1);
+  long row = std::min(std::max(long(std::floor(toDouble(entity->yPos()) - world.yMin)) / DORMANT_CELL_SIZE, 0L), nRows - 1);
+  return std::size_t(row) * _cellsByRow + std::size_t(column);
+}
+
+void PhysicsEngine::_sleep(Entity* entity, std::size_t nGroup) {
+  entity->removeFromGroup();
+  entity->_xMove = 0;
+  entity->_yMove = 0;
+  _dormantCells[_cellOf(entity)].push_back({entity, nGroup});
+  _maxDormantSize = std::max({_maxDormantSize, entity->xSize(), entity->ySize()});
+  ++_nbDormant;
+}
+
+void PhysicsEngine::_deleteDormant() noexcept {
+  for (std::vector<Dormant>& cell: _dormantCells) {
+    for (const Dormant& entry: cell) {
+      delete entry.entity;
+    }
+    cell.clear();
+  }
+  _nbDormant = 0;
+}
+
+void PhysicsEngine::updateDormancy() {
+  Real xMin, yMin, xMax, yMax;
+  if (_map->activeRegion(xMin, yMin, xMax, yMax) && _nbDormant == 0) return;
+
+  for (std::size_t nGroup: {ENEMY, BULLET, OBSTACLE, POWERUP}) {
+    Group& group = _map->group(nGroup);
+    _gather(group.entities());
+    offBoundsMask(_batch.xPos.data(), _batch.yPos.data(), _batch.xSize.data(), _batch.ySize.data(), _batch.size(),
+                  rawValue(xMin), rawValue(yMin), rawValue(xMax), rawValue(yMax),
+                  _batch.mask.data());
+
+    for (std::size_t e = _batch.size(); e-- != 0;) {
+      if (_batch.mask[e]) {
+        if (nGroup == BULLET) {
+          delete group.entity(e);
+        } else {
+          _sleep(group.entity(e), nGroup);
+        }
       }
+    }
+  }
 
-      player->resetState();
+  if (_nbDormant == 0) return;
+
+  // Cells holding the position of an entity overlapping the active region
+  const Area& world = _map->world();
+  long nRows = long(_dormantCells.size() / _cellsByRow);
+  long firstColumn = std::max(long(std::floor(toDouble(xMin) - world.xMin - _maxDormantSize)) / DORMANT_CELL_SIZE, 0L);
+  long lastColumn = std::min(long(std::floor(toDouble(xMax) - world.xMin)) / DORMANT_CELL_SIZE, long(_cellsByRow) - 1);
+  long firstRow = std::max(long(std::floor(toDouble(yMin) - world.yMin - _maxDormantSize)) / DORMANT_CELL_SIZE, 0L);
+  long lastRow = std::min(long(std::floor(toDouble(yMax) - world.yMin)) / DORMANT_CELL_SIZE, nRows - 1);
+
+  for (long row = firstRow; row <= lastRow; ++row) {
+    for (long column = firstColumn; column <= lastColumn; ++column) {
+      std::vector<Dormant>& cell = _dormantCells[std::size_t(row) * _cellsByRow + std::size_t(column)];
+      std::size_t kept = 0;
+      for (const Dormant& entry: cell) {
+        Entity* entity = entry.entity;
+        if (xMin < entity->xPos() + entity->xSize() && xMax > entity->xPos() &&
+            yMin < entity->yPos() + entity->ySize() && yMax > entity->yPos()) {
+          entity->_group = &_map->group(entry.group);
+          _map->add(entity);
+          --_nbDormant;
+        } else {
+          cell[kept++] = entry;
+        }
+      }
+      cell.resize(kept);
     }
   }
 }
 
+void PhysicsEngine::followPlayers() noexcept {
+  Group::Entities& players = _map->group(PLAYER).entities();
+  if (players.empty()) return;
+
+  Real xCenter = 0;
+  Real yCenter = 0;
+  for (const Entity* player: players) {
+    xCenter += player->xPos() + Real(player->xSize()) / 2;
+    yCenter += player->yPos() + Real(player->ySize()) / 2;
+  }
+  Real nPlayers = Real(int(players.size()));
+  _map->moveCamera(xCenter / nPlayers - Real(MAP_WIDTH) / 2, yCenter / nPlayers - Real(MAP_HEIGHT) / 2);
+}
+
+void PhysicsEngine::_updateParallelMode() noexcept {
+  _parallel = _parallelThreshold != 0 && getEntityNumber() >= _parallelThreshold;
+}
+
+std::size_t PhysicsEngine::Batch::nextLive(std::size_t idx) const noexcept {
+  while (idx < size() && dead[idx]) {
+    ++idx;
+  }
+  return std::min(idx, size());
+}
+
+void PhysicsEngine::_gather(Group::Entities& entities) noexcept {
+  std::size_t n = entities.size();
+  _batch.xPos.resize(n);
+  _batch.yPos.resize(n);
+  _batch.xSize.resize(n);
+  _batch.ySize.resize(n);
+  _batch.xVelocity.resize(n);
+  _batch.yVelocity.resize(n);
+  _batch.mask.resize(n);
+  _batch.dead.assign(n, 0);
+  _batch.xSweep.resize(n);
+  _batch.ySweep.resize(n);
+  _batch.xSweepSize.resize(n);
+  _batch.ySweepSize.resize(n);
+
+#pragma omp parallel for if (_parallel) schedule(static)
+  for (long e = 0; e < long(n); ++e) {
+    _update(std::size_t(e), entities[std::size_t(e)]);
+  }
+}
+
+void PhysicsEngine::_gatherSwept(Group::Entities& entities) noexcept {
+  _gather(entities);
+
+#pragma omp parallel for if (_parallel) schedule(static)
+  for (long e = 0; e < long(entities.size()); ++e) {
+    std::size_t idx = std::size_t(e);
+    _sweptBox(entities[idx], _batch.xSweep[idx], _batch.ySweep[idx], _batch.xSweepSize[idx], _batch.ySweepSize[idx]);
+  }
+}
+
+void PhysicsEngine::_update(std::size_t idx, const Entity* entity) noexcept {
+  const Body& box = entity->_physicsBox;
+  _batch.xPos[idx] = rawValue(box.xPos);
+  _batch.yPos[idx] = rawValue(box.yPos);
+  _batch.xSize[idx] = rawValue(Real(box.xSize));
+  _batch.ySize[idx] = rawValue(Real(box.ySize));
+  _batch.xVelocity[idx] = rawValue(box.xVelocity);
+  _batch.yVelocity[idx] = rawValue(box.yVelocity);
+}
+
+void PhysicsEngine::_sweptBox(const Entity* entity, RealRaw& xPos, RealRaw& yPos, RealRaw& xSize, RealRaw& ySize) noexcept {
+  const Body& box = entity->_physicsBox;
+  Real xMove = entity->_xMove;
+  Real yMove = entity->_yMove;
+  xPos = rawValue((xMove > 0) ? box.xPos - xMove : box.xPos);
+  yPos = rawValue((yMove > 0) ? box.yPos - yMove : box.yPos);
+  xSize = rawValue(Real(box.xSize) + ((xMove > 0) ? xMove : -xMove));
+  ySize = rawValue(Real(box.ySize) + ((yMove > 0) ? yMove : -yMove));
+}
+
+void PhysicsEngine::_updateSwept(std::size_t idx, const Entity* entity) noexcept {
+  _update(idx, entity);
+  _sweptBox(entity, _batch.xSweep[idx], _batch.ySweep[idx], _batch.xSweepSize[idx], _batch.ySweepSize[idx]);
+}
+
+void PhysicsEngine::_computeTouchMask(const Entity* entity, std::size_t from) noexcept {
+  _batch.xRef = rawValue(entity->_physicsBox.xPos);
+  _batch.yRef = rawValue(entity->_physicsBox.yPos);
+
+  if (from < _batch.size()) {
+    RealRaw xPos, yPos, xSize, ySize;
+    _sweptBox(entity, xPos, yPos, xSize, ySize);
+    touchMask(xPos, yPos, xSize, ySize,
+              &_batch.xSweep[from], &_batch.ySweep[from], &_batch.xSweepSize[from], &_batch.ySweepSize[from], _batch.size() - from,
+              &_batch.mask[from]);
+  }
+}
+
 void PhysicsEngine::makeMoves() {
+  _updateParallelMode();
+
   for (Group* group: _map->groups()) {
-    for (Entity* entityPtr: group->entities()) {
-      entityPtr->move();
+    Group::Entities& entities = group->entities();
+    long nEntities = long(entities.size());
+
+    _gather(entities);
+
+    // Enemies follow their movement pattern, other entities only integrate their velocity
+    if (group == &_map->group(ENEMY)) {
+      _moveEnemies(entities);
+    }
+    integratePositions(_batch.xPos.data(), _batch.yPos.data(), _batch.xVelocity.data(), _batch.yVelocity.data(), _batch.size());
+#pragma omp parallel for if (_parallel) schedule(static)
+    for (long e = 0; e < nEntities; ++e) {
+      Entity* entity = entities[std::size_t(e)];
+      Real xPos = fromRaw(_batch.xPos[std::size_t(e)]);
+      Real yPos = fromRaw(_batch.yPos[std::size_t(e)]);
+      entity->_xMove = xPos - entity->_physicsBox.xPos;
+      entity->_yMove = yPos - entity->_physicsBox.yPos;
+      entity->_physicsBox.xPos = xPos;
+      entity->_physicsBox.yPos = yPos;
     }
   }
 }
 
+/* Evaluate the patterns of the gathered enemies and set their velocities.
+ */
+void PhysicsEngine::_moveEnemies(Group::Entities& entities) noexcept {
+  std::size_t n = entities.size();
+  _patterns.resize(n);
+  _cursors.resize(n);
+  for (std::size_t e = 0; e != n; ++e) {
+    Enemy* enemy = static_cast<Enemy*>(entities[e]);
+    _patterns[e] = &enemy->currentPattern();
+    _cursors[e] = enemy->_counter;
+  }
+
+  evaluatePatterns(_patterns.data(), _cursors.data(), n, _map->timing(), _batch.xVelocity.data(), _batch.yVelocity.data());
+
+  for (std::size_t e = 0; e != n; ++e) {
+    Enemy* enemy = static_cast<Enemy*>(entities[e]);
+    enemy->_counter = _cursors[e];
+    enemy->_physicsBox.xVelocity = fromRaw(_batch.xVelocity[e]);
+    enemy->_physicsBox.yVelocity = fromRaw(_batch.yVelocity[e]);
+  }
+}
+
 void PhysicsEngine::cleanOffScreen() {
   for (Group* group: _map->groups()) {
-    for (size_t e = 0; e != group->size(); ++e) {
-      if (_map->isOffMap(group->entity(e))) {
+    _gather(group->entities());
+    const Area& world = _map->world();
+    offBoundsMask(_batch.xPos.data(), _batch.yPos.data(), _batch.xSize.data(), _batch.ySize.data(), _batch.size(),
+                  rawValue(Real(world.xMin)), rawValue(Real(world.yMin)), rawValue(Real(world.xMax)), rawValue(Real(world.yMax)),
+                  _batch.mask.data());
+
+    // Delete from the end so that the indices of the batch remain valid
+    for (std::size_t e = _batch.size(); e-- != 0;) {
+      if (_batch.mask[e]) {
         delete group->entity(e);
-        --e;
       }
     }
   }
 }
 
-void PhysicsEngine::_checkCollision(Group::Entities::iterator& entityIt1, Group::Entities::iterator& entityIt2) {
-  Entity* entity1 = *entityIt1;
-  Entity* entity2 = *entityIt2;
+void PhysicsEngine::storeGroup(WorldStore& store, std::size_t nGroup) {
+  for (const Entity* entity: _map->group(nGroup).entities()) {
+    const Body& box = entity->_physicsBox;
+    store.xPos.push_back(rawValue(box.xPos));
+    store.yPos.push_back(rawValue(box.yPos));
+    store.xSize.push_back(rawValue(Real(box.xSize)));
+    store.ySize.push_back(rawValue(Real(box.ySize)));
+    store.xVelocity.push_back(rawValue(box.xVelocity));
+    store.yVelocity.push_back(rawValue(box.yVelocity));
+
+    if (nGroup == ENEMY) {
+      const Enemy* enemy = static_cast<const Enemy*>(entity);
+      store.patterns.push_back(&enemy->currentPattern());
+      store.cursors.push_back(enemy->_counter);
+    }
+  }
+  store.mask.resize(store.size());
+}
+
+void PhysicsEngine::loadMoves(const WorldStore& store, std::size_t nGroup, std::size_t from) noexcept {
+  Group::Entities& entities = _map->group(nGroup).entities();
+  for (std::size_t e = 0; e != entities.size(); ++e) {
+    Body& box = entities[e]->_physicsBox;
+    Real xPos = fromRaw(store.xPos[from + e]);
+    Real yPos = fromRaw(store.yPos[from + e]);
+    entities[e]->_xMove = xPos - box.xPos;
+    entities[e]->_yMove = yPos - box.yPos;
+    box.xPos = xPos;
+    box.yPos = yPos;
+
+    if (nGroup == ENEMY) {
+      box.xVelocity = fromRaw(store.xVelocity[from + e]);
+      box.yVelocity = fromRaw(store.yVelocity[from + e]);
+      static_cast<Enemy*>(entities[e])->_counter = store.cursors[from + e];
+    }
+  }
+}
+
+void PhysicsEngine::cleanOffScreen(const WorldStore& store, std::size_t nGroup, std::size_t from) {
+  Group& group = _map->group(nGroup);
+  for (std::size_t e = group.size(); e-- != 0;) {
+    if (store.mask[from + e]) {
+      delete group.entity(e);
+    }
+  }
+}
+
+unsigned PhysicsEngine::_checkCollision(Entity* entity1, Entity* entity2) {
+  unsigned outcome = 0;
+
+  entity1->_collisionEpoch = _collisionEpoch;
+  entity2->_collisionEpoch = _collisionEpoch;
 
   if (entity1->isTouching(entity2)) {
     entity1->touch(entity2);
+    outcome |= COLLISION_TOUCHED;
 
     if (dynamic_cast<Player*>(entity1) && dynamic_cast<PowerUp*>(entity2)) {
-      --entityIt2;
+      outcome |= COLLISION_REMOVED_2;
     }
   }
 
-  size_t nEntity = 0;
+  unsigned removedFlag = COLLISION_REMOVED_1;
   for (Entity* entity: {entity1, entity2}) {
     if (PhysicalEntity* pEntity = dynamic_cast<PhysicalEntity*>(entity)) {
       if (pEntity->checkDeath()) {
         pEntity->kill();
-
-        if (nEntity == 0) {
-          --entityIt1;
-        } else {
-          --entityIt2;
-        }
+        outcome |= removedFlag;
 
         // Delete dead entities except players
         if (!dynamic_cast<Player*>(pEntity)) {
@@ -139,35 +477,174 @@ void PhysicsEngine::_checkCollision(Group::Entities::iterator& entityIt1, Group:
         }
       }
     }
-    ++nEntity;
+    removedFlag = COLLISION_REMOVED_2;
   }
+
+  return outcome;
 }
 
-void PhysicsEngine::checkCollisions() {
-  for (Group* group1: _map->groups()) {
-    for (Group* group2: group1->collisionGroups()) {
-      Group::Entities::iterator entityIt1 = group1->entities().begin();
-      while (entityIt1 != group1->entities().end()) {
-        Group::Entities::iterator initialEntityIt1 = entityIt1;
+/* Broad phase of the parallel tick: touch masks of every entity of group1
+ *  against the gathered batch, one row per entity, rows computed in parallel.
+ * Return false if the masks would not fit in memory.
+ */
+bool PhysicsEngine::_precomputeTouchRows(Group& group1, bool sameGroup) noexcept {
+  std::size_t nRows = group1.size();
+  _rowLength = _batch.size();
+  if (nRows * _rowLength > PARALLEL_MAX_TOUCH_ROWS) {
+    return false;
+  }
 
-        Group::Entities::iterator entityIt2 = (group1 == group2) ? entityIt1 + 1 : group2->entities().begin();
-        while (entityIt2 != group2->entities().end()) {
-          _checkCollision(entityIt1, entityIt2);
+  _touchRows.resize(nRows * _rowLength);
+
+  Group::Entities& entities = group1.entities();
+#pragma omp parallel for schedule(dynamic, 16)
+  for (long r = 0; r < long(nRows); ++r) {
+    std::size_t row = std::size_t(r);
+    std::size_t from = sameGroup ? row + 1 : 0;
+    if (from < _rowLength) {
+      RealRaw xPos, yPos, xSize, ySize;
+      _sweptBox(entities[row], xPos, yPos, xSize, ySize);
+      touchMask(xPos, yPos, xSize, ySize,
+                &_batch.xSweep[from], &_batch.ySweep[from], &_batch.xSweepSize[from], &_batch.ySweepSize[from], _rowLength - from,
+                &_touchRows[row * _rowLength + from]);
+    }
+  }
+  return true;
+}
+
+/* Pairs are visited in the same order as a plain nested loop would do, and
+ *  their effects (damage, deaths, drops) are applied serially in that order.
+ * A pair is skipped only if it can not have any effect: the boxes do not overlap
+ *  (broad-phase mask) and the death of both entities has already been checked
+ *  since they were last touched (checking it again would be a no-op).
+ */
+void PhysicsEngine::_checkCollisions(Group& group1, Group& group2) {
+  bool sameGroup = &group1 == &group2;
+  _gatherSwept(group2.entities());
+
+  // Precomputed masks stay valid as long as no entity moves during the collisions
+  bool precomputed = _parallel && _precomputeTouchRows(group1, sameGroup);
+  std::size_t nRows = group1.size();
+
+  // e1 and e2 index the groups, r1 and s2 the rows of the masks and the batch, which keep removed entities
+  std::size_t e1 = 0;
+  std::size_t r1 = sameGroup ? _batch.nextLive(0) : 0;
+  while (e1 < group1.size()) {
+    Entity* entity1 = group1.entity(e1);
+    std::size_t e2 = sameGroup ? e1 + 1 : 0;
+    std::size_t s2 = _batch.nextLive(sameGroup ? r1 + 1 : 0);
+
+    const unsigned char* row = nullptr;
+    if (precomputed && r1 < nRows) {
+      row = &_touchRows[r1 * _rowLength];
+      _batch.xRef = rawValue(entity1->_physicsBox.xPos);
+      _batch.yRef = rawValue(entity1->_physicsBox.yPos);
+    } else {
+      _computeTouchMask(entity1, s2);
+    }
 
-          // Change entity1 if the previous one was deleted
-          if (initialEntityIt1 != entityIt1) {
-            break;
+    bool removed1 = false;
+    while (e2 < group2.size()) {
+      Entity* entity2 = group2.entity(e2);
+      bool batched = s2 < _batch.size();  // Entities added during the collisions are not
+
+      if (batched && !(row ? row[s2] : _batch.mask[s2]) &&
+          entity1->_collisionEpoch == _collisionEpoch && entity2->_collisionEpoch == _collisionEpoch) {
+        ++e2;
+        s2 = _batch.nextLive(s2 + 1);
+        continue;
+      }
+
+      unsigned outcome = _checkCollision(entity1, entity2);
+
+      if (outcome & COLLISION_REMOVED_2) {
+        if (batched) {
+          _batch.dead[s2] = 1;
+          s2 = _batch.nextLive(s2 + 1);
+        }
+      } else {
+        if (outcome & COLLISION_TOUCHED && batched) {
+          // A touched entity may have been moved (e.g. a player respawning)
+          if (rawValue(entity2->_physicsBox.xPos) != _batch.xPos[s2] || rawValue(entity2->_physicsBox.yPos) != _batch.yPos[s2]) {
+            precomputed = false;
+            row = nullptr;
+            _computeTouchMask(entity1, s2 + 1);
           }
+          _updateSwept(s2, entity2);
+        }
+        ++e2;
+        if (batched) {
+          s2 = _batch.nextLive(s2 + 1);
+        }
+      }
 
-          ++entityIt2;
+      // Change entity1 if the previous one was removed
+      if (outcome & COLLISION_REMOVED_1) {
+        if (sameGroup && r1 < _batch.size()) {
+          _batch.dead[r1] = 1;
         }
+        removed1 = true;
+        break;
+      }
+
+      if (outcome & COLLISION_TOUCHED) {
+        if (sameGroup && r1 < _batch.size()) {
+          _updateSwept(r1, entity1);
+        }
+        if (rawValue(entity1->_physicsBox.xPos) != _batch.xRef || rawValue(entity1->_physicsBox.yPos) != _batch.yRef) {
+          row = nullptr;
+          _computeTouchMask(entity1, s2);
+        }
+      }
+    }
+
+    if (!removed1) {
+      ++e1;
+    }
+    r1 = sameGroup ? _batch.nextLive(r1 + 1) : r1 + 1;
+  }
+}
+
+void PhysicsEngine::checkCollisions() {
+  _updateParallelMode();
+
+  if (++_collisionEpoch == 0) {
+    ++_collisionEpoch;
+  }
 
-        ++entityIt1;
+  for (Group* group1: _map->groups()) {
+    for (Group* group2: group1->collisionGroups()) {
+      // Without friendly fire, players can not hurt each other
+      if (group1 == group2 && group1 == &_map->group(PLAYER) && !_friendlyFire) {
+        _checkPlayerDeaths(*group1);
+      } else {
+        _checkCollisions(*group1, *group2);
       }
     }
   }
 }
 
+/* Same outcome as checking every pair of players when they can not hurt each
+ *  other: each player is visited once and removed if dead, in linear time.
+ */
+void PhysicsEngine::_checkPlayerDeaths(Group& players) {
+  // A single player forms no pair
+  if (players.size() < 2) {
+    return;
+  }
+
+  std::size_t p = 0;
+  while (p < players.size()) {
+    Player* player = static_cast<Player*>(players.entity(p));
+    player->_collisionEpoch = _collisionEpoch;
+    if (player->checkDeath()) {
+      player->kill();
+    } else {
+      ++p;
+    }
+  }
+}
+
 void PhysicsEngine::clearMap() {
   for (size_t g = 1; g != _map->groups().size(); ++g) {
     Group* group = &_map->group(g);
@@ -176,31 +653,181 @@ void PhysicsEngine::clearMap() {
       --e;
     }
   }
+  _deleteDormant();
+}
+
+void PhysicsEngine::snapshot(WorldSnapshot& dest) const {
+  // Index entities first, so that references are written as indices
+  std::int32_t nEntities = 0;
+  for (Group* group: _map->groups()) {
+    for (Entity* entity: group->entities()) {
+      entity->_snapshotIndex = nEntities++;
+    }
+  }
+  for (const std::vector<Dormant>& cell: _dormantCells) {
+    for (const Dormant& entry: cell) {
+      entry.entity->_snapshotIndex = nEntities++;
+    }
+  }
+  for (Player* player: _players) {
+    if (!player->_group) {
+      player->_snapshotIndex = nEntities++;
+    }
+    if (player->_powerUp) {
+      player->_powerUp->_snapshotIndex = nEntities++;
+    }
+  }
+
+  dest.entities.resize(std::size_t(nEntities));
+  dest.players.resize(_players.size());
+  for (std::size_t g = 0; g != _map->groups().size(); ++g) {
+    for (Entity* entity: _map->group(g).entities()) {
+      EntityRecord& record = dest.entities[std::size_t(entity->_snapshotIndex)];
+      record = EntityRecord();
+      entity->save(record);
+      record.group = std::int8_t(g);
+    }
+  }
+  for (const std::vector<Dormant>& cell: _dormantCells) {
+    for (const Dormant& entry: cell) {
+      EntityRecord& record = dest.entities[std::size_t(entry.entity->_snapshotIndex)];
+      record = EntityRecord();
+      entry.entity->save(record);
+      record.group = std::int8_t(entry.group);
+      record.dormant = true;
+    }
+  }
+  for (std::size_t p = 0; p != _players.size(); ++p) {
+    Player* player = _players[p];
+    if (!player->_group) {
+      EntityRecord& record = dest.entities[std::size_t(player->_snapshotIndex)];
+      record = EntityRecord();
+      player->save(record);
+    }
+    if (player->_powerUp) {
+      EntityRecord& record = dest.entities[std::size_t(player->_powerUp->_snapshotIndex)];
+      record = EntityRecord();
+      player->_powerUp->save(record);
+    }
+    dest.players[p] = player->_snapshotIndex;
+  }
+
+  dest.random = _map->randomState();
+  dest.collisionEpoch = _collisionEpoch;
+  dest.dropsCapped = _map->dropsCapped();
+  dest.world = _map->world();
+  dest.xCamera = rawValue(_map->xCamera());
+  dest.yCamera = rawValue(_map->yCamera());
+}
+
+Entity* PhysicsEngine::_createEntity(const EntityRecord& record) {
+  Body box(fromRaw(record.xPos), fromRaw(record.yPos), record.xSize, record.ySize, fromRaw(record.xVelocity), fromRaw(record.yVelocity));
+
+  switch (record.kind) {
+    case KIND_POWERUP:
+      return new PowerUp(record.ID, box, _map, 1, 1);
+    case KIND_OBSTACLE:
+      return new Obstacle(record.ID, box, _map);
+    case KIND_BULLET:
+      return new Bullet(record.ID, box, _map, 0);
+    case KIND_PLAYER:
+      return new Player(record.ID, box, _map, _friendlyFire, _initialLives);
+    case KIND_ENEMY_1:
+      return new Enemy_1(record.ID, box, _map, _bonusProbability, _difficulty);
+    case KIND_ENEMY_2:
+      return new Enemy_2(record.ID, box, _map, _bonusProbability, _difficulty);
+    case KIND_ENEMY_3:
+      return new Enemy_3(record.ID, box, _map, _bonusProbability, _difficulty);
+    case KIND_BOSS_1:
+      return new Boss_1(record.ID, box, _map, _bonusProbability, _difficulty);
+    case KIND_BOSS_2:
+      return new Boss_2(record.ID, box, _map, _bonusProbability, _difficulty);
+    case KIND_BOSS_3:
+      return new Boss_3(record.ID, box, _map, _bonusProbability, _difficulty);
+    case KIND_HENCHMAN_1:
+      return new Henchman_1(record.ID, box, _map, _bonusProbability, _difficulty);
+    case KIND_HENCHMAN_2:
+      return new Henchman_2(record.ID, box, _map, _bonusProbability, _difficulty);
+    case KIND_HENCHMAN_3:
+      return new Henchman_3(record.ID, box, _map, _bonusProbability, _difficulty);
+  }
+  throw Error("Invalid entity kind in snapshot");
+}
+
+void PhysicsEngine::restore(const WorldSnapshot& snapshot) {
+  // Groups are emptied at once rather than entity by entity
+  for (Group* group: _map->groups()) {
+    for (Entity* entity: group->entities()) {
+      entity->_group = nullptr;
+      if (group != &_map->group(PLAYER)) {
+        delete entity;
+      }
+    }
+    group->entities().clear();
+  }
+  for (Player* player: _players) {
+    delete player;
+  }
+  _players.clear();
+  _deleteDormant();
+  setWorld(snapshot.world);
+  _map->moveCamera(fromRaw(snapshot.xCamera), fromRaw(snapshot.yCamera));
+
+  _restored.resize(snapshot.entities.size());
+  for (std::size_t e = 0; e != _restored.size(); ++e) {
+    _restored[e] = _createEntity(snapshot.entities[e]);
+  }
+  // Entities were recorded in the order of their group
+  for (std::size_t e = 0; e != _restored.size(); ++e) {
+    const EntityRecord& record = snapshot.entities[e];
+    Entity* entity = _restored[e];
+    entity->load(record, _restored.data());
+
+    entity->_group = (record.group < 0 || record.dormant) ? nullptr : &_map->group(std::size_t(record.group));
+    if (entity->_group) {
+      _map->add(entity);
+    } else if (record.dormant) {
+      _sleep(entity, std::size_t(record.group));
+    }
+
+    if (record.levelPattern) {
+      std::map<unsigned, MovePattern>::const_iterator pattern = _levelPatterns.find(record.ID);
+      if (pattern != _levelPatterns.end()) {
+        static_cast<Enemy*>(entity)->setLevelPattern(&pattern->second);
+      }
+    }
+  }
+  for (std::int32_t nEntity: snapshot.players) {
+    _players.push_back(static_cast<Player*>(_restored[std::size_t(nEntity)]));
+  }
+
+  _map->setRandomState(snapshot.random);
+  _collisionEpoch = snapshot.collisionEpoch;
+  _map->capDrops(snapshot.dropsCapped);
 }
 
-void PhysicsEngine::setPlayerVelocityY(int nPlayer, int direction) {
-  double velocity = direction * PLAYER_VELOCITY_Y;
-  if (_players[nPlayer] && unsigned(_players[nPlayer]->yPos() + velocity) < MAP_HEIGHT) {
+void PhysicsEngine::setPlayerVelocityY(unsigned nPlayer, int direction) {
+  Real velocity = direction * _map->timing().playerVelocityY;
+  if (nPlayer < _players.size() && unsigned(_players[nPlayer]->yPos() + velocity - _map->yCamera()) < MAP_HEIGHT) {
     _players[nPlayer]->setVelocityY(velocity);
   }
 }
 
-void PhysicsEngine::setPlayerVelocityX(int nPlayer, int direction) {
-  double velocity = direction * PLAYER_VELOCITY_X;
-  if (_players[nPlayer] && unsigned(_players[nPlayer]->xPos() + velocity) < MAP_WIDTH) {
+void PhysicsEngine::setPlayerVelocityX(unsigned nPlayer, int direction) {
+  Real velocity = direction * _map->timing().playerVelocityX;
+  if (nPlayer < _players.size() && unsigned(_players[nPlayer]->xPos() + velocity - _map->xCamera()) < MAP_WIDTH) {
     _players[nPlayer]->setVelocityX(velocity);
   }
 }
 
-void PhysicsEngine::playerShoot(int nPlayer) {
-  if (_players[nPlayer] && _players[nPlayer]->hp() != 0) {
+void PhysicsEngine::playerShoot(unsigned nPlayer) {
+  if (nPlayer < _players.size() && _players[nPlayer]->hp() != 0) {
     _players[nPlayer]->shoot();
   }
 }
 
-void PhysicsEngine::getPlayers(const Player*& player1, const Player*& player2) const noexcept {
-  player1 = _players[0];
-  player2 = _players[1];
+const std::vector<Player*>& PhysicsEngine::players() const noexcept {
+  return _players;
 }
 
 std::size_t PhysicsEngine::getEntityNumber() const noexcept {
@@ -221,26 +848,67 @@ std::vector<Entity*>& PhysicsEngine::getAllEntities(std::vector<Entity*>& dest)
       dest.push_back(entity);
     }
   }
+  for (const std::vector<Dormant>& cell: _dormantCells) {
+    for (const Dormant& entry: cell) {
+      dest.push_back(entry.entity);
+    }
+  }
   return dest;
 }
 
+bool PhysicsEngine::_isVisible(const Entity* entity) const noexcept {
+  Real xCamera = _map->xCamera();
+  Real yCamera = _map->yCamera();
+  return (xCamera < entity->xPos() + entity->xSize() &&
+          xCamera + MAP_WIDTH > entity->xPos() &&
+          yCamera < entity->yPos() + entity->ySize() &&
+          yCamera + MAP_HEIGHT > entity->yPos());
+}
+
+std::vector<Entity*>& PhysicsEngine::getVisibleEntities(std::vector<Entity*>& dest) const noexcept {
+  // Dormant entities are left out, they wake up before the view reaches them
+  for (Group* group: _map->groups()) {
+    for (Entity* entity: group->entities()) {
+      if (_isVisible(entity)) {
+        dest.push_back(entity);
+      }
+    }
+  }
+  return dest;
+}
+
+std::size_t PhysicsEngine::getVisibleNumber() const noexcept {
+  std::size_t nbEntities = 0;
+  for (Group* group: _map->groups()) {
+    for (const Entity* entity: group->entities()) {
+      nbEntities += _isVisible(entity);
+    }
+  }
+  return nbEntities;
+}
+
+Real PhysicsEngine::xCamera() const noexcept {
+  return _map->xCamera();
+}
+
+Real PhysicsEngine::yCamera() const noexcept {
+  return _map->yCamera();
+}
+
 void PhysicsEngine::playersNewLife() const noexcept {
-  _players[0]->addLife();
-  if (_players[1]) {
-    _players[1]->addLife();
+  for (Player* player: _players) {
+    player->addLife();
   }
 }
 
 void PhysicsEngine::playersToggleGhost() const noexcept {
-  _players[0]->toggleGhost();
-  if (_players[1]) {
-    _players[1]->toggleGhost();
+  for (Player* player: _players) {
+    player->toggleGhost();
   }
 }
 
 void PhysicsEngine::playersToggleHulk() const noexcept {
-  _players[0]->toggleHulk();
-  if (_players[1]) {
-    _players[1]->toggleHulk();
+  for (Player* player: _players) {
+    player->toggleHulk();
   }
 }
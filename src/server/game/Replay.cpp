@@ -0,0 +1,172 @@
+#include "server/game/Replay.hpp"
+
+#include <cstring>
+
+#include "Error.hpp"
+#include "constants.hpp"
+#include "server/game/Timing.hpp"
+
+static constexpr char REPLAY_MAGIC[4] = {'L', 'T', 'R', 'P'};
+static constexpr std::uint8_t REPLAY_VERSION = 3;
+static constexpr std::uint8_t REPLAY_FIXED_POINT = 1;
+
+/**********************************************************************
+ *                              ENCODING                              *
+ **********************************************************************/
+
+template<typename T>
+static void writeRaw(std::ostream& out, T value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+static T readRaw(std::istream& in) {
+  T value;
+  if (!in.read(reinterpret_cast<char*>(&value), sizeof(value))) {
+    throw Error("Truncated replay");
+  }
+  return value;
+}
+
+static void writeVarint(std::ostream& out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out.put(char((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.put(char(value));
+}
+
+static std::uint64_t readVarint(std::istream& in) {
+  std::uint64_t value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    int byte = in.get();
+    if (byte == EOF) {
+      throw Error("Truncated replay");
+    }
+    value |= std::uint64_t(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+  throw Error("Invalid varint in replay");
+}
+
+// Zigzag encoding keeps small negative inputs (ESC) on one byte
+static std::uint64_t zigzag(int value) noexcept {
+  return (std::uint64_t(std::uint32_t(value)) << 1) ^ std::uint64_t(std::int64_t(value >> 31));
+}
+
+static int unzigzag(std::uint64_t value) noexcept {
+  return int(std::uint32_t(value >> 1) ^ -std::uint32_t(value & 1));
+}
+
+/**********************************************************************
+ *                              RECORDER                              *
+ **********************************************************************/
+
+ReplayRecorder::ReplayRecorder(const std::string& path, const ReplayInfo& info)
+    : _file(path, std::ios::binary | std::ios::trunc), _tickRate(Timing::clampTickRate(info.settings.tickRate)) {
+  if (!_file) {
+    throw Error("Could not create the replay " + path);
+  }
+
+  const GameSettings& settings = info.settings;
+  _file.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+  writeRaw<std::uint8_t>(_file, REPLAY_VERSION);
+  writeRaw<std::uint8_t>(_file, info.fixedPoint ? REPLAY_FIXED_POINT : 0);
+
+  writeRaw<std::uint8_t>(_file, std::uint8_t(settings.nbPlayers));
+  writeRaw<std::uint32_t>(_file, settings.initialLives);
+  writeRaw<double>(_file, settings.difficulty);
+  writeRaw<double>(_file, settings.bonusProbability);
+  writeRaw<std::uint8_t>(_file, settings.friendlyFire);
+  writeRaw<std::int32_t>(_file, settings.levelID);
+  for (unsigned p = 0; p != settings.nbPlayers; ++p) {
+    writeRaw<std::int32_t>(_file, settings.skins[p]);
+  }
+  writeRaw<std::uint16_t>(_file, std::uint16_t(_tickRate));
+
+  writeRaw<std::uint32_t>(_file, std::uint32_t(info.levelIDs.size()));
+  for (int levelID: info.levelIDs) {
+    writeRaw<std::int32_t>(_file, levelID);
+  }
+  writeRaw<std::uint64_t>(_file, info.seed);
+}
+
+void ReplayRecorder::input(int key) noexcept {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _inputs.push_back(key);
+}
+
+void ReplayRecorder::endTick(std::uint64_t stateHash) noexcept {
+  std::lock_guard<std::mutex> lock(_mutex);
+  writeVarint(_file, _inputs.size());
+  for (int key: _inputs) {
+    writeVarint(_file, zigzag(key));
+  }
+  writeRaw<std::uint64_t>(_file, stateHash);
+  _inputs.clear();
+
+  // Flush every second so that the replay of a crashed server stays usable
+  if (++_ticks % _tickRate == 0) {
+    _file.flush();
+  }
+}
+
+/**********************************************************************
+ *                               READER                               *
+ **********************************************************************/
+
+ReplayReader::ReplayReader(const std::string& path): _file(path, std::ios::binary) {
+  if (!_file) {
+    throw Error("Could not open the replay " + path);
+  }
+
+  char magic[sizeof(REPLAY_MAGIC)];
+  if (!_file.read(magic, sizeof(magic)) || std::memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0) {
+    throw Error(path + " is not a replay");
+  }
+  if (readRaw<std::uint8_t>(_file) != REPLAY_VERSION) {
+    throw Error("Unsupported replay version");
+  }
+  _info.fixedPoint = readRaw<std::uint8_t>(_file) & REPLAY_FIXED_POINT;
+
+  GameSettings& settings = _info.settings;
+  settings.nbPlayers = readRaw<std::uint8_t>(_file);
+  if (settings.nbPlayers == 0 || settings.nbPlayers > MAX_PLAYERS) {
+    throw Error("Invalid number of players in replay");
+  }
+  settings.initialLives = readRaw<std::uint32_t>(_file);
+  settings.difficulty = readRaw<double>(_file);
+  settings.bonusProbability = readRaw<double>(_file);
+  settings.friendlyFire = readRaw<std::uint8_t>(_file);
+  settings.levelID = readRaw<std::int32_t>(_file);
+  for (unsigned p = 0; p != settings.nbPlayers; ++p) {
+    settings.skins[p] = readRaw<std::int32_t>(_file);
+  }
+  settings.tickRate = readRaw<std::uint16_t>(_file);
+
+  _info.levelIDs.resize(readRaw<std::uint32_t>(_file));
+  for (int& levelID: _info.levelIDs) {
+    levelID = readRaw<std::int32_t>(_file);
+  }
+  _info.seed = readRaw<std::uint64_t>(_file);
+}
+
+const ReplayInfo& ReplayReader::info() const noexcept {
+  return _info;
+}
+
+bool ReplayReader::nextTick(std::vector<int>& inputs, std::uint64_t& stateHash) {
+  inputs.clear();
+  if (_file.peek() == EOF) {
+    return false;
+  }
+
+  std::uint64_t nInputs = readVarint(_file);
+  for (std::uint64_t i = 0; i != nInputs; ++i) {
+    inputs.push_back(unzigzag(readVarint(_file)));
+  }
+  stateHash = readRaw<std::uint64_t>(_file);
+  return true;
+}
@@ -0,0 +1,29 @@
+#include "server/game/Timing.hpp"
+
+#include <algorithm>
+
+/* Velocity of an entity crossing a map dimension of `size` in `crossing` seconds.
+ */
+static Real velocity(int size, double crossing, unsigned tickRate) noexcept {
+  return Real(size / (crossing * tickRate));
+}
+
+Timing::Timing(unsigned _tickRate) noexcept
+    : tickRate(clampTickRate(_tickRate)),
+      ticksByLevel(tickRate * LEVEL_DURATION),
+      stateDuration(unsigned(tickRate * STATE_DURATION)),
+      respawnDuration(unsigned(tickRate * RESPAWN_DURATION)),
+      playerVelocityX(velocity(MAP_WIDTH, PLAYER_CROSSING_X, tickRate)),
+      playerVelocityY(velocity(MAP_HEIGHT, PLAYER_CROSSING_Y, tickRate)),
+      enemyVelocityX(velocity(MAP_WIDTH, ENEMY_CROSSING_X, tickRate)),
+      enemyVelocityY(velocity(MAP_HEIGHT, ENEMY_CROSSING_Y, tickRate)),
+      bulletVelocity(velocity(MAP_WIDTH, BULLET_CROSSING, tickRate)),
+      obstacleVelocity(velocity(MAP_WIDTH, OBSTACLE_CROSSING, tickRate)),
+      playerFireDelay(unsigned(tickRate / PLAYER_FIRE_RATE)),
+      enemyFireDelay(unsigned(tickRate / ENEMY_FIRE_RATE)),
+      bossFireDelay(unsigned(tickRate / BOSS_FIRE_RATE)),
+      henchmanFireDelay(unsigned(tickRate / HENCHMAN_FIRE_RATE)) {}
+
+unsigned Timing::clampTickRate(unsigned tickRate) noexcept {
+  return std::min(std::max(tickRate, MIN_TICK_RATE), MAX_TICK_RATE);
+}
@@ -0,0 +1,13 @@
+#include "server/game/WorldStore.hpp"
+
+void WorldStore::clear() noexcept {
+  xPos.clear();
+  yPos.clear();
+  xSize.clear();
+  ySize.clear();
+  xVelocity.clear();
+  yVelocity.clear();
+  mask.clear();
+  patterns.clear();
+  cursors.clear();
+}
@@ -0,0 +1,377 @@
+#include "server/game/kernels.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KERNELS_X86
+#endif
+
+/**********************************************************************
+ *                               SCALAR                               *
+ **********************************************************************/
+
+template<typename T>
+static void integrateScalar(T* xPos, T* yPos, const T* xVelocity, const T* yVelocity, std::size_t n) noexcept {
+  for (std::size_t i = 0; i != n; ++i) {
+    xPos[i] += xVelocity[i];
+    yPos[i] += yVelocity[i];
+  }
+}
+
+template<typename T>
+static void offBoundsScalar(
+    const T* xPos, const T* yPos, const T* xSize, const T* ySize, std::size_t n,
+    T xMin, T yMin, T xMax, T yMax,
+    unsigned char* mask) noexcept {
+  for (std::size_t i = 0; i != n; ++i) {
+    mask[i] = !(xMin < xPos[i] + xSize[i] &&
+                xMax > xPos[i] &&
+                yMin < yPos[i] + ySize[i] &&
+                yMax > yPos[i]);
+  }
+}
+
+template<typename T>
+static void touchScalar(
+    T xPos, T yPos, T xSize, T ySize,
+    const T* xs, const T* ys, const T* ws, const T* hs, std::size_t n,
+    unsigned char* mask) noexcept {
+  for (std::size_t i = 0; i != n; ++i) {
+    mask[i] = (xPos < xs[i] + ws[i] &&
+               xPos + xSize > xs[i] &&
+               yPos < ys[i] + hs[i] &&
+               yPos + ySize > ys[i]);
+  }
+}
+
+#ifdef KERNELS_X86
+
+/* Expand a comparison movemask to one byte per lane (little endian).
+ */
+static constexpr std::uint32_t LANE_BYTES[16] = {
+    0x00000000, 0x00000001, 0x00000100, 0x00000101,
+    0x00010000, 0x00010001, 0x00010100, 0x00010101,
+    0x01000000, 0x01000001, 0x01000100, 0x01000101,
+    0x01010000, 0x01010001, 0x01010100, 0x01010101,
+};
+
+static inline void storeLanes2(unsigned char* mask, int bits) noexcept {
+  std::uint16_t lanes = std::uint16_t(LANE_BYTES[bits & 3]);
+  std::memcpy(mask, &lanes, sizeof(lanes));
+}
+
+static inline void storeLanes4(unsigned char* mask, int bits) noexcept {
+  std::memcpy(mask, &LANE_BYTES[bits & 15], sizeof(std::uint32_t));
+}
+
+/**********************************************************************
+ *                                SSE2                                *
+ **********************************************************************/
+
+__attribute__((target("sse2"))) static void integrateSSE2(double* xPos, double* yPos, const double* xVelocity, const double* yVelocity, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(xPos + i, _mm_add_pd(_mm_loadu_pd(xPos + i), _mm_loadu_pd(xVelocity + i)));
+    _mm_storeu_pd(yPos + i, _mm_add_pd(_mm_loadu_pd(yPos + i), _mm_loadu_pd(yVelocity + i)));
+  }
+  integrateScalar(xPos + i, yPos + i, xVelocity + i, yVelocity + i, n - i);
+}
+
+__attribute__((target("sse2"))) static void offBoundsSSE2(
+    const double* xPos, const double* yPos, const double* xSize, const double* ySize, std::size_t n,
+    double xMin, double yMin, double xMax, double yMax,
+    unsigned char* mask) noexcept {
+  const __m128d xMinV = _mm_set1_pd(xMin);
+  const __m128d yMinV = _mm_set1_pd(yMin);
+  const __m128d xMaxV = _mm_set1_pd(xMax);
+  const __m128d yMaxV = _mm_set1_pd(yMax);
+
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d x = _mm_loadu_pd(xPos + i);
+    __m128d y = _mm_loadu_pd(yPos + i);
+    __m128d inside = _mm_and_pd(
+        _mm_and_pd(_mm_cmplt_pd(xMinV, _mm_add_pd(x, _mm_loadu_pd(xSize + i))), _mm_cmpgt_pd(xMaxV, x)),
+        _mm_and_pd(_mm_cmplt_pd(yMinV, _mm_add_pd(y, _mm_loadu_pd(ySize + i))), _mm_cmpgt_pd(yMaxV, y)));
+    storeLanes2(mask + i, ~_mm_movemask_pd(inside));
+  }
+  offBoundsScalar(xPos + i, yPos + i, xSize + i, ySize + i, n - i, xMin, yMin, xMax, yMax, mask + i);
+}
+
+__attribute__((target("sse2"))) static void touchSSE2(
+    double xPos, double yPos, double xSize, double ySize,
+    const double* xs, const double* ys, const double* ws, const double* hs, std::size_t n,
+    unsigned char* mask) noexcept {
+  const __m128d x1 = _mm_set1_pd(xPos);
+  const __m128d y1 = _mm_set1_pd(yPos);
+  const __m128d x2 = _mm_set1_pd(xPos + xSize);
+  const __m128d y2 = _mm_set1_pd(yPos + ySize);
+
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d x = _mm_loadu_pd(xs + i);
+    __m128d y = _mm_loadu_pd(ys + i);
+    __m128d overlap = _mm_and_pd(
+        _mm_and_pd(_mm_cmplt_pd(x1, _mm_add_pd(x, _mm_loadu_pd(ws + i))), _mm_cmpgt_pd(x2, x)),
+        _mm_and_pd(_mm_cmplt_pd(y1, _mm_add_pd(y, _mm_loadu_pd(hs + i))), _mm_cmpgt_pd(y2, y)));
+    storeLanes2(mask + i, _mm_movemask_pd(overlap));
+  }
+  touchScalar(xPos, yPos, xSize, ySize, xs + i, ys + i, ws + i, hs + i, n - i, mask + i);
+}
+
+__attribute__((target("sse2"))) static void integrateSSE2(std::int32_t* xPos, std::int32_t* yPos, const std::int32_t* xVelocity, const std::int32_t* yVelocity, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i* x = reinterpret_cast<__m128i*>(xPos + i);
+    __m128i* y = reinterpret_cast<__m128i*>(yPos + i);
+    _mm_storeu_si128(x, _mm_add_epi32(_mm_loadu_si128(x), _mm_loadu_si128(reinterpret_cast<const __m128i*>(xVelocity + i))));
+    _mm_storeu_si128(y, _mm_add_epi32(_mm_loadu_si128(y), _mm_loadu_si128(reinterpret_cast<const __m128i*>(yVelocity + i))));
+  }
+  integrateScalar(xPos + i, yPos + i, xVelocity + i, yVelocity + i, n - i);
+}
+
+__attribute__((target("sse2"))) static inline __m128i loadInt4(const std::int32_t* values) noexcept {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+}
+
+__attribute__((target("sse2"))) static inline int movemaskInt4(__m128i lanes) noexcept {
+  return _mm_movemask_ps(_mm_castsi128_ps(lanes));
+}
+
+__attribute__((target("sse2"))) static void offBoundsSSE2(
+    const std::int32_t* xPos, const std::int32_t* yPos, const std::int32_t* xSize, const std::int32_t* ySize, std::size_t n,
+    std::int32_t xMin, std::int32_t yMin, std::int32_t xMax, std::int32_t yMax,
+    unsigned char* mask) noexcept {
+  const __m128i xMinV = _mm_set1_epi32(xMin);
+  const __m128i yMinV = _mm_set1_epi32(yMin);
+  const __m128i xMaxV = _mm_set1_epi32(xMax);
+  const __m128i yMaxV = _mm_set1_epi32(yMax);
+
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = loadInt4(xPos + i);
+    __m128i y = loadInt4(yPos + i);
+    __m128i inside = _mm_and_si128(
+        _mm_and_si128(_mm_cmplt_epi32(xMinV, _mm_add_epi32(x, loadInt4(xSize + i))), _mm_cmpgt_epi32(xMaxV, x)),
+        _mm_and_si128(_mm_cmplt_epi32(yMinV, _mm_add_epi32(y, loadInt4(ySize + i))), _mm_cmpgt_epi32(yMaxV, y)));
+    storeLanes4(mask + i, ~movemaskInt4(inside));
+  }
+  offBoundsScalar(xPos + i, yPos + i, xSize + i, ySize + i, n - i, xMin, yMin, xMax, yMax, mask + i);
+}
+
+__attribute__((target("sse2"))) static void touchSSE2(
+    std::int32_t xPos, std::int32_t yPos, std::int32_t xSize, std::int32_t ySize,
+    const std::int32_t* xs, const std::int32_t* ys, const std::int32_t* ws, const std::int32_t* hs, std::size_t n,
+    unsigned char* mask) noexcept {
+  const __m128i x1 = _mm_set1_epi32(xPos);
+  const __m128i y1 = _mm_set1_epi32(yPos);
+  const __m128i x2 = _mm_set1_epi32(xPos + xSize);
+  const __m128i y2 = _mm_set1_epi32(yPos + ySize);
+
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = loadInt4(xs + i);
+    __m128i y = loadInt4(ys + i);
+    __m128i overlap = _mm_and_si128(
+        _mm_and_si128(_mm_cmplt_epi32(x1, _mm_add_epi32(x, loadInt4(ws + i))), _mm_cmpgt_epi32(x2, x)),
+        _mm_and_si128(_mm_cmplt_epi32(y1, _mm_add_epi32(y, loadInt4(hs + i))), _mm_cmpgt_epi32(y2, y)));
+    storeLanes4(mask + i, movemaskInt4(overlap));
+  }
+  touchScalar(xPos, yPos, xSize, ySize, xs + i, ys + i, ws + i, hs + i, n - i, mask + i);
+}
+
+/**********************************************************************
+ *                                AVX                                 *
+ **********************************************************************/
+
+__attribute__((target("avx"))) static void integrateAVX(double* xPos, double* yPos, const double* xVelocity, const double* yVelocity, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(xPos + i, _mm256_add_pd(_mm256_loadu_pd(xPos + i), _mm256_loadu_pd(xVelocity + i)));
+    _mm256_storeu_pd(yPos + i, _mm256_add_pd(_mm256_loadu_pd(yPos + i), _mm256_loadu_pd(yVelocity + i)));
+  }
+  // Avoid AVX-SSE transition penalties in the scalar tail
+  _mm256_zeroupper();
+  integrateScalar(xPos + i, yPos + i, xVelocity + i, yVelocity + i, n - i);
+}
+
+__attribute__((target("avx"))) static void offBoundsAVX(
+    const double* xPos, const double* yPos, const double* xSize, const double* ySize, std::size_t n,
+    double xMin, double yMin, double xMax, double yMax,
+    unsigned char* mask) noexcept {
+  const __m256d xMinV = _mm256_set1_pd(xMin);
+  const __m256d yMinV = _mm256_set1_pd(yMin);
+  const __m256d xMaxV = _mm256_set1_pd(xMax);
+  const __m256d yMaxV = _mm256_set1_pd(yMax);
+
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d x = _mm256_loadu_pd(xPos + i);
+    __m256d y = _mm256_loadu_pd(yPos + i);
+    __m256d inside = _mm256_and_pd(
+        _mm256_and_pd(_mm256_cmp_pd(xMinV, _mm256_add_pd(x, _mm256_loadu_pd(xSize + i)), _CMP_LT_OQ), _mm256_cmp_pd(xMaxV, x, _CMP_GT_OQ)),
+        _mm256_and_pd(_mm256_cmp_pd(yMinV, _mm256_add_pd(y, _mm256_loadu_pd(ySize + i)), _CMP_LT_OQ), _mm256_cmp_pd(yMaxV, y, _CMP_GT_OQ)));
+    storeLanes4(mask + i, ~_mm256_movemask_pd(inside));
+  }
+  // Avoid AVX-SSE transition penalties in the scalar tail
+  _mm256_zeroupper();
+  offBoundsScalar(xPos + i, yPos + i, xSize + i, ySize + i, n - i, xMin, yMin, xMax, yMax, mask + i);
+}
+
+__attribute__((target("avx"))) static void touchAVX(
+    double xPos, double yPos, double xSize, double ySize,
+    const double* xs, const double* ys, const double* ws, const double* hs, std::size_t n,
+    unsigned char* mask) noexcept {
+  const __m256d x1 = _mm256_set1_pd(xPos);
+  const __m256d y1 = _mm256_set1_pd(yPos);
+  const __m256d x2 = _mm256_set1_pd(xPos + xSize);
+  const __m256d y2 = _mm256_set1_pd(yPos + ySize);
+
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d x = _mm256_loadu_pd(xs + i);
+    __m256d y = _mm256_loadu_pd(ys + i);
+    __m256d overlap = _mm256_and_pd(
+        _mm256_and_pd(_mm256_cmp_pd(x1, _mm256_add_pd(x, _mm256_loadu_pd(ws + i)), _CMP_LT_OQ), _mm256_cmp_pd(x2, x, _CMP_GT_OQ)),
+        _mm256_and_pd(_mm256_cmp_pd(y1, _mm256_add_pd(y, _mm256_loadu_pd(hs + i)), _CMP_LT_OQ), _mm256_cmp_pd(y2, y, _CMP_GT_OQ)));
+    storeLanes4(mask + i, _mm256_movemask_pd(overlap));
+  }
+  // Avoid AVX-SSE transition penalties in the scalar tail
+  _mm256_zeroupper();
+  touchScalar(xPos, yPos, xSize, ySize, xs + i, ys + i, ws + i, hs + i, n - i, mask + i);
+}
+
+#endif
+
+/**********************************************************************
+ *                              DISPATCH                              *
+ **********************************************************************/
+
+KernelISA bestKernelISA() noexcept {
+#ifdef KERNELS_X86
+  static const KernelISA best = __builtin_cpu_supports("avx")    ? KERNEL_AVX
+                                : __builtin_cpu_supports("sse2") ? KERNEL_SSE2
+                                                                 : KERNEL_SCALAR;
+  return best;
+#else
+  return KERNEL_SCALAR;
+#endif
+}
+
+static std::atomic<int>& currentISA() noexcept {
+  static std::atomic<int> isa(bestKernelISA());
+  return isa;
+}
+
+KernelISA kernelISA() noexcept {
+  return KernelISA(currentISA().load(std::memory_order_relaxed));
+}
+
+void setKernelISA(KernelISA isa) noexcept {
+  currentISA().store((isa < bestKernelISA()) ? isa : bestKernelISA(), std::memory_order_relaxed);
+}
+
+const char* kernelISAName(KernelISA isa) noexcept {
+  switch (isa) {
+    case KERNEL_AVX:
+      return "avx";
+    case KERNEL_SSE2:
+      return "sse2";
+    default:
+      return "scalar";
+  }
+}
+
+void integratePositions(double* xPos, double* yPos, const double* xVelocity, const double* yVelocity, std::size_t n) noexcept {
+  switch (kernelISA()) {
+#ifdef KERNELS_X86
+    case KERNEL_AVX:
+      integrateAVX(xPos, yPos, xVelocity, yVelocity, n);
+      break;
+    case KERNEL_SSE2:
+      integrateSSE2(xPos, yPos, xVelocity, yVelocity, n);
+      break;
+#endif
+    default:
+      integrateScalar(xPos, yPos, xVelocity, yVelocity, n);
+  }
+}
+
+void offBoundsMask(
+    const double* xPos, const double* yPos, const double* xSize, const double* ySize, std::size_t n,
+    double xMin, double yMin, double xMax, double yMax,
+    unsigned char* mask) noexcept {
+  switch (kernelISA()) {
+#ifdef KERNELS_X86
+    case KERNEL_AVX:
+      offBoundsAVX(xPos, yPos, xSize, ySize, n, xMin, yMin, xMax, yMax, mask);
+      break;
+    case KERNEL_SSE2:
+      offBoundsSSE2(xPos, yPos, xSize, ySize, n, xMin, yMin, xMax, yMax, mask);
+      break;
+#endif
+    default:
+      offBoundsScalar(xPos, yPos, xSize, ySize, n, xMin, yMin, xMax, yMax, mask);
+  }
+}
+
+void touchMask(
+    double xPos, double yPos, double xSize, double ySize,
+    const double* xPosBatch, const double* yPosBatch, const double* xSizeBatch, const double* ySizeBatch, std::size_t n,
+    unsigned char* mask) noexcept {
+  switch (kernelISA()) {
+#ifdef KERNELS_X86
+    case KERNEL_AVX:
+      touchAVX(xPos, yPos, xSize, ySize, xPosBatch, yPosBatch, xSizeBatch, ySizeBatch, n, mask);
+      break;
+    case KERNEL_SSE2:
+      touchSSE2(xPos, yPos, xSize, ySize, xPosBatch, yPosBatch, xSizeBatch, ySizeBatch, n, mask);
+      break;
+#endif
+    default:
+      touchScalar(xPos, yPos, xSize, ySize, xPosBatch, yPosBatch, xSizeBatch, ySizeBatch, n, mask);
+  }
+}
+
+/* The integer kernels have no AVX variant: 256-bit integer operations need
+ *  AVX2, and the SSE2 variant already processes 4 lanes at a time.
+ */
+
+void integratePositions(std::int32_t* xPos, std::int32_t* yPos, const std::int32_t* xVelocity, const std::int32_t* yVelocity, std::size_t n) noexcept {
+#ifdef KERNELS_X86
+  if (kernelISA() >= KERNEL_SSE2) {
+    integrateSSE2(xPos, yPos, xVelocity, yVelocity, n);
+    return;
+  }
+#endif
+  integrateScalar(xPos, yPos, xVelocity, yVelocity, n);
+}
+
+void offBoundsMask(
+    const std::int32_t* xPos, const std::int32_t* yPos, const std::int32_t* xSize, const std::int32_t* ySize, std::size_t n,
+    std::int32_t xMin, std::int32_t yMin, std::int32_t xMax, std::int32_t yMax,
+    unsigned char* mask) noexcept {
+#ifdef KERNELS_X86
+  if (kernelISA() >= KERNEL_SSE2) {
+    offBoundsSSE2(xPos, yPos, xSize, ySize, n, xMin, yMin, xMax, yMax, mask);
+    return;
+  }
+#endif
+  offBoundsScalar(xPos, yPos, xSize, ySize, n, xMin, yMin, xMax, yMax, mask);
+}
+
+void touchMask(
+    std::int32_t xPos, std::int32_t yPos, std::int32_t xSize, std::int32_t ySize,
+    const std::int32_t* xPosBatch, const std::int32_t* yPosBatch, const std::int32_t* xSizeBatch, const std::int32_t* ySizeBatch, std::size_t n,
+    unsigned char* mask) noexcept {
+#ifdef KERNELS_X86
+  if (kernelISA() >= KERNEL_SSE2) {
+    touchSSE2(xPos, yPos, xSize, ySize, xPosBatch, yPosBatch, xSizeBatch, ySizeBatch, n, mask);
+    return;
+  }
+#endif
+  touchScalar(xPos, yPos, xSize, ySize, xPosBatch, yPosBatch, xSizeBatch, ySizeBatch, n, mask);
+}
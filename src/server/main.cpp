@@ -1,7 +1,46 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
 #include "server/Server.hpp"
 
-int main() {
+/* Usage: server [--replays DIRECTORY] [--batch GAMES] [--tick-rate HZ] [--send-rate HZ]
+ *               [--parallel ENTITIES] [--metrics FILE] [--no-overload-control] [--profile FILE]
+ *  --replays:   record the replay of every game in DIRECTORY (see `bin/replay`)
+ *  --batch:     refresh up to GAMES games together on each game thread
+ *  --tick-rate: simulate every game at HZ ticks/s instead of the rate asked by its client
+ *  --send-rate: send every game HZ times per second to its client, at most once per tick
+ *  --parallel:  split the ticks of a game across cores once it holds ENTITIES entities (default: never)
+ *  --metrics:   write the overload metrics to FILE once per second
+ *  --no-overload-control: keep every game at full rate, whatever the load of the server
+ *  --profile:   profile the phases of every tick from the start, dumped to FILE on SIGUSR1
+ * Tick profiling can also be switched on and off with SIGUSR2, its dump then
+ *  goes to the log directory.
+ */
+int main(int argc, char* argv[]) {
   Server server;
+  unsigned tickRate = 0;
+  unsigned sendRate = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--replays") == 0 && i + 1 < argc) {
+      server.recordReplays(argv[++i]);
+    } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+      server.batchGames(std::size_t(std::max(0, std::atoi(argv[++i]))));
+    } else if (std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+      tickRate = unsigned(std::max(0, std::atoi(argv[++i])));
+    } else if (std::strcmp(argv[i], "--send-rate") == 0 && i + 1 < argc) {
+      sendRate = unsigned(std::max(0, std::atoi(argv[++i])));
+    } else if (std::strcmp(argv[i], "--parallel") == 0 && i + 1 < argc) {
+      server.parallelTicks(std::size_t(std::max(0, std::atoi(argv[++i]))));
+    } else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+      server.exportOverloadMetrics(argv[++i]);
+    } else if (std::strcmp(argv[i], "--no-overload-control") == 0) {
+      server.disableOverloadControl();
+    } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+      server.profileTicks(argv[++i]);
+    }
+  }
+  server.setRates(tickRate, sendRate);
   server.start();
   return 0;
 }
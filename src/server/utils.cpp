@@ -5,6 +5,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <fstream>
+#include <random>
 
 #include "utils.hpp"
 
@@ -21,6 +22,11 @@ std::string genRandomStr(unsigned int length) noexcept {
   return str;
 }
 
+std::uint64_t genRandomSeed() noexcept {
+  std::random_device rd;
+  return (std::uint64_t(rd()) << 32) | rd();
+}
+
 std::string getKey(const std::string& path) {
   std::string ret;
   std::ifstream file(path);
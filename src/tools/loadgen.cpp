@@ -0,0 +1,339 @@
+/* Load a running server with headless bots, to plan its capacity.
+ * Usage: loadgen [--bots N] [--games N] [--duration SECONDS] [--input-rate HZ]
+ *                [--inputs random|script] [--ramp MS] [--send-rate HZ] [--prefix NAME]
+ *  --bots:       bots playing at the same time (default: 8)
+ *  --games:      games played by each bot, one after another (default: 1)
+ *  --duration:   seconds played in each game, unless it ends before (default: 10)
+ *  --input-rate: inputs sent per second by each bot (default: 8)
+ *  --inputs:     random keys (seeded by bot), or a scripted loop of moves and shots
+ *  --ramp:       delay between the start of two bots (default: 100)
+ *  --send-rate:  refreshes asked per second for each game (default: the server default)
+ *  --prefix:     bots are named PREFIX0, PREFIX1, ... (default: bot)
+ * Each bot is a process of its own, since a client is identified by its pid
+ *  until it signs in. A bot signs up (or in, if the account exists), reads the
+ *  leaderboard, then for each game creates it, sends inputs while reading its
+ *  frames, and quits it.
+ * The tool reports the latency percentiles of each operation and its errors,
+ *  the latency of inputs until a frame shows them, split in stages (see
+ *  `InputLatency`), how late frames arrive after the server sent them, the frames arriving
+ *  late (over 1.5 refresh period after the previous one) or missing (fewer
+ *  frames than the send rate asks for), and the games refused by the server.
+ */
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "GameSettings.hpp"
+#include "InputLatency.hpp"
+#include "MessageData.hpp"
+#include "constants.hpp"
+#include "server/CommunicationAPI.hpp"
+#include "Histogram.hpp"
+#include "utils.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+enum Operation: unsigned {
+  OP_SIGN_IN,
+  OP_LEADERBOARD,
+  OP_CREATE_GAME,
+  OP_INPUT,
+  OP_FRAME,  // Waiting for the next frame
+  OP_QUIT_GAME,
+  NB_OPERATIONS,
+};
+
+static const char* operationName(Operation operation) noexcept {
+  switch (operation) {
+    case OP_SIGN_IN:
+      return "sign in";
+    case OP_LEADERBOARD:
+      return "leaderboard";
+    case OP_CREATE_GAME:
+      return "create game";
+    case OP_INPUT:
+      return "input";
+    case OP_FRAME:
+      return "frame wait";
+    case OP_QUIT_GAME:
+      return "quit game";
+    case NB_OPERATIONS:
+      break;
+  }
+  return "unknown";
+}
+
+/* Measures of every bot, in memory shared by the bot processes (their counters are atomic).
+ * Durations are in µs.
+ */
+struct LoadStats {
+  Histogram operations[NB_OPERATIONS] = {};
+  std::atomic<unsigned long> errors[NB_OPERATIONS] = {};
+  Histogram inputLatency[NB_LATENCY_STAGES] = {};
+  Histogram frameDelay = {};  // From the sending of a frame by the server to its reading
+  std::atomic<unsigned long> frames = {0};
+  std::atomic<unsigned long> lateFrames = {0};
+  std::atomic<unsigned long> missedFrames = {0};
+  std::atomic<unsigned long> refusedGames = {0};
+  std::atomic<unsigned long> endedGames = {0};  // Games won or lost before the end of their duration
+};
+
+struct Options {
+  unsigned bots = 8;
+  unsigned games = 1;
+  double duration = 10;
+  double inputRate = 8;
+  bool randomInputs = true;
+  unsigned ramp = 100;  // ms
+  unsigned sendRate = 0;
+  std::string prefix = "bot";
+};
+
+static long elapsedUs(Clock::time_point start) noexcept {
+  return long(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+}
+
+/* Run `operation`, recording its latency, or an error if it throws or returns false.
+ */
+template<typename Fct>
+static bool measure(LoadStats& stats, Operation operation, Fct fct) {
+  Clock::time_point start = Clock::now();
+  bool success;
+  try {
+    success = fct();
+  } catch (std::exception&) {
+    success = false;
+  }
+  if (success) {
+    stats.operations[operation].record(elapsedUs(start));
+  } else {
+    stats.errors[operation].fetch_add(1, std::memory_order_relaxed);
+  }
+  return success;
+}
+
+static int nextInput(std::mt19937& gen, unsigned step, bool randomInputs) {
+  static const int keys[] = {
+      GAME_KEY_UP, GAME_KEY_DOWN, GAME_KEY_RIGHT, GAME_KEY_LEFT, GAME_KEY_UP_RIGHT, GAME_KEY_UP_LEFT,
+      GAME_KEY_DOWN_RIGHT, GAME_KEY_DOWN_LEFT, GAME_KEY_SHOOT, GAME_KEY_SHOOT_UP, GAME_KEY_SHOOT_RIGHT, GAME_KEY_SHOOT_LEFT};
+  // Strafing left and right while shooting
+  static const int script[] = {
+      GAME_KEY_SHOOT, GAME_KEY_LEFT, GAME_KEY_SHOOT, GAME_KEY_LEFT, GAME_KEY_SHOOT, GAME_KEY_UP,
+      GAME_KEY_SHOOT, GAME_KEY_RIGHT, GAME_KEY_SHOOT, GAME_KEY_RIGHT, GAME_KEY_SHOOT, GAME_KEY_DOWN};
+
+  int key = (randomInputs) ? keys[gen() % (sizeof(keys) / sizeof(keys[0]))] : script[step % (sizeof(script) / sizeof(script[0]))];
+  return gameInput(key, 0);
+}
+
+/* Play one game, return false if it could not be played.
+ */
+static bool playGame(CommunicationAPI& api, LoadStats& stats, const Options& options, std::mt19937& gen) {
+  GameSettings settings;
+  if (options.sendRate) {
+    settings.sendRate = options.sendRate;
+  }
+  if (!measure(stats, OP_CREATE_GAME, [&]() { return api.createGame(settings); })) {
+    return false;
+  }
+
+  long period = 1000000 / long(std::min(settings.sendRate, settings.tickRate));  // µs
+  long inputPeriod = (options.inputRate > 0) ? long(1000000 / options.inputRate) : 0;
+  long duration = long(options.duration * 1000000);
+
+  Clock::time_point start = Clock::now();
+  Clock::time_point lastFrame = start;
+  long nextInputAt = 0;
+  unsigned step = 0;
+  unsigned long frames = 0;
+  bool ended = false;
+  while (!ended && elapsedUs(start) < duration) {
+    RefreshFrame refresh = {};
+    std::vector<PlayerFrame> players;
+    std::vector<EntityFrame> entities;
+    bool read = measure(stats, OP_FRAME, [&]() {
+      refresh = api.getGameState(players, entities);
+      return true;
+    });
+    if (!read) break;
+
+    Clock::time_point now = Clock::now();
+    long gap = long(std::chrono::duration_cast<std::chrono::microseconds>(now - lastFrame).count());
+    lastFrame = now;
+    // The first frame follows the creation of the game, it is not late
+    if (frames != 0 && gap > period * 3 / 2) {
+      stats.lateFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    stats.frameDelay.record(getMonotonicTimestamp() - refresh.sent);
+    api.inputLatency().show(refresh);
+    stats.frames.fetch_add(1, std::memory_order_relaxed);
+    ++frames;
+    ended = refresh.gameState != 0;
+
+    if (inputPeriod && !ended && elapsedUs(start) >= nextInputAt) {
+      int input = nextInput(gen, step++, options.randomInputs);
+      measure(stats, OP_INPUT, [&]() {
+        api.sendGameInput(input);
+        return true;
+      });
+      nextInputAt += inputPeriod;
+    }
+  }
+
+  long played = elapsedUs(start);
+  unsigned long expected = (unsigned long)(played / period);
+  if (expected > frames) {
+    stats.missedFrames.fetch_add(expected - frames, std::memory_order_relaxed);
+  }
+  if (ended) {
+    stats.endedGames.fetch_add(1, std::memory_order_relaxed);
+  }
+  for (unsigned s = 0; s != NB_LATENCY_STAGES; ++s) {
+    stats.inputLatency[s].add(api.inputLatency().stage(LatencyStage(s)));
+  }
+
+  measure(stats, OP_QUIT_GAME, [&]() {
+    api.quitGame();
+    return true;
+  });
+  return true;
+}
+
+static void runBot(unsigned nBot, LoadStats& stats, const Options& options) {
+  std::mt19937 gen(nBot);
+  std::string username = options.prefix + std::to_string(nBot);
+  std::string password = "password";
+
+  CommunicationAPI api;
+  bool connected = measure(stats, OP_SIGN_IN, [&]() {
+    return api.signUp(username, password).connected || api.signIn(username, password).connected;
+  });
+  if (!connected) return;
+
+  measure(stats, OP_LEADERBOARD, [&]() {
+    std::vector<PlayerInfo> leaderboard;
+    api.getLeaderboard(leaderboard, 20);
+    return true;
+  });
+
+  for (unsigned g = 0; g != options.games; ++g) {
+    if (!playGame(api, stats, options, gen)) {
+      stats.refusedGames.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  api.signOut();
+}
+
+static void report(const LoadStats& stats, double seconds) {
+  printf("%-12s %9s %7s %10s %10s %10s %10s\n", "operation", "count", "errors", "p50_ms", "p90_ms", "p99_ms", "max_ms");
+  for (unsigned o = 0; o != NB_OPERATIONS; ++o) {
+    const Histogram& histogram = stats.operations[o];
+    printf("%-12s %9lu %7lu %10.2f %10.2f %10.2f %10.2f\n", operationName(Operation(o)), histogram.count(),
+           stats.errors[o].load(), double(histogram.percentile(50)) / 1000, double(histogram.percentile(90)) / 1000,
+           double(histogram.percentile(99)) / 1000, double(histogram.max()) / 1000);
+  }
+
+  printf("\n%-12s %9s %7s %10s %10s %10s %10s\n", "input stage", "count", "", "p50_ms", "p90_ms", "p99_ms", "max_ms");
+  for (unsigned s = 0; s != NB_LATENCY_STAGES; ++s) {
+    const Histogram& histogram = stats.inputLatency[s];
+    printf("%-12s %9lu %7s %10.2f %10.2f %10.2f %10.2f\n", latencyStageName(LatencyStage(s)), histogram.count(), "",
+           double(histogram.percentile(50)) / 1000, double(histogram.percentile(90)) / 1000,
+           double(histogram.percentile(99)) / 1000, double(histogram.max()) / 1000);
+  }
+
+  const Histogram& delay = stats.frameDelay;
+  printf("\nframes: %lu (%.0f/s), late: %lu, missed: %lu\n", stats.frames.load(),
+         (seconds > 0) ? double(stats.frames.load()) / seconds : 0, stats.lateFrames.load(), stats.missedFrames.load());
+  printf("frame delay (ms): p50 %.2f, p90 %.2f, p99 %.2f, max %.2f\n", double(delay.percentile(50)) / 1000,
+         double(delay.percentile(90)) / 1000, double(delay.percentile(99)) / 1000, double(delay.max()) / 1000);
+  printf("games refused: %lu, ended before the duration: %lu\n", stats.refusedGames.load(), stats.endedGames.load());
+}
+
+int main(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--bots") == 0 && i + 1 < argc) {
+      options.bots = unsigned(std::max(1, std::atoi(argv[++i])));
+    } else if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+      options.games = unsigned(std::max(0, std::atoi(argv[++i])));
+    } else if (std::strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+      options.duration = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--input-rate") == 0 && i + 1 < argc) {
+      options.inputRate = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--inputs") == 0 && i + 1 < argc) {
+      options.randomInputs = std::strcmp(argv[++i], "script") != 0;
+    } else if (std::strcmp(argv[i], "--ramp") == 0 && i + 1 < argc) {
+      options.ramp = unsigned(std::max(0, std::atoi(argv[++i])));
+    } else if (std::strcmp(argv[i], "--send-rate") == 0 && i + 1 < argc) {
+      options.sendRate = unsigned(std::max(0, std::atoi(argv[++i])));
+    } else if (std::strcmp(argv[i], "--prefix") == 0 && i + 1 < argc) {
+      options.prefix = argv[++i];
+    } else {
+      fprintf(stderr,
+              "usage: %s [--bots N] [--games N] [--duration SECONDS] [--input-rate HZ]\n"
+              "          [--inputs random|script] [--ramp MS] [--send-rate HZ] [--prefix NAME]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  void* memory = mmap(nullptr, sizeof(LoadStats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  LoadStats* stats = new (memory) LoadStats();
+
+  Clock::time_point start = Clock::now();
+  std::vector<pid_t> bots;
+  for (unsigned b = 0; b != options.bots; ++b) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      runBot(b, *stats, options);
+      std::_Exit(0);
+    } else if (pid == -1) {
+      perror("fork");
+      break;
+    }
+    bots.push_back(pid);
+    usleep(options.ramp * 1000);
+  }
+
+  // Bots waiting for a server that stopped answering are killed once they are overdue
+  long deadline = long((options.duration * options.games + 30) * 1000000) + long(options.ramp) * 1000 * long(options.bots);
+  std::size_t running = bots.size();
+  while (running) {
+    int status;
+    pid_t pid = waitpid(-1, &status, WNOHANG);
+    if (pid > 0) {
+      --running;
+    } else if (pid == 0) {
+      if (elapsedUs(start) > deadline) {
+        fprintf(stderr, "Bots overdue, killing them\n");
+        for (pid_t bot: bots) {
+          kill(bot, SIGKILL);
+        }
+      }
+      usleep(50000);
+    } else {
+      break;
+    }
+  }
+
+  report(*stats, double(elapsedUs(start)) / 1000000);
+  stats->~LoadStats();
+  munmap(memory, sizeof(LoadStats));
+  return 0;
+}
@@ -0,0 +1,138 @@
+/* Simulate again a game recorded by the server (see `server --replays`).
+ * Usage: replay [--realtime] [--repeat N] [--db PATH] FILE
+ *  --realtime: run at the game speed instead of as fast as possible
+ *  --repeat:   simulate the replay N times and keep the fastest run, to use
+ *               replays as performance regression workloads
+ *  --db:       database holding the levels (default: static/ltype.db)
+ * The state hash is checked after every tick: the tool stops at the first
+ *  tick that differs from the recorded game and returns 1.
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Error.hpp"
+#include "constants.hpp"
+#include "server/DatabaseManager.hpp"
+#include "server/game/Game.hpp"
+#include "server/game/Replay.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct RunResult {
+  unsigned ticks = 0;
+  bool diverged = false;
+  std::vector<double> tickTimes = {};  // µs
+  double totalTime = 0;                // µs
+};
+
+static RunResult run(const std::string& path, DatabaseManager& databaseManager, bool realtime) {
+  ReplayReader replay(path);
+  const ReplayInfo& info = replay.info();
+  Game game(info.settings, &databaseManager, info.levelIDs, info.seed);
+
+  RunResult result;
+  std::vector<int> inputs;
+  std::uint64_t expectedHash;
+
+  Clock::time_point start = Clock::now();
+  game.start();
+  while (replay.nextTick(inputs, expectedHash)) {
+    Clock::time_point tickStart = Clock::now();
+
+    try {
+      for (int key: inputs) {
+        game.applyInput(key);
+      }
+    } catch (const Error&) {
+      // The game was stopped by the player
+      break;
+    }
+    game.refresh();
+
+    Clock::time_point tickStop = Clock::now();
+    result.tickTimes.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(tickStop - tickStart).count()) / 1000);
+
+    std::uint64_t hash = game.stateHash();
+    if (hash != expectedHash) {
+      fprintf(stderr, "state differs at tick %u: expected %016lx, got %016lx\n", result.ticks, expectedHash, hash);
+      result.diverged = true;
+      break;
+    }
+    ++result.ticks;
+
+    if (realtime) {
+      long wait = 1000000 / long(game.tickRate()) - std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - tickStart).count();
+      if (wait > 0) {
+        usleep(unsigned(wait));
+      }
+    }
+  }
+  result.totalTime = double(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+  return result;
+}
+
+static double percentile(std::vector<double> values, double p) {
+  if (values.empty()) return 0;
+  std::size_t rank = std::size_t(p * double(values.size() - 1));
+  std::nth_element(values.begin(), values.begin() + long(rank), values.end());
+  return values[rank];
+}
+
+int main(int argc, char* argv[]) {
+  bool realtime = false;
+  unsigned repeat = 1;
+  std::string dbPath = "static/ltype.db";
+  std::string path;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--realtime") == 0) {
+      realtime = true;
+    } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = unsigned(std::max(1, std::atoi(argv[++i])));
+    } else if (std::strcmp(argv[i], "--db") == 0 && i + 1 < argc) {
+      dbPath = argv[++i];
+    } else {
+      path = argv[i];
+    }
+  }
+  if (path.empty()) {
+    fprintf(stderr, "usage: %s [--realtime] [--repeat N] [--db PATH] FILE\n", argv[0]);
+    return 2;
+  }
+
+  try {
+    if (ReplayReader(path).info().fixedPoint != REAL_IS_FIXED) {
+      throw Error("The replay was recorded with another number type (build with FIXED_POINT=" + std::string(REAL_IS_FIXED ? "0" : "1") + ")");
+    }
+
+    DatabaseManager databaseManager(dbPath);
+    RunResult best;
+    for (unsigned r = 0; r != repeat; ++r) {
+      RunResult result = run(path, databaseManager, realtime);
+      if (result.diverged) {
+        return 1;
+      }
+      if (r == 0 || result.totalTime < best.totalTime) {
+        best = std::move(result);
+      }
+    }
+
+    double sum = 0;
+    for (double time: best.tickTimes) sum += time;
+    printf("ticks=%u total_ms=%.3f ticks_per_s=%.0f mean_us=%.2f p50_us=%.2f p99_us=%.2f max_us=%.2f\n",
+           best.ticks, best.totalTime / 1000, (best.totalTime > 0) ? best.ticks / best.totalTime * 1e6 : 0,
+           best.tickTimes.empty() ? 0 : sum / double(best.tickTimes.size()),
+           percentile(best.tickTimes, 0.5), percentile(best.tickTimes, 0.99), percentile(best.tickTimes, 1));
+  } catch (const std::exception& err) {
+    fprintf(stderr, "%s\n", err.what());
+    return 1;
+  }
+  return 0;
+}
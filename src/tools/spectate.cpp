@@ -0,0 +1,111 @@
+/* Watch a running game with headless spectators, to check how its frames fan out.
+ * Usage: spectate [--viewers N] [--slow MS] [--user NAME] [--password PASSWORD] GAME_ID
+ *  --viewers:  spectators watching the game at the same time (default: 1)
+ *  --slow:     time each spectator spends on a frame (default: 0)
+ *  --user, --password: account of the spectators (default: admin, password)
+ * Each spectator is a process of its own, since a client is identified by its
+ *  pid until it signs in. It reads the frames of the game until the game ends
+ *  or is quit, then prints the frames it read, the frames it skipped because
+ *  it was too slow to read them, and how late frames were read after the
+ *  server sent them.
+ * The game ID of a player is given by `CommunicationAPI::getGameID`, replays
+ *  are named after it.
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Histogram.hpp"
+#include "MessageData.hpp"
+#include "server/CommunicationAPI.hpp"
+#include "utils.hpp"
+
+static int watch(unsigned viewer, const std::string& gameID, unsigned slow, const std::string& username, const std::string& password) {
+  CommunicationAPI api;
+  if (!api.signIn(username, password).connected) {
+    fprintf(stderr, "Could not sign in as %s\n", username.c_str());
+    return 1;
+  }
+  if (!api.spectateGame(gameID)) {
+    fprintf(stderr, "No running game %s\n", gameID.c_str());
+    return 1;
+  }
+
+  Histogram delay;
+  RefreshFrame refresh;
+  std::vector<PlayerFrame> players;
+  std::vector<EntityFrame> entities;
+  while (api.getSpectatedState(refresh, players, entities)) {
+    delay.record(getMonotonicTimestamp() - refresh.sent);
+    if (refresh.gameState != 0) break;
+    usleep(slow * 1000);
+  }
+
+  printf("viewer %u: frames %lu, skipped %lu, delay (ms): p50 %.2f, p99 %.2f, max %.2f\n", viewer, delay.count(),
+         api.spectatedSkips(), double(delay.percentile(50)) / 1000, double(delay.percentile(99)) / 1000,
+         double(delay.max()) / 1000);
+  fflush(stdout);
+  return 0;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned viewers = 1;
+  unsigned slow = 0;
+  std::string username = "admin";
+  std::string password = "password";
+  std::string gameID = "";
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--viewers") == 0 && i + 1 < argc) {
+      viewers = unsigned(std::max(1, std::atoi(argv[++i])));
+    } else if (std::strcmp(argv[i], "--slow") == 0 && i + 1 < argc) {
+      slow = unsigned(std::max(0, std::atoi(argv[++i])));
+    } else if (std::strcmp(argv[i], "--user") == 0 && i + 1 < argc) {
+      username = argv[++i];
+    } else if (std::strcmp(argv[i], "--password") == 0 && i + 1 < argc) {
+      password = argv[++i];
+    } else if (argv[i][0] != '-' && gameID.empty()) {
+      gameID = argv[i];
+    } else {
+      gameID.clear();
+      break;
+    }
+  }
+  if (gameID.empty()) {
+    fprintf(stderr, "usage: %s [--viewers N] [--slow MS] [--user NAME] [--password PASSWORD] GAME_ID\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<pid_t> spectators;
+  for (unsigned v = 0; v != viewers; ++v) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      int status = 1;
+      try {
+        status = watch(v, gameID, slow, username, password);
+      } catch (std::exception& err) {
+        fprintf(stderr, "viewer %u: %s\n", v, err.what());
+      }
+      std::_Exit(status);
+    } else if (pid == -1) {
+      perror("fork");
+      break;
+    }
+    spectators.push_back(pid);
+  }
+
+  int failures = 0;
+  for (pid_t pid: spectators) {
+    int status;
+    if (waitpid(pid, &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      ++failures;
+    }
+  }
+  return (failures) ? 1 : 0;
+}
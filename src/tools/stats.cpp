@@ -0,0 +1,104 @@
+/* Poll the load of a running server (see the `serverStats` channel).
+ * Usage: server-stats [--interval SECONDS] [--count N] [--user NAME] [--password PASSWORD] [--channels]
+ *  --interval: time between two polls (default: 1)
+ *  --count:    stop after N polls (default: poll until interrupted)
+ *  --user, --password: administrator account (default: admin, password)
+ *  --channels: add the rate of every channel after the other columns
+ * One line is printed per poll, as whitespace separated columns under a
+ *  header, so that the output can be graphed as is. Message rates are taken
+ *  over the time since the previous stats request, lateness is in µs.
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Error.hpp"
+#include "MessageData.hpp"
+#include "server/CommunicationAPI.hpp"
+
+int main(int argc, char* argv[]) {
+  double interval = 1;
+  long count = -1;
+  std::string username = "admin";
+  std::string password = "password";
+  bool showChannels = false;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+      interval = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+      count = std::atol(argv[++i]);
+    } else if (std::strcmp(argv[i], "--user") == 0 && i + 1 < argc) {
+      username = argv[++i];
+    } else if (std::strcmp(argv[i], "--password") == 0 && i + 1 < argc) {
+      password = argv[++i];
+    } else if (std::strcmp(argv[i], "--channels") == 0) {
+      showChannels = true;
+    } else {
+      fprintf(stderr, "usage: %s [--interval SECONDS] [--count N] [--user NAME] [--password PASSWORD] [--channels]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  try {
+    CommunicationAPI api;
+    if (!api.signIn(username, password).connected) {
+      fprintf(stderr, "Could not sign in as %s\n", username.c_str());
+      return 1;
+    }
+
+    for (long poll = 0; poll != count; ++poll) {
+      ServerStats stats;
+      std::vector<ChannelStats> channels;
+      if (!api.getServerStats(stats, channels)) {
+        fprintf(stderr, "%s is not an administrator\n", username.c_str());
+        return 1;
+      }
+
+      if (poll == 0) {
+        printf("%10s %6s %9s %8s %7s %9s %9s %9s %9s %10s %7s %9s %9s %9s %8s %8s %7s %6s %8s %8s",
+               "uptime_s", "games", "sandboxes", "msg/s", "tokens", "db_count", "db_p50us", "db_p99us", "db_maxus",
+               "ticks", "late", "late_p50", "late_p99", "late_max", "overload", "dropped", "stalled", "fifos", "fifos_gc", "rss_mb");
+        if (showChannels) {
+          for (const ChannelStats& channel: channels) {
+            printf(" %*s", std::max(8, int(std::strlen(channel.name))), channel.name);
+          }
+        }
+        printf("\n");
+      }
+
+      double messages = 0;
+      for (const ChannelStats& channel: channels) {
+        messages += channel.rate;
+      }
+      printf("%10.1f %6u %9u %8.1f %7lu %9lu %9.1f %9.1f %9.1f %10lu %7lu %9.0f %9.0f %9.0f %8u %8lu %7lu %6u %8lu %8.1f",
+             double(stats.uptime) / 1000000, stats.activeGames, stats.activeSandboxes, messages, stats.tokenFailures,
+             stats.dbQueries, stats.dbP50, stats.dbP99, stats.dbMax, stats.ticks, stats.lateTicks,
+             stats.latenessP50, stats.latenessP99, stats.latenessMax, stats.overloadLevel, stats.droppedFrames,
+             stats.stalledClients, stats.fifos,
+             stats.collectedFifos, double(stats.rss) / (1 << 20));
+      if (showChannels) {
+        for (const ChannelStats& channel: channels) {
+          printf(" %*.1f", std::max(8, int(std::strlen(channel.name))), channel.rate);
+        }
+      }
+      printf("\n");
+      fflush(stdout);
+
+      if (poll + 1 != count) {
+        usleep(useconds_t(interval * 1000000));
+      }
+    }
+
+    api.signOut();
+  } catch (std::exception& err) {
+    fprintf(stderr, "%s\n", err.what());
+    return 1;
+  }
+  return 0;
+}
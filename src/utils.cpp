@@ -20,6 +20,12 @@ long int getTimestamp() noexcept {
   return us;
 }
 
+long int getMonotonicTimestamp() noexcept {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
 std::string getStrTimestamp() noexcept {
   long int us = getTimestamp();
   char buffer[255];
@@ -69,6 +69,14 @@ CREATE TABLE IF NOT EXISTS 'level_entities' (
 	'yVelocity' INTEGER NOT NULL,
 	FOREIGN KEY('level') REFERENCES 'levels'('id')
 );
+DROP TABLE IF EXISTS 'level_patterns';
+CREATE TABLE IF NOT EXISTS 'level_patterns' (
+	'level' INTEGER NOT NULL,
+	'entity' INTEGER NOT NULL,
+	'steps' TEXT NOT NULL,
+	PRIMARY KEY ('level', 'entity'),
+	FOREIGN KEY('level') REFERENCES 'levels'('id')
+);
 DROP TABLE IF EXISTS 'levels';
 CREATE TABLE IF NOT EXISTS 'levels' (
 	'id'	INTEGER PRIMARY KEY AUTOINCREMENT,